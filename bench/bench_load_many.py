@@ -0,0 +1,150 @@
+# Benchmark reading many runs on many threads
+# agent
+# Oct 2026
+
+"""
+    Scaling of mudpy.load_many with the number of threads, or of
+    mudpy.load_shared with the number of processes, on a scan of synthetic
+    runs (mudpy.msynth).
+
+    Usage:
+        python3 bench/bench_load_many.py [-o results.json] [-n runs]
+                                         [-s small,medium,large]
+                                         [-w 1,2,4,...] [-r repeat] [--lazy]
+                                         [--shared]
+
+    The runs of each size are generated once, then read with load_many for
+    each number of workers (by default 1, 2, 4, ... up to the number of
+    processors, and that number). Wall times are the best and median of
+    repeat reads of the whole scan; speedup is the median time with one
+    worker over the median time with n, and efficiency is speedup/n.
+
+    Results are printed as JSON, and written to the output file if given.
+"""
+
+from mudpy import load_many, load_shared, msynth
+import argparse, json, os, platform, sys, tempfile, time
+
+# synthetic run sizes: msynth.generate arguments
+SIZES = {'small':   {'n_hist': 4,  'n_bins': 1024,   'n_ivar_data': 256},
+         'medium':  {'n_hist': 8,  'n_bins': 16384,  'n_ivar_data': 4096},
+         'large':   {'n_hist': 16, 'n_bins': 262144, 'n_ivar_data': 65536},
+        }
+
+# =========================================================================== #
+def default_workers():
+    """
+        Return 1, 2, 4, ... up to the number of processors, and that number.
+    """
+
+    n_cpu = os.cpu_count() or 1
+    workers = []
+    n = 1
+    while n < n_cpu:
+        workers.append(n)
+        n *= 2
+    workers.append(n_cpu)
+    return workers
+
+# =========================================================================== #
+def time_scan(filenames, workers, lazy, shared, repeat):
+    """
+        Return sorted wall times of repeat reads of filenames.
+    """
+
+    if shared:
+        read = lambda: load_shared(filenames, processes=workers)
+    else:
+        read = lambda: load_many(filenames, workers=workers, lazy=lazy)
+
+    # warm up: file cache and imports
+    read()
+
+    times = []
+    for i in range(repeat):
+        start = time.perf_counter()
+        read()
+        times.append(time.perf_counter() - start)
+    times.sort()
+    return times
+
+# =========================================================================== #
+def main():
+
+    parser = argparse.ArgumentParser(description='Benchmark scaling of '+\
+                                     'load_many with number of threads.')
+    parser.add_argument('-o', '--output', help='write JSON results to file')
+    parser.add_argument('-n', '--runs', type=int, default=100,
+                        help='runs in the scan')
+    parser.add_argument('-s', '--sizes', default='medium',
+                        help='comma-separated sizes (%s)' % ', '.join(SIZES))
+    parser.add_argument('-w', '--workers',
+                        default=','.join(map(str, default_workers())),
+                        help='comma-separated numbers of workers')
+    parser.add_argument('-r', '--repeat', type=int, default=3,
+                        help='timed reads of the scan per number of workers')
+    parser.add_argument('--lazy', action='store_true',
+                        help='read with lazy=True')
+    parser.add_argument('--shared', action='store_true',
+                        help='read with load_shared, in worker processes')
+    args = parser.parse_args()
+
+    sizes = args.sizes.split(',')
+    for s in sizes:
+        if s not in SIZES:
+            parser.error('unknown size %s' % s)
+    workers = [int(w) for w in args.workers.split(',')]
+
+    results = []
+    with tempfile.TemporaryDirectory() as directory:
+        for size in sizes:
+
+            # scan of runs, differing in seed
+            filenames = [msynth.generate(os.path.join(directory,
+                                                      '%s_%04d.msr' % (size, i)),
+                                         'TD', seed=i+1, **SIZES[size])
+                         for i in range(args.runs)]
+            scan_bytes = sum(os.path.getsize(f) for f in filenames)
+
+            base = None
+            for w in workers:
+                times = time_scan(filenames, w, args.lazy, args.shared,
+                                  args.repeat)
+                median = times[len(times)//2]
+                if w == 1:
+                    base = median
+
+                r = {'size':        size,
+                     'runs':        args.runs,
+                     'scan_bytes':  scan_bytes,
+                     'workers':     w,
+                     'best_s':      times[0],
+                     'median_s':    median,
+                     'runs_per_s':  args.runs / median,
+                     }
+                if base is not None:
+                    r['speedup'] = base / median
+                    r['efficiency'] = r['speedup'] / w
+                results.append(r)
+                print('%-7s %3d workers %10.4f s %8.1f runs/s' % \
+                      (size, w, median, r['runs_per_s']), file=sys.stderr)
+
+    output = {'python':     platform.python_version(),
+              'machine':    platform.machine(),
+              'cpu_count':  os.cpu_count(),
+              'lazy':       args.lazy,
+              'shared':     args.shared,
+              'time':       time.strftime('%Y-%m-%dT%H:%M:%S'),
+              'results':    results,
+              }
+
+    text = json.dumps(output, indent=2)
+    if args.output:
+        with open(args.output, 'w') as fid:
+            fid.write(text+'\n')
+    print(text)
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,239 @@
+# Benchmark mudpy reading and writing
+# agent
+# Oct 2026
+
+"""
+    End to end benchmarks of mudpy on synthetic runs (mudpy.msynth).
+
+    Usage:
+        python3 bench/bench_mudpy.py [-o results.json] [-b baseline.json]
+                                     [-s small,medium,large] [-c read,write]
+                                     [-r repeat] [-t threshold]
+
+    Cases, timed separately so the cost of each layer can be told apart:
+
+        open_read       open_read + close_read: C decode of the whole file
+        get_hist_data   get_hist_data of all histograms in an open file:
+                        Cython crossings and array copies
+        get_ivar_data   get_ivar_data of all variables in an open TI file
+        read            mdata(filename): the above plus Python object
+                        construction in mdata._read_file and _read_mdict
+        read_lazy       mdata(filename, lazy=True), then the data of one
+                        histogram
+        write           mdata.write(filename)
+        write_stream    mdata.write(filename, stream=True)
+
+    Each case runs in its own process, so peak RSS (ru_maxrss) is that of
+    the case alone. Wall times are the best and median of repeat runs;
+    allocations are measured in a separate, untimed run with tracemalloc
+    (peak traced bytes and number of traced blocks still held afterwards).
+
+    Results are printed as JSON, and written to the output file if given.
+    With a baseline (an earlier output file), each case also reports the
+    ratio of its median time to the baseline's, and the script exits with
+    status 1 if any case is slower than the baseline by more than threshold.
+"""
+
+from mudpy import mdata, msynth
+import mudpy.mud_friendly_wrapper as mud
+import argparse, json, os, platform, resource, subprocess, sys, tempfile
+import time, tracemalloc
+
+# synthetic run sizes: msynth.generate arguments
+SIZES = {'small':   {'n_hist': 4,  'n_bins': 1024,   'n_ivar_data': 256},
+         'medium':  {'n_hist': 8,  'n_bins': 16384,  'n_ivar_data': 4096},
+         'large':   {'n_hist': 16, 'n_bins': 262144, 'n_ivar_data': 65536},
+        }
+
+# cases and the run type they read
+CASES = {'open_read':       'TD',
+         'get_hist_data':   'TD',
+         'get_ivar_data':   'TI',
+         'read':            'TD',
+         'read_lazy':       'TD',
+         'write':           'TD',
+         'write_stream':    'TD',
+        }
+
+# =========================================================================== #
+def setup(case, filename, directory):
+    """
+        Return function running case once on filename.
+    """
+
+    if case == 'open_read':
+        def run():
+            mud.close_read(mud.open_read(filename))
+
+    elif case == 'get_hist_data':
+        fh = mud.open_read(filename)
+        n = mud.get_hists(fh)[1]
+        def run():
+            return [mud.get_hist_data(fh, i) for i in range(1, n+1)]
+
+    elif case == 'get_ivar_data':
+        fh = mud.open_read(filename)
+        n = mud.get_ivars(fh)[1]
+        def run():
+            return [mud.get_ivar_data(fh, i) for i in range(1, n+1)]
+
+    elif case == 'read':
+        def run():
+            return mdata(filename)
+
+    elif case == 'read_lazy':
+        def run():
+            data = mdata(filename, lazy=True)
+            return next(iter(data.hist.values())).data
+
+    elif case in ('write', 'write_stream'):
+        data = mdata(filename)
+        out = os.path.join(directory, 'out_%d.msr' % os.getpid())
+        stream = case == 'write_stream'
+        def run():
+            data.write(out, stream=stream)
+
+    else:
+        raise ValueError('Unknown case %s' % case)
+
+    return run
+
+# =========================================================================== #
+def run_case(case, filename, directory, repeat):
+    """
+        Run case in this process and return dict of results.
+    """
+
+    run = setup(case, filename, directory)
+
+    # warm up, and count allocations
+    tracemalloc.start()
+    result = run()
+    peak = tracemalloc.get_traced_memory()[1]
+    blocks = sum(stat.count for stat in
+                 tracemalloc.take_snapshot().statistics('filename'))
+    tracemalloc.stop()
+    del result
+
+    # time
+    times = []
+    for i in range(repeat):
+        start = time.perf_counter()
+        run()
+        times.append(time.perf_counter() - start)
+    times.sort()
+
+    return {'best_s':           times[0],
+            'median_s':         times[len(times)//2],
+            'repeat':           repeat,
+            'maxrss_kb':        resource.getrusage(resource.RUSAGE_SELF).ru_maxrss,
+            'alloc_peak_bytes': peak,
+            'alloc_blocks':     blocks,
+            }
+
+# =========================================================================== #
+def run_child(case, filename, directory, repeat):
+    """
+        Run case in a new process and return dict of results.
+    """
+
+    proc = subprocess.run([sys.executable, os.path.abspath(__file__),
+                           '--child', case, filename, directory, str(repeat)],
+                          stdout=subprocess.PIPE, check=True)
+    return json.loads(proc.stdout)
+
+# =========================================================================== #
+def compare(results, baseline, threshold):
+    """
+        Add ratios to baseline to results. Return list of slower cases.
+    """
+
+    base = {(r['case'], r['size']): r for r in baseline['results']}
+    slower = []
+
+    for r in results:
+        b = base.get((r['case'], r['size']))
+        if b is None:
+            continue
+        r['baseline_median_s'] = b['median_s']
+        r['ratio'] = r['median_s'] / b['median_s']
+        if r['ratio'] > 1 + threshold:
+            slower.append('%s/%s' % (r['case'], r['size']))
+
+    return slower
+
+# =========================================================================== #
+def main():
+
+    # run a single case in this process
+    if len(sys.argv) > 1 and sys.argv[1] == '--child':
+        case, filename, directory, repeat = sys.argv[2:6]
+        print(json.dumps(run_case(case, filename, directory, int(repeat))))
+        return 0
+
+    parser = argparse.ArgumentParser(description='Benchmark mudpy reading '+\
+                                     'and writing on synthetic runs.')
+    parser.add_argument('-o', '--output', help='write JSON results to file')
+    parser.add_argument('-b', '--baseline', help='compare to earlier results')
+    parser.add_argument('-s', '--sizes', default=','.join(SIZES),
+                        help='comma-separated sizes (%s)' % ', '.join(SIZES))
+    parser.add_argument('-c', '--cases', default=','.join(CASES),
+                        help='comma-separated cases (%s)' % ', '.join(CASES))
+    parser.add_argument('-r', '--repeat', type=int, default=5,
+                        help='timed runs per case')
+    parser.add_argument('-t', '--threshold', type=float, default=0.1,
+                        help='allowed fractional slowdown from baseline')
+    args = parser.parse_args()
+
+    sizes = args.sizes.split(',')
+    cases = args.cases.split(',')
+    for s in sizes:
+        if s not in SIZES:
+            parser.error('unknown size %s' % s)
+    for c in cases:
+        if c not in CASES:
+            parser.error('unknown case %s' % c)
+
+    results = []
+    with tempfile.TemporaryDirectory() as directory:
+        for size in sizes:
+
+            # runs, generated once per size and type
+            files = {}
+            for mode in sorted(set(CASES[c] for c in cases)):
+                filename = os.path.join(directory, '%s_%s.msr' % (size, mode))
+                files[mode] = msynth.generate(filename, mode, seed=1,
+                                              **SIZES[size])
+
+            for case in cases:
+                filename = files[CASES[case]]
+                r = {'case': case,
+                     'size': size,
+                     'file_bytes': os.path.getsize(filename)}
+                r.update(run_child(case, filename, directory, args.repeat))
+                results.append(r)
+                print('%-14s %-7s %10.6f s' % (case, size, r['median_s']),
+                      file=sys.stderr)
+
+    output = {'python':     platform.python_version(),
+              'machine':    platform.machine(),
+              'time':       time.strftime('%Y-%m-%dT%H:%M:%S'),
+              'results':    results,
+              }
+
+    slower = []
+    if args.baseline:
+        with open(args.baseline, 'r') as fid:
+            slower = compare(results, json.load(fid), args.threshold)
+        output['slower'] = slower
+
+    text = json.dumps(output, indent=2)
+    if args.output:
+        with open(args.output, 'w') as fid:
+            fid.write(text+'\n')
+    print(text)
+
+    return 1 if slower else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
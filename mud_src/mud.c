@@ -24,10 +24,26 @@
  *   v1.3   22-Apr-2003  [D. Arseneau] Add MUD_openInOut
  *          25-Nov-2009  [D. Arseneau] Handle larger size_t
  *          04-May-2016  [D. Arseneau] Edits for C++ use
+ *          18-Oct-2026  [agent] Add MUD_pread, MUD_pwrite
+ *          19-Oct-2026  [agent] Free the seek list in MUD_search,
+ *                               MUD_fseek
+ *          19-Oct-2026  [agent] MUD_writeGrpEnd for files over 2 GB
+ *          19-Oct-2026  [agent] Count reads, decodes and searches
+ *                               in pMUD_stats
+ *          19-Oct-2026  [agent] Trace points in MUD_read, MUD_decode
+ *                               and MUD_write; MUD_setTraceHook
+ *          19-Oct-2026  [agent] pMUD_stats and MUD_peekCore result
+ *                               per thread
+ *          19-Oct-2026  [agent] Tail pointers for group members and
+ *                               index; linear MUD_setSizes
  */
 
 
 #include "mud.h"
+#include <errno.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif /* !_WIN32 */
 
 #ifdef NO_STDARG
 #include <varargs.h>
@@ -37,6 +53,31 @@
 
 /* #define DEBUG 1 */  /* un-comment for debug */ 
 
+/* counters of the friendly file handle in use by this thread, if any */
+MUD_THREAD_LOCAL MUD_STATS* pMUD_stats = NULL;
+
+/* trace hook, if any */
+MUD_TRACE_HOOK pMUD_traceHook = NULL;
+
+
+/*
+ *  MUD_TRACE_HOOK MUD_setTraceHook( MUD_TRACE_HOOK hook )
+ *
+ *  Description:
+ *    Call hook at each trace point (see MUD_TRACE_EVENT in mud.h), or
+ *    stop calling it if hook is NULL.  Returns the previous hook.
+ */
+MUD_TRACE_HOOK
+MUD_setTraceHook( MUD_TRACE_HOOK hook )
+{
+    MUD_TRACE_HOOK old;
+
+    old = pMUD_traceHook;
+    pMUD_traceHook = hook;
+
+    return( old );
+}
+
 FILE*
 MUD_openInput( char* inFile )
 {
@@ -164,11 +205,18 @@ MUD_decode( BUF* pBuf )
      *  Decode the core part
      */	  
     MUD_CORE_proc( MUD_DECODE, pBuf, &mud );
+    _trace( decode_begin, MUD_TRACE_DECODE_BEGIN, 
+	    mud.core.secID, mud.core.instanceID, mud.core.size );
 
     pMUD = (MUD_SEC*)MUD_new( mud.core.secID, mud.core.instanceID );
-    if( pMUD == NULL ) return( NULL );
+    if( pMUD == NULL ) 
+    {
+	_trace( decode_end, MUD_TRACE_DECODE_END, 0, 0, 0 );
+	return( NULL );
+    }
 
     MUD_assignCore( &mud, pMUD );
+    _stat_add( nDecoded, 1 );
 
 #ifdef DEBUG
     printf( "MUD_decode: done  \n" );
@@ -185,6 +233,8 @@ MUD_decode( BUF* pBuf )
 #endif /* DEBUG */
 
     pBuf->pos = pos + MUD_size( pMUD );
+    _trace( decode_end, MUD_TRACE_DECODE_END, 
+	    MUD_secID( pMUD ), MUD_instanceID( pMUD ), MUD_size( pMUD ) );
 
     return( pMUD );
 }
@@ -288,10 +338,21 @@ MUD_write( FILE* fout, void* pMUD, MUD_IO_OPT io_opt )
 
     bzero( &buf, sizeof( BUF ) );
 
-    if( !MUD_encode( &buf, pMUD, io_opt ) ) return( FALSE );
+    _trace( write_begin, MUD_TRACE_WRITE_BEGIN, 
+	    MUD_secID( pMUD ), MUD_instanceID( pMUD ), 0 );
+
+    if( !MUD_encode( &buf, pMUD, io_opt ) ) 
+    {
+	_trace( write_end, MUD_TRACE_WRITE_END, 
+		MUD_secID( pMUD ), MUD_instanceID( pMUD ), 0 );
+	return( FALSE );
+    }
 
     fwrite( buf.buf, buf.size, 1, fout );
 
+    _trace( write_end, MUD_TRACE_WRITE_END, 
+	    MUD_secID( pMUD ), MUD_instanceID( pMUD ), buf.size );
+
     _free( buf.buf );
 
     return( TRUE );
@@ -318,6 +379,8 @@ MUD_writeGrpStart( FILE* fout, MUD_SEC_GRP* pMUD_parentGrp,
     pMUD_grp->memSize = 0;
     MUD_INDEX_proc( MUD_FREE, NULL, pMUD_grp->pMemIndex );
     MUD_free( pMUD_grp->pMem );
+    pMUD_grp->pMemIndex = pMUD_grp->pMemIndexTail = NULL;
+    pMUD_grp->pMem = pMUD_grp->pMemTail = NULL;
 
     pMUD_grp->num = numMems;
     pMUD_grp->core.size = MUD_getSize( (MUD_SEC*)pMUD_grp );
@@ -328,12 +391,21 @@ MUD_writeGrpStart( FILE* fout, MUD_SEC_GRP* pMUD_parentGrp,
 }
 
 
+/*
+ *  Appending to a group starts from the last entry appended (pMemTail,
+ *  pMemIndexTail) rather than the head of the list, and only steps over
+ *  what was added to the list since by other means (e.g. MUD_add), so
+ *  that building a group of N members is O(N).
+ */
 void
 addIndex( MUD_SEC_GRP* pMUD_grp, void* pMUD )
 {
     MUD_INDEX** ppMUD_index;
 
-    for( ppMUD_index = &pMUD_grp->pMemIndex; 
+    if( pMUD_grp->pMemIndex == NULL ) pMUD_grp->pMemIndexTail = NULL;
+
+    for( ppMUD_index = ( pMUD_grp->pMemIndexTail != NULL ) ?
+			    &pMUD_grp->pMemIndexTail->pNext : &pMUD_grp->pMemIndex; 
 	 *ppMUD_index != NULL; 
 	 ppMUD_index = &(*ppMUD_index)->pNext ) ;
 
@@ -341,6 +413,7 @@ addIndex( MUD_SEC_GRP* pMUD_grp, void* pMUD )
     (*ppMUD_index)->offset = pMUD_grp->memSize;
     (*ppMUD_index)->secID = MUD_secID( pMUD );
     (*ppMUD_index)->instanceID = MUD_instanceID( pMUD );
+    pMUD_grp->pMemIndexTail = *ppMUD_index;
 }
 
 
@@ -375,7 +448,7 @@ MUD_writeGrpMem( FILE* fout, MUD_SEC_GRP* pMUD_grp, void* pMUD )
 BOOL
 MUD_writeGrpEnd( FILE* fout, MUD_SEC_GRP* pMUD_grp )
 {
-    int pos;
+    long pos;
 
     pos = ftell( fout );
 
@@ -403,6 +476,92 @@ MUD_readFile( FILE* fin )
 }
 
 
+/*
+ *  UINT32 MUD_pread( FILE* fin, void* buf, UINT32 size, UINT32 offset )
+ *
+ *  Description:
+ *    Read size bytes at an absolute offset in the file, in one system
+ *    call where possible, and without moving the stream position
+ *    (except on _WIN32, where the stream is repositioned).
+ *
+ *  Return value:
+ *    The number of bytes read, which is short only at end of file
+ *    or on error.
+ */
+UINT32
+MUD_pread( FILE* fin, void* buf, UINT32 size, UINT32 offset )
+{
+#ifdef _WIN32
+    UINT32 done;
+
+    _stat_add( nSeeks, 1 );
+    if( fseek( fin, (long)offset, 0 ) == EOF ) return( 0 );
+
+    done = (UINT32)fread( buf, 1, (size_t)size, fin );
+    _stat_add( nReads, 1 );
+    _stat_add( bytesRead, done );
+
+    return( done );
+#else
+    UINT32 done = 0;
+    ssize_t n;
+
+    while( done < size )
+    {
+	n = pread( fileno( fin ), (char*)buf + done, (size_t)( size - done ),
+		   (off_t)offset + done );
+	_stat_add( nReads, 1 );
+	if( n < 0 && errno == EINTR ) continue;
+	if( n <= 0 ) break;
+	done += (UINT32)n;
+    }
+    _stat_add( bytesRead, done );
+
+    return( done );
+#endif /* _WIN32 */
+}
+
+
+/*
+ *  UINT32 MUD_pwrite( FILE* fout, void* buf, UINT32 size, UINT32 offset )
+ *
+ *  Description:
+ *    Write size bytes at an absolute offset in the file, bypassing the
+ *    stream buffer (except on _WIN32, where the stream is repositioned
+ *    and flushed).  Nothing should be pending in the stream buffer.
+ *
+ *  Return value:
+ *    The number of bytes written, which is short only on error.
+ */
+UINT32
+MUD_pwrite( FILE* fout, void* buf, UINT32 size, UINT32 offset )
+{
+#ifdef _WIN32
+    UINT32 done;
+
+    if( fseek( fout, (long)offset, 0 ) == EOF ) return( 0 );
+    done = (UINT32)fwrite( buf, 1, (size_t)size, fout );
+    if( fflush( fout ) == EOF ) return( 0 );
+
+    return( done );
+#else
+    UINT32 done = 0;
+    ssize_t n;
+
+    while( done < size )
+    {
+	n = pwrite( fileno( fout ), (char*)buf + done, (size_t)( size - done ),
+		    (off_t)offset + done );
+	if( n < 0 && errno == EINTR ) continue;
+	if( n <= 0 ) break;
+	done += (UINT32)n;
+    }
+
+    return( done );
+#endif /* _WIN32 */
+}
+
+
 void*
 MUD_read( FILE* fin, MUD_IO_OPT io_opt )
 {
@@ -424,6 +583,10 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
     if( fread( &size, 4, 1, fin ) == 0 ) return( NULL );
     bdecode_4( &size, &size );    /* byte ordering !!! */
     if( fseek( fin, pos, 0 ) == EOF ) return( NULL );
+    _stat_add( nReads, 1 );
+    _stat_add( bytesRead, 4 );
+    _stat_add( nSeeks, 1 );
+    _trace( read_begin, MUD_TRACE_READ_BEGIN, 0, 0, size );
 
 #ifdef DEBUG
     printf( "MUD_read: got %lu\n", (unsigned long)(size) );
@@ -436,8 +599,11 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
     if( fread( buf.buf, (size_t)size, 1, fin ) == 0 )
     {
 	_free( buf.buf );
+	_trace( read_end, MUD_TRACE_READ_END, 0, 0, 0 );
 	return( NULL );
     }
+    _stat_add( nReads, 1 );
+    _stat_add( bytesRead, size );
 
 #ifdef DEBUG
     printf( "MUD_read: done\n" );
@@ -451,10 +617,13 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
     if( pMUD_new == NULL ) 
     {
 	_free( buf.buf );
+	_trace( read_end, MUD_TRACE_READ_END, 0, 0, 0 );
 	return( NULL );
     }
 
     _free( buf.buf );
+    _trace( read_end, MUD_TRACE_READ_END, 
+	    MUD_secID( pMUD_new ), MUD_instanceID( pMUD_new ), size );
 
 #ifdef DEBUG
     printf( "MUD_read: done\n" );
@@ -476,7 +645,7 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
 	    }
 	    else if( pMUD_next->core.secID != MUD_SEC_EOF_ID )
 	    {
-		MUD_add( (void**)&((MUD_SEC_GRP*)pMUD_new)->pMem, pMUD_next );
+		MUD_addMember( (MUD_SEC_GRP*)pMUD_new, pMUD_next );
 	    }
 	    else
 	    {
@@ -521,6 +690,7 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
  *
  *  Modification history:
  *    08-Oct-2000  DJA   Created
+ *    19-Oct-2026  agent Search the index from the last entry found
  *
  *  Description:
  *    Go through the mud structure *pMUD recursively measuring sizes and
@@ -528,6 +698,10 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
  *    MUD-friendly routine MUD_closeWrite() before writing the file; the
  *    other friendly routines omit the picky bookkeeping needed to maintain
  *    accurate sizes and offsets.
+ *
+ *    The index entry of each member is looked for from the one after
+ *    the entry of the previous member, which is where it is when the
+ *    index is in member order, so a group of N members takes O(N).
  * 
  *  Parameter:
  *    A pointer to the root mud section to be measured (which is
@@ -538,11 +712,31 @@ MUD_read( FILE* fin, MUD_IO_OPT io_opt )
  *    otherwise return 0.
  */
 
+static MUD_INDEX*
+findIndex( MUD_INDEX* pHead, MUD_INDEX* pStart, UINT32 secID, UINT32 instanceID )
+{
+    MUD_INDEX*  pGrpIndex;
+
+    for( pGrpIndex = pStart; pGrpIndex != NULL; pGrpIndex = pGrpIndex->pNext )
+    {
+        if( ( pGrpIndex->secID == secID ) && 
+            ( pGrpIndex->instanceID == instanceID ) ) return( pGrpIndex );
+    }
+    for( pGrpIndex = pHead; pGrpIndex != pStart; pGrpIndex = pGrpIndex->pNext )
+    {
+        if( ( pGrpIndex->secID == secID ) && 
+            ( pGrpIndex->instanceID == instanceID ) ) return( pGrpIndex );
+    }
+    return( NULL );
+}
+
+
 UINT32
 MUD_setSizes( void* pMUD )
 {
     MUD_SEC*    pMember;
     MUD_INDEX*  pGrpIndex;
+    MUD_INDEX*  pStart;
     UINT32      offset = 0;
 
     /*
@@ -555,6 +749,7 @@ MUD_setSizes( void* pMUD )
     /* 
      *  Loop over members of group
      */
+    pStart = ((MUD_SEC_GRP*)pMUD)->pMemIndex;
     for( pMember = ((MUD_SEC_GRP*)pMUD)->pMem;
          pMember != NULL;
          pMember = pMember->core.pNext )
@@ -563,14 +758,11 @@ MUD_setSizes( void* pMUD )
          *  Look for corresponding index entry and set its offset.  If index 
          *  table is bad, just quit.
          */
-        for( pGrpIndex = (MUD_INDEX*)(((MUD_SEC_GRP*)pMUD)->pMemIndex);
-             pGrpIndex->instanceID != MUD_instanceID( pMember ) ||
-                  pGrpIndex->secID != MUD_secID( pMember ) ;
-             pGrpIndex = pGrpIndex->pNext  )
-        {
-            if( pGrpIndex == NULL ) return( offset );
-        }
+        pGrpIndex = findIndex( ((MUD_SEC_GRP*)pMUD)->pMemIndex, pStart,
+                               MUD_secID( pMember ), MUD_instanceID( pMember ) );
+        if( pGrpIndex == NULL ) return( offset );
         pGrpIndex->offset = offset;
+        pStart = pGrpIndex->pNext;
 
         /*
          *  If member is itself a group, recurse, measuring size.
@@ -592,7 +784,7 @@ MUD_setSizes( void* pMUD )
 MUD_SEC*
 MUD_peekCore( FILE* fin )
 {
-    static MUD_SEC mud;
+    static MUD_THREAD_LOCAL MUD_SEC mud;
     int pos;
     BUF buf;
     int size; 
@@ -614,6 +806,9 @@ MUD_peekCore( FILE* fin )
     }
 
     fseek( fin, pos, 0 );
+    _stat_add( nReads, 1 );
+    _stat_add( bytesRead, size );
+    _stat_add( nSeeks, 1 );
 
     MUD_CORE_proc( MUD_DECODE, &buf, &mud );
 
@@ -643,6 +838,7 @@ MUD_search( void* pMUD_head, ... )
     SEEK_ENTRY* pSeekList = NULL;
     SEEK_ENTRY** ppSeekEntry;
     SEEK_ENTRY* pSeekEntry;
+    UINT32 nVisited = 0;
 
     /*	  
      *  Assemble seek list from varargs
@@ -667,6 +863,7 @@ MUD_search( void* pMUD_head, ... )
 
     pMUD_start = (MUD_SEC*)pMUD_head;
     pMUD = NULL;
+    _stat_add( nSearches, 1 );
 
     for( pSeekEntry = pSeekList; 
 	 pSeekEntry != NULL; 
@@ -676,9 +873,12 @@ MUD_search( void* pMUD_head, ... )
 	 *  Search this level for the entry
 	 */
 	for( pMUD = pMUD_start; pMUD != NULL; pMUD = pMUD->core.pNext )
+	{
+	    nVisited++;
 	    if( ( MUD_secID( pMUD ) == pSeekEntry->secID ) && 
 		( MUD_instanceID( pMUD ) == pSeekEntry->instanceID ) )
 		break;
+	}
 
 	if( pMUD == NULL )
 	{
@@ -717,6 +917,14 @@ MUD_search( void* pMUD_head, ... )
 	}
     }
 
+    while( pSeekList != NULL )
+    {
+	pSeekEntry = pSeekList;
+	pSeekList = pSeekEntry->pNext;
+	free( pSeekEntry );
+    }
+    _stat_add( nVisited, nVisited );
+
     return( pMUD );
 }
 
@@ -734,7 +942,7 @@ MUD_fseek( FILE* fio, ... )
 #ifdef NO_STDARG
     FILE* fio;
 #endif /* NO_STDARG */
-    SEEK_ENTRY* pSeekList;
+    SEEK_ENTRY* pSeekList = NULL;
     SEEK_ENTRY** ppSeekEntry;
     SEEK_ENTRY* pSeekEntry;
     MUD_SEC* pMUD;
@@ -805,7 +1013,16 @@ MUD_fseek( FILE* fio, ... )
 	}
     }
 
-    if( ateof || ( pSeekEntry != NULL ) ) return( EOF );
+    if( pSeekEntry != NULL ) ateof = TRUE;
+
+    while( pSeekList != NULL )
+    {
+	pSeekEntry = pSeekList;
+	pSeekList = pSeekEntry->pNext;
+	free( pSeekEntry );
+    }
+
+    if( ateof ) return( EOF );
 
     return( ftell( fio ) );
 }
@@ -909,6 +1126,29 @@ MUD_add( void** ppMUD_head, void* pMUD_new )
 }
 
 
+/*
+ *  MUD_addMember() - append to the member list of a group, as MUD_add,
+ *  without touching the index (e.g. when reading a group)
+ */
+void
+MUD_addMember( MUD_SEC_GRP* pMUD_grp, void* pMUD )
+{
+    MUD_SEC** ppMUD;
+
+    if( pMUD == NULL ) return;
+
+    if( pMUD_grp->pMem == NULL ) pMUD_grp->pMemTail = NULL;
+
+    for( ppMUD = ( pMUD_grp->pMemTail != NULL ) ?
+		    &pMUD_grp->pMemTail->core.pNext : &pMUD_grp->pMem; 
+	 *ppMUD != NULL; 
+	 ppMUD = &(*ppMUD)->core.pNext ) ;
+
+    *ppMUD = (MUD_SEC*)pMUD;
+    pMUD_grp->pMemTail = (MUD_SEC*)pMUD;
+}
+
+
 int
 MUD_totSize( void* pMUD )
 {
@@ -921,18 +1161,12 @@ MUD_totSize( void* pMUD )
 void
 MUD_addToGroup( MUD_SEC_GRP* pMUD_grp, void* pMUD )
 {
-    MUD_SEC** ppMUD;
-
     if( pMUD == NULL ) return;
 
     /* possible addition: ((MUD_SEC*)pMUD)->core.pNext = NULL; */
     ((MUD_SEC*)pMUD)->core.size = MUD_getSize( pMUD );
 
-    for( ppMUD = &pMUD_grp->pMem; 
-	 *ppMUD != NULL; 
-	 ppMUD = &(*ppMUD)->core.pNext ) ;
-
-    *ppMUD = (MUD_SEC*)pMUD;
+    MUD_addMember( pMUD_grp, pMUD );
 
     addIndex( pMUD_grp, pMUD );
     pMUD_grp->num++;
@@ -130,6 +130,7 @@ typedef int16_t			INT16;
 typedef uint16_t 		UINT16;
 typedef int32_t			INT32;
 typedef uint32_t		UINT32;
+typedef uint64_t		UINT64;
 typedef float			REAL32;
 typedef double			REAL64;
 #else /*no stdint.h */
@@ -145,6 +146,7 @@ typedef unsigned int		UINT32;
 typedef long			INT32;
 typedef unsigned long		UINT32;
 #endif /* __alpha || __linux || __MACH__ || __arm64 */
+typedef unsigned long long	UINT64;
 typedef float			REAL32;
 typedef double			REAL64;
 #endif /* _STDINT_H */
@@ -198,7 +200,7 @@ typedef UINT32                  BOOL;
 #define _free(objp)			if((void*)(objp)!=(void*)NULL){free((void*)(objp));objp=NULL;}
 #define _roundUp( n, r )		( (r) * (int)( ((n)+(r)-1) / (r) ) )
 
-#define zalloc( n )			memset((void*)malloc(n),0,n)
+#define zalloc( n )			MUD_zalloc(n)
 #if defined(vms) || (defined(mips)&&!defined(__sgi)) || (defined(__MSDOS__)&&defined(__STDC__))
 #define strdup( s )			strcpy((char*)malloc(strlen(s)+1),s)
 #endif /* vms || mips&&!sgi */
@@ -240,6 +242,154 @@ typedef struct _MUD_INDEX {
 } MUD_INDEX;
 
 
+/* Absolute location of a section, as kept in a sidecar index file */
+typedef struct {
+    UINT32	offset;		    /* offset from start of file */
+    UINT32	size;		    /* size of the section */
+    UINT32	secID;		    /* Ident of section type */
+    UINT32	instanceID;	    /* Instance ID of section type */
+    INT32	parent;		    /* entry of enclosing group, or -1 */
+} MUD_IDX_ENTRY;
+
+
+typedef struct {
+    UINT32	fileSize;	    /* size of the indexed file */
+    TIME	fileTime;	    /* modification time of the indexed file */
+    UINT32	num;		    /* number of entries */
+    UINT32	alloc;		    /* number of entries allocated */
+    MUD_IDX_ENTRY* pEntry;	    /* entries, in file order */
+} MUD_IDX;
+
+#define MUD_IDX_SUFFIX		".idx"
+
+/* Parameters of a synthetic run (mud_synth.c) */
+typedef struct {
+    UINT32	type;		/* MUD_FMT_TRI_TD_ID or MUD_FMT_TRI_TI_ID */
+    UINT32	seed;
+    int		nHists;
+    int		nBins;
+    int		bytesPerBin;	/* 0 (packed), 1, 2, 4 or MUD_BIN_SIZE_DELTA */
+    double	counts;		/* mean counts at t0_bin, less background */
+    double	tau;		/* decay time in bins (0 for nBins/8) */
+    double	background;	/* mean counts per bin */
+    int		nScalers;
+    int		nIndVars;
+    int		nIndVarData;	/* length of ind. var. arrays (TI only) */
+    int		nComments;
+} MUD_SYNTH;
+
+/*
+ *  Library state that is per thread, so that runs may be read on several
+ *  threads at once (each with its own file handles).  Compile with
+ *  -DMUD_NO_THREADS for a single-threaded build.
+ */
+#if defined(MUD_NO_THREADS)
+#define MUD_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define MUD_THREAD_LOCAL	__declspec(thread)
+#else
+#define MUD_THREAD_LOCAL	__thread
+#endif /* MUD_NO_THREADS */
+
+/* Counters accumulated by a friendly file handle since open (MUD_getStats) */
+typedef struct {
+    UINT64	bytesRead;	/* bytes read from the file */
+    UINT64	nReads;		/* read calls (fread, pread) */
+    UINT64	nSeeks;		/* fseek calls while reading */
+    UINT64	nDecoded;	/* sections decoded */
+    UINT64	nAllocs;	/* zalloc calls */
+    UINT64	bytesAlloc;	/* bytes allocated by zalloc */
+    UINT64	nSearches;	/* MUD_search calls */
+    UINT64	nVisited;	/* sections compared by MUD_search */
+    UINT64	nsUnpack;	/* ns in MUD_unpack */
+    UINT64	nsFloat;	/* ns converting REAL32/REAL64 arrays */
+} MUD_STATS;
+
+/*
+ *  Counters are added to *pMUD_stats, the handle being used, unless
+ *  it is NULL.  Compile with -DMUD_NO_STATS to leave them out.
+ */
+extern MUD_THREAD_LOCAL MUD_STATS* pMUD_stats;
+#ifndef MUD_NO_STATS
+#define _stat_add( field, n )	if( pMUD_stats != NULL ) pMUD_stats->field += (n)
+#define _stat_time( t )		t = ( pMUD_stats != NULL ) ? MUD_nsec() : 0
+#define _stat_since( field, t ) if( pMUD_stats != NULL ) pMUD_stats->field += MUD_nsec() - (t)
+#else
+#define _stat_add( field, n )
+#define _stat_time( t )		t = 0
+#define _stat_since( field, t )
+#endif /* MUD_NO_STATS */
+
+/*
+ *  String arena: strings decoded (decode_str) while pMUD_strArena is set
+ *  are stored in that arena rather than allocated one by one, and, if
+ *  the arena interns, short repeated strings are stored once.  They must
+ *  not be changed in place.  Free section strings with _free_str(),
+ *  which leaves arena strings to MUD_freeStrArena().
+ */
+typedef struct _MUD_STR_ARENA MUD_STR_ARENA;
+
+extern MUD_THREAD_LOCAL MUD_STR_ARENA* pMUD_strArena;
+
+#define MUD_STR_INTERN_MAX	32	/* longest string interned */
+
+#define _free_str( s )		if((void*)(s)!=(void*)NULL){MUD_strFree((char*)(s));s=NULL;}
+
+/*
+ *  Trace points, passed to the hook set with MUD_setTraceHook() and,
+ *  when built with MUD_USDT, fired as USDT probes mud:<name> (e.g.
+ *  mud:decode_begin) for perf, bpftrace or SystemTap.  The arguments
+ *  are (secID, instanceID, size) except as noted:
+ *
+ *    read_begin/end     MUD_read of one section; size is the section size,
+ *                       IDs are 0 at read_begin (not yet known)
+ *    decode_begin/end   MUD_decode of one section (of a group, not
+ *                       including its members)
+ *    write_begin/end    MUD_write of a section (and members/following
+ *                       sections, as io_opt says); size is encoded bytes
+ *    pack_begin/end     histogram pack: (inBinSize, outBinSize, num) at
+ *                       pack_begin, (inBinSize, outBinSize, bytes out) at
+ *                       pack_end
+ *    unpack_begin/end   as pack
+ *    open_begin/end     friendly open: (type, fd, 0); type is 0 until
+ *                       known and fd is -1 until open
+ *    close_begin/end    friendly close: (type, fd, 0)
+ */
+typedef enum {
+    MUD_TRACE_READ_BEGIN = 0,
+    MUD_TRACE_READ_END = 1,
+    MUD_TRACE_DECODE_BEGIN = 2,
+    MUD_TRACE_DECODE_END = 3,
+    MUD_TRACE_WRITE_BEGIN = 4,
+    MUD_TRACE_WRITE_END = 5,
+    MUD_TRACE_PACK_BEGIN = 6,
+    MUD_TRACE_PACK_END = 7,
+    MUD_TRACE_UNPACK_BEGIN = 8,
+    MUD_TRACE_UNPACK_END = 9,
+    MUD_TRACE_OPEN_BEGIN = 10,
+    MUD_TRACE_OPEN_END = 11,
+    MUD_TRACE_CLOSE_BEGIN = 12,
+    MUD_TRACE_CLOSE_END = 13
+} MUD_TRACE_EVENT;
+
+typedef void (*MUD_TRACE_HOOK)( MUD_TRACE_EVENT event, UINT32 secID, 
+				UINT32 instanceID, UINT32 size );
+
+extern MUD_TRACE_HOOK pMUD_traceHook;
+
+#ifdef MUD_USDT
+#include <sys/sdt.h>
+#define _usdt( name, a, b, c )	DTRACE_PROBE3( mud, name, a, b, c )
+#else
+#define _usdt( name, a, b, c )
+#endif /* MUD_USDT */
+
+#define _trace( name, event, a, b, c ) \
+    { _usdt( name, a, b, c ); \
+      if( pMUD_traceHook != NULL ) \
+	(*pMUD_traceHook)( event, (UINT32)(a), (UINT32)(b), (UINT32)(c) ); }
+
+
 typedef struct _SEEK_ENTRY {
     struct _SEEK_ENTRY* pNext;
     UINT32 secID;
@@ -286,6 +436,8 @@ typedef struct _MUD_SEC_GRP {
     MUD_SEC*	pMem;		/* pointer to list of group members */
     INT32	pos;
     struct _MUD_SEC_GRP* pParent;
+    MUD_SEC*	pMemTail;	/* last member appended, or NULL */
+    MUD_INDEX*	pMemIndexTail;	/* last index entry appended, or NULL */
 } MUD_SEC_GRP;
 
 
@@ -475,6 +627,17 @@ typedef UINT16	MUD_STR_LEN_TYPE;
 typedef UINT16  MUD_VAR_BIN_LEN_TYPE;
 typedef UINT8   MUD_VAR_BIN_SIZ_TYPE;
 
+/*
+ *  bytesPerBin of histograms stored as zigzag deltas of their bins
+ *  (mud_delta.c), and the most bytes they take
+ */
+#define MUD_BIN_SIZE_DELTA	0x44
+#define _delta_max_bytes( n )	( ( (n) + 3 )/4 + 4*(n) )
+
+/* size of the bins of histograms of bytesPerBin b, when unpacked */
+#define _unpacked_bin_size( b ) \
+    ( ( ( (b) == 0 ) || ( (b) == MUD_BIN_SIZE_DELTA ) ) ? 4 : (b) )
+
 
 #undef _ANSI_ARGS_
 #if ((defined(__STDC__) || defined(SABER)) && !defined(NO_PROTOTYPE)) || defined(__cplusplus)
@@ -515,9 +678,35 @@ int MUD_fseekFirst _ANSI_ARGS_(( FILE *fio ));
 void MUD_add _ANSI_ARGS_(( void** ppMUD_head , void* pMUD_new ));
 int MUD_totSize _ANSI_ARGS_(( void* pMUD ));
 void MUD_addToGroup _ANSI_ARGS_(( MUD_SEC_GRP *pMUD_grp , void* pMUD ));
+void MUD_addMember _ANSI_ARGS_(( MUD_SEC_GRP *pMUD_grp , void* pMUD ));
 void MUD_assignCore _ANSI_ARGS_(( MUD_SEC *pMUD1 , MUD_SEC *pMUD2 ));
 int MUD_CORE_proc _ANSI_ARGS_(( MUD_OPT op , BUF *pBuf , MUD_SEC *pMUD ));
 int MUD_INDEX_proc _ANSI_ARGS_(( MUD_OPT op , BUF *pBuf , MUD_INDEX *pMUD ));
+UINT32 MUD_pread _ANSI_ARGS_(( FILE *fin , void* buf , UINT32 size , UINT32 offset ));
+UINT32 MUD_pwrite _ANSI_ARGS_(( FILE *fout , void* buf , UINT32 size , UINT32 offset ));
+MUD_TRACE_HOOK MUD_setTraceHook _ANSI_ARGS_(( MUD_TRACE_HOOK hook ));
+
+/* mud_idx.c */
+MUD_IDX* MUD_scanIndex _ANSI_ARGS_(( FILE *fin ));
+BOOL MUD_writeIndex _ANSI_ARGS_(( char* filename ));
+MUD_IDX* MUD_readIndex _ANSI_ARGS_(( char* filename ));
+void MUD_freeIndex _ANSI_ARGS_(( MUD_IDX* pIdx ));
+int MUD_findIndex _ANSI_ARGS_(( MUD_IDX* pIdx , int parent , UINT32 secID , UINT32 instanceID ));
+void* MUD_readEntry _ANSI_ARGS_(( FILE *fin , MUD_IDX_ENTRY* pEntry ));
+void* MUD_readFileIndexed _ANSI_ARGS_(( FILE *fin , MUD_IDX* pIdx ));
+
+/* mud_synth.c */
+void MUD_synthDefaults _ANSI_ARGS_(( MUD_SYNTH* pSynth , UINT32 type ));
+BOOL MUD_writeSynth _ANSI_ARGS_(( char* filename , MUD_SYNTH* pSynth ));
+
+/* mud_asym.c */
+BOOL MUD_asymHists _ANSI_ARGS_(( MUD_SEC_GEN_HIST_HDR* pHdrF , MUD_SEC_GEN_HIST_DAT* pDatF , MUD_SEC_GEN_HIST_HDR* pHdrB , MUD_SEC_GEN_HIST_DAT* pDatB , REAL64* pAsym , REAL64* pErr ));
+
+/* mud_sum.c */
+int MUD_sumHists _ANSI_ARGS_(( char** filenames , int nFiles , int* nums , int nHists , int nBins , UINT64* pSum , BOOL* pOK , int nThreads ));
+
+/* mud_pack.c */
+int MUD_packHists _ANSI_ARGS_(( int nHists , UINT32* nBins , UINT32** ppIn , caddr_t* ppOut , UINT32* pNBytes , int nThreads ));
 
 /* mud_encode.c */
 void bdecode_2 _ANSI_ARGS_(( void *b , void *p ));
@@ -557,6 +746,15 @@ int MUD_SEC_GEN_IND_VAR_proc _ANSI_ARGS_(( MUD_OPT op , BUF *pBuf , MUD_SEC_GEN_
 int MUD_SEC_GEN_ARRAY_proc _ANSI_ARGS_(( MUD_OPT op, BUF *pBuf, MUD_SEC_GEN_ARRAY *pMUD ));
 int MUD_SEC_GEN_HIST_pack _ANSI_ARGS_(( int num , int inBinSize , void* inHist , int outBinSize , void* outHist ));
 int MUD_SEC_GEN_HIST_unpack _ANSI_ARGS_(( int num , int inBinSize , void* inHist , int outBinSize , void* outHist ));
+int MUD_SEC_GEN_HIST_dataBytes _ANSI_ARGS_(( int num , int inBinSize , void* inHist , UINT32 nBytes ));
+int MUD_SEC_GEN_HIST_unpackChecked _ANSI_ARGS_(( int num , int inBinSize , void* inHist , UINT32 nBytes , int outBinSize , void* outHist ));
+int MUD_SEC_GEN_HIST_unpackRebin _ANSI_ARGS_(( int num , int inBinSize , void* inHist , UINT32 nBytes , int factor , UINT64* outHist ));
+
+/* mud_delta.c */
+int MUD_deltaPack _ANSI_ARGS_(( int num , int inBinSize , void* inHist , void* outHist ));
+int MUD_deltaBytes _ANSI_ARGS_(( int num , void* inHist , UINT32 nBytes ));
+int MUD_deltaUnpack _ANSI_ARGS_(( int num , void* inHist , UINT32 nBytes , int outBinSize , void* outHist ));
+int MUD_deltaUnpackRebin _ANSI_ARGS_(( int num , void* inHist , UINT32 nBytes , int factor , UINT64* outHist ));
 
 /* mud_tri_ti.c */
 int MUD_SEC_TRI_TI_RUN_DESC_proc _ANSI_ARGS_(( MUD_OPT op , BUF *pBuf , MUD_SEC_TRI_TI_RUN_DESC *pMUD ));
@@ -566,10 +764,23 @@ void GMF_MKTIME _ANSI_ARGS_(( TIME* out , INT32* input ));
 void GMF_TIME _ANSI_ARGS_(( TIME* out ));
 void GMF_LOCALTIME _ANSI_ARGS_(( TIME* in , INT32 *out ));
 
+/* mud_misc.c */
+typedef void* (*MUD_WORKER) _ANSI_ARGS_(( void* arg ));
+void* MUD_zalloc _ANSI_ARGS_(( size_t n ));
+UINT64 MUD_nsec _ANSI_ARGS_(( void ));
+void MUD_lock _ANSI_ARGS_(( void ));
+void MUD_unlock _ANSI_ARGS_(( void ));
+int MUD_runWorkers _ANSI_ARGS_(( MUD_WORKER fn , void* arg , int nThreads , int nMax ));
+MUD_STR_ARENA* MUD_newStrArena _ANSI_ARGS_(( BOOL intern ));
+void MUD_freeStrArena _ANSI_ARGS_(( MUD_STR_ARENA* pArena ));
+char* MUD_strDecode _ANSI_ARGS_(( char* s, int len ));
+void MUD_strFree _ANSI_ARGS_(( char* s ));
+
 /* mud_friendly.c */
 int MUD_openRead _ANSI_ARGS_(( char* filename, UINT32* pType ));
 int MUD_openWrite _ANSI_ARGS_(( char* filename, UINT32 type ));
 int MUD_openReadWrite _ANSI_ARGS_(( char* filename, UINT32* pType ));
+int MUD_openWriteStream _ANSI_ARGS_(( char* filename, UINT32 type ));
 int MUD_closeRead _ANSI_ARGS_(( int fd ));
 int MUD_closeWrite _ANSI_ARGS_(( int fd ));
 int MUD_closeWriteFile _ANSI_ARGS_(( int fd, char* outfile ));
@@ -652,6 +863,13 @@ int MUD_getHistBkgd2 _ANSI_ARGS_(( int fd, int num, UINT32* pBkgd2 ));
 int MUD_getHistNumEvents _ANSI_ARGS_(( int fd, int num, UINT32* pNumEvents ));
 int MUD_getHistTitle _ANSI_ARGS_(( int fd, int num, char* title, int strdim ));
 int MUD_getHistData _ANSI_ARGS_(( int fd, int num, void* pData ));
+int MUD_getHistDataRebinned _ANSI_ARGS_(( int fd, int num, int factor, UINT64* pData ));
+int MUD_getHistAsym _ANSI_ARGS_(( int fd, int numF, int numB, REAL64* pAsym, REAL64* pErr ));
+int MUD_releaseHist _ANSI_ARGS_(( int fd, int num ));
+int MUD_setReleaseHists _ANSI_ARGS_(( int fd, int release ));
+int MUD_getHistDataOffset _ANSI_ARGS_(( int fd, int num, UINT32* pOffset ));
+int MUD_getHistDataLocation _ANSI_ARGS_(( int fd, int num, UINT32* pOffset, UINT32* pNumBytes ));
+int MUD_getFileNo _ANSI_ARGS_(( int fd ));
 int MUD_getHistpData _ANSI_ARGS_(( int fd, int num, void** ppData ));
 int MUD_getHistTimeData _ANSI_ARGS_(( int fd, int num, UINT32* pTimeData ));
 int MUD_getHistpTimeData _ANSI_ARGS_(( int fd, int num, UINT32** ppTimeData ));
@@ -675,6 +893,7 @@ int MUD_setHistData _ANSI_ARGS_(( int fd, int num, void* pData ));
 int MUD_setHistpData _ANSI_ARGS_(( int fd, int num, void* pData ));
 int MUD_setHistTimeData _ANSI_ARGS_(( int fd, int num, UINT32* pTimeData ));
 int MUD_setHistpTimeData _ANSI_ARGS_(( int fd, int num, UINT32* pTimeData ));
+int MUD_setPackThreads _ANSI_ARGS_(( int fd, int nThreads ));
 
 int MUD_pack _ANSI_ARGS_(( int num, int inBinSize, void* inArray, int outBinSize, void* outArray ));
 int MUD_unpack _ANSI_ARGS_(( int num, int inBinSize, void* inArray, int outBinSize, void* outArray ));
@@ -723,6 +942,10 @@ int MUD_setIndVarTimeData _ANSI_ARGS_(( int fd, int num, UINT32* pTimeData ));
 int MUD_setIndVarpData _ANSI_ARGS_(( int fd, int num, void* pData ));
 int MUD_setIndVarpTimeData _ANSI_ARGS_(( int fd, int num, UINT32* pTimeData ));
 
+int MUD_exportColumnar _ANSI_ARGS_(( int fd, char* outfile ));
+
+int MUD_getStats _ANSI_ARGS_(( int fd, MUD_STATS* pStats ));
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,8 @@
  *   v1.10  17-Feb-1994  [T. Whidden] Groups with member index
  *   v1.2a  01-Mar-2000  DA  Proc for unknown sections
  *          25-Nov-2009  DA  Handle 8-byte time_t
+ *          19-Oct-2026  agent  Free strings with _free_str (string arenas)
+ *          19-Oct-2026  agent  Keep pMemIndexTail when decoding a group
  */
 
 #include <time.h>
@@ -127,6 +129,7 @@ MUD_SEC_GRP_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GRP* pMUD )
 		MUD_INDEX_proc( MUD_DECODE, pBuf, pMUD_index );
 		*ppMUD_index = pMUD_index;
 		ppMUD_index = &(*ppMUD_index)->pNext;
+		pMUD->pMemIndexTail = pMUD_index;
 	    }
 	    break;
 	case MUD_ENCODE:
@@ -171,9 +174,9 @@ MUD_SEC_CMT_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_CMT* pMUD )
     switch( op )
     {
 	case MUD_FREE:
-	    _free( pMUD->author );
-	    _free( pMUD->title );
-	    _free( pMUD->comment );
+	    _free_str( pMUD->author );
+	    _free_str( pMUD->title );
+	    _free_str( pMUD->comment );
 	    break;
 	case MUD_DECODE:
 	    decode_4( pBuf, &pMUD->ID );
@@ -0,0 +1,192 @@
+/*
+ *  mud_asym.c -- asymmetry of a pair of histograms
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *          19-Oct-2026  agent  Histograms of zigzag deltas (MUD_BIN_SIZE_DELTA)
+ *          19-Oct-2026  agent  Use only data that are their bins (nBytes)
+ *
+ *  Description:
+ *    MUD_asymHists() computes, bin by bin, the asymmetry of histograms F
+ *    and B (e.g. "F+" and "B+")
+ *
+ *        a = (f - b)/(f + b),   f = F - bF,  b = B - bB
+ *
+ *    and its error
+ *
+ *        da = 2 sqrt( b^2 var(f) + f^2 var(b) )/(f + b)^2
+ *
+ *    where bF and bB are the mean counts in the background windows bkgd1
+ *    to bkgd2 (inclusive, counted from bin 0 like t0_bin) of each header,
+ *    var(f) = F + bF/nF for a window of nF bins, and likewise for b.  An
+ *    empty window (bkgd2 < bkgd1, or past the end) means no background.
+ *
+ *    Histograms with 1, 2 or 4 bytes per bin are decoded CHUNK bins at a
+ *    time into small UINT32 buffers and the asymmetry of each chunk is
+ *    computed straight away, in a loop the compiler can vectorize;
+ *    packed histograms, and those stored as deltas, are first unpacked
+ *    whole to UINT32.
+ */
+
+#include <math.h>
+#include "mud.h"
+
+#define CHUNK 1024
+
+typedef struct {
+    int binSize;
+    caddr_t pData;
+    UINT32* pFull;		/* whole histogram, if packed */
+    UINT32 buf[CHUNK];
+} ASYM_HIST;
+
+static BOOL asym_open _ANSI_ARGS_(( ASYM_HIST* pH, MUD_SEC_GEN_HIST_HDR* pHdr, MUD_SEC_GEN_HIST_DAT* pDat ));
+static UINT32* asym_bins _ANSI_ARGS_(( ASYM_HIST* pH, int first, int n ));
+static void asym_bkgd _ANSI_ARGS_(( ASYM_HIST* pH, MUD_SEC_GEN_HIST_HDR* pHdr, REAL64* pBkgd, REAL64* pVar ));
+static void asym_kernel _ANSI_ARGS_(( int n, UINT32* pF, UINT32* pB, REAL64 bF, REAL64 bB, REAL64 vF, REAL64 vB, REAL64* pAsym, REAL64* pErr ));
+
+
+static BOOL
+asym_open( ASYM_HIST* pH, MUD_SEC_GEN_HIST_HDR* pHdr, MUD_SEC_GEN_HIST_DAT* pDat )
+{
+    pH->binSize = pHdr->bytesPerBin;
+    pH->pData = pDat->pData;
+    pH->pFull = NULL;
+
+    if( pH->pData == NULL ) return( FALSE );
+    if( MUD_SEC_GEN_HIST_dataBytes( pHdr->nBins, pH->binSize, pH->pData,
+				    pDat->nBytes ) < 0 ) return( FALSE );
+
+    switch( ( pDat->nBytes == 0 ) ? 0 : pH->binSize )
+    {
+	case 0:
+	case MUD_BIN_SIZE_DELTA:
+	    pH->pFull = (UINT32*)malloc( ( pHdr->nBins + 1 )*sizeof( UINT32 ) );
+	    if( pH->pFull == NULL ) return( FALSE );
+	    MUD_SEC_GEN_HIST_unpackChecked( pHdr->nBins, pH->binSize, pH->pData,
+					    pDat->nBytes, 4, pH->pFull );
+	    return( TRUE );
+	case 1:
+	case 2:
+	case 4:
+	    return( TRUE );
+    }
+    return( FALSE );
+}
+
+
+/*
+ *  Bins first to first+n-1 (n <= CHUNK) as UINT32
+ */
+static UINT32*
+asym_bins( ASYM_HIST* pH, int first, int n )
+{
+    if( pH->pFull != NULL ) return( &pH->pFull[first] );
+
+    MUD_SEC_GEN_HIST_unpack( n, pH->binSize, &pH->pData[first*pH->binSize],
+			     4, pH->buf );
+    return( pH->buf );
+}
+
+
+static void
+asym_bkgd( ASYM_HIST* pH, MUD_SEC_GEN_HIST_HDR* pHdr, REAL64* pBkgd, REAL64* pVar )
+{
+    UINT32* p;
+    UINT64 sum = 0;
+    int first, last, i, n;
+
+    first = pHdr->bkgd1;
+    last = _min( pHdr->bkgd2, pHdr->nBins - 1 );
+
+    *pBkgd = *pVar = 0.0;
+    if( ( pHdr->bkgd1 >= pHdr->nBins ) || ( last < first ) ) return;
+
+    for( ; first <= last; first += n )
+    {
+	n = _min( CHUNK, last - first + 1 );
+	p = asym_bins( pH, first, n );
+	for( i = 0; i < n; i++ ) sum += p[i];
+    }
+
+    n = last - (int)pHdr->bkgd1 + 1;
+    *pBkgd = (REAL64)sum/n;
+    *pVar = *pBkgd/n;
+}
+
+
+/*
+ *  The first loop has no calls or branches, and vectorizes; sqrt(), which
+ *  may set errno, is left to the second.
+ */
+static void
+asym_kernel( int n, UINT32* pF, UINT32* pB, REAL64 bF, REAL64 bB,
+	     REAL64 vF, REAL64 vB, REAL64* pAsym, REAL64* pErr )
+{
+    REAL64 f, b, s;
+    int i;
+
+    for( i = 0; i < n; i++ )
+    {
+	f = pF[i] - bF;
+	b = pB[i] - bB;
+	s = f + b;
+	pAsym[i] = ( f - b )/s;
+	pErr[i] = 4.0*( b*b*( pF[i] + vF ) + f*f*( pB[i] + vB ) )/( s*s*s*s );
+    }
+
+    for( i = 0; i < n; i++ ) pErr[i] = sqrt( pErr[i] );
+}
+
+
+BOOL
+MUD_asymHists( MUD_SEC_GEN_HIST_HDR* pHdrF, MUD_SEC_GEN_HIST_DAT* pDatF,
+	       MUD_SEC_GEN_HIST_HDR* pHdrB, MUD_SEC_GEN_HIST_DAT* pDatB,
+	       REAL64* pAsym, REAL64* pErr )
+{
+    ASYM_HIST* pF;
+    ASYM_HIST* pB;
+    REAL64 bF, bB, vF, vB;
+    int num, first, n;
+    BOOL ok;
+
+    if( pHdrF->nBins != pHdrB->nBins ) return( FALSE );
+    num = pHdrF->nBins;
+
+    pF = (ASYM_HIST*)zalloc( sizeof( ASYM_HIST ) );
+    pB = (ASYM_HIST*)zalloc( sizeof( ASYM_HIST ) );
+    ok = ( pF != NULL ) && ( pB != NULL ) &&
+	 asym_open( pF, pHdrF, pDatF ) && asym_open( pB, pHdrB, pDatB );
+
+    if( ok )
+    {
+	asym_bkgd( pF, pHdrF, &bF, &vF );
+	asym_bkgd( pB, pHdrB, &bB, &vB );
+
+	for( first = 0; first < num; first += n )
+	{
+	    n = _min( CHUNK, num - first );
+	    asym_kernel( n, asym_bins( pF, first, n ), asym_bins( pB, first, n ),
+			 bF, bB, vF, vB, &pAsym[first], &pErr[first] );
+	}
+    }
+
+    if( pF != NULL ) _free( pF->pFull );
+    if( pB != NULL ) _free( pB->pFull );
+    _free( pF );
+    _free( pB );
+
+    return( ok );
+}
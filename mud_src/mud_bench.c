@@ -0,0 +1,643 @@
+/*
+ *  mud_bench.c -- microbenchmarks of the MUD library
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *          19-Oct-2026  agent  group: building and sizing a large group
+ *          19-Oct-2026  agent  pack_hists: MUD_packHists by number of threads
+ *          19-Oct-2026  agent  hist_pack etc. of zigzag deltas, and packed size
+ *
+ *  Description:
+ *    Times the inner loops of the library on data built in memory, so that
+ *    it needs no input files:
+ *
+ *      hist_pack, hist_unpack    MUD_SEC_GEN_HIST_pack/unpack at each bin
+ *                                width (1, 2, 4), packed (0) and as
+ *                                deltas (MUD_BIN_SIZE_DELTA), bins/s, with
+ *                                the packed bytes
+ *      pack_hists                MUD_packHists of 64 histograms on 1, 2,
+ *                                4 and 8 threads, and one per processor
+ *                                (0), bins/s
+ *      bdecode_float, _double    values/s
+ *      search                    MUD_search by depth and fan-out,
+ *                                sections/s (sections passed over)
+ *      group                     MUD_addToGroup of N members, then
+ *                                MUD_setSizes, sections/s
+ *      encode, decode            MUD_encode of a whole run, and MUD_decode
+ *                                of each of its sections, MB/s
+ *      write, read               MUD_writeFile/MUD_readFile of a whole
+ *                                run through a temporary file, MB/s
+ *
+ *    Each case is repeated for at least the given time and reported as one
+ *    element of the "results" list of a JSON document, with its parameters,
+ *    iterations, seconds and rate.  The meson benchmark target runs it;
+ *    alternatively:
+ *
+ *      mud_bench [-t seconds] [-n bins] [-h hists] [-o file.json]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "mud.h"
+
+#define BENCH_VERSION	    1
+
+static double bench_time = 0.2;	    /* minimum seconds per case */
+static int bench_bins = 1 << 16;    /* bins per histogram */
+static int bench_hists = 8;	    /* histograms per run */
+static FILE* bench_out;
+static int bench_count = 0;
+static UINT32 bench_seed = 12345;
+
+typedef void (*BENCH_FUNC) _ANSI_ARGS_(( void* arg ));
+
+
+static double
+bench_now( void )
+{
+#if defined(CLOCK_MONOTONIC) && !defined(_WIN32)
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( ts.tv_sec + 1.0e-9*ts.tv_nsec );
+#else
+    return( (double)clock()/CLOCKS_PER_SEC );
+#endif
+}
+
+
+/*
+ *  Simple LCG, so that runs are repeatable everywhere
+ */
+static UINT32
+bench_rand( void )
+{
+    bench_seed = bench_seed*1664525 + 1013904223;
+    return( bench_seed >> 8 );
+}
+
+
+/*
+ *  Histogram counts with a decay and a flat background, limited to
+ *  binSize bytes
+ */
+static void
+bench_fill( UINT32* pData, int num, int binSize )
+{
+    int i;
+    UINT32 max;
+    double tau = num/8.0;
+
+    max = ( binSize == 1 ) ? 0xFF : ( binSize == 2 ) ? 0xFFFF : 0xFFFFFFFF;
+    for( i = 0; i < num; i++ )
+    {
+	double mean = 2.0e5*exp( -i/tau ) + 20.0;
+	UINT32 value = (UINT32)( mean*( 0.9 + 0.2*( bench_rand() & 0xFFFF )/65536.0 ) );
+
+	pData[i] = ( value > max ) ? ( bench_rand() & max ) : value;
+    }
+}
+
+
+/*
+ *  Run func until at least bench_time has passed; report "work" units
+ *  per iteration as a rate
+ */
+static void
+bench_run( char* name, char* params, char* unit, double work,
+	   BENCH_FUNC func, void* arg )
+{
+    double start, elapsed;
+    long iter = 0;
+
+    (*func)( arg );		/* warm up */
+
+    start = bench_now();
+    do
+    {
+	(*func)( arg );
+	iter++;
+	elapsed = bench_now() - start;
+    } while( elapsed < bench_time );
+
+    fprintf( bench_out, "%s    {\"name\": \"%s\", \"params\": {%s}, "
+	     "\"iterations\": %ld, \"seconds\": %.6f, "
+	     "\"rate\": %.6g, \"unit\": \"%s\"}",
+	     ( bench_count++ > 0 ) ? ",\n" : "",
+	     name, params, iter, elapsed, work*iter/elapsed, unit );
+    fflush( bench_out );
+}
+
+
+/*
+ *  Histogram packing
+ */
+typedef struct {
+    int num;
+    int binSize;
+    UINT32* pIn;
+    void* pPacked;
+    UINT32* pOut;
+} BENCH_HIST;
+
+static void
+bench_pack( void* arg )
+{
+    BENCH_HIST* p = (BENCH_HIST*)arg;
+
+    MUD_SEC_GEN_HIST_pack( p->num, 4, p->pIn, p->binSize, p->pPacked );
+}
+
+static void
+bench_unpack( void* arg )
+{
+    BENCH_HIST* p = (BENCH_HIST*)arg;
+
+    MUD_SEC_GEN_HIST_unpack( p->num, p->binSize, p->pPacked, 4, p->pOut );
+}
+
+static void
+bench_hist( void )
+{
+    static int binSizes[] = { 1, 2, 4, 0, MUD_BIN_SIZE_DELTA };
+    BENCH_HIST h;
+    char params[96];
+    int i, nBytes;
+
+    h.num = bench_bins;
+    h.pIn = (UINT32*)zalloc( 4*h.num );
+    h.pPacked = zalloc( _delta_max_bytes( h.num ) + 32 );
+    h.pOut = (UINT32*)zalloc( 4*h.num );
+
+    for( i = 0; i < sizeof( binSizes )/sizeof( binSizes[0] ); i++ )
+    {
+	h.binSize = binSizes[i];
+	bench_fill( h.pIn, h.num, h.binSize );
+	nBytes = MUD_SEC_GEN_HIST_pack( h.num, 4, h.pIn, h.binSize, h.pPacked );
+	sprintf( params, "\"bin_size\": %d, \"bins\": %d, \"bytes\": %d",
+		 h.binSize, h.num, nBytes );
+
+	bench_run( "hist_pack", params, "bins/s", h.num, bench_pack, &h );
+	bench_run( "hist_unpack", params, "bins/s", h.num, bench_unpack, &h );
+
+	if( memcmp( h.pIn, h.pOut, 4*h.num ) != 0 )
+	{
+	    fprintf( stderr, "mud_bench: hist_unpack bin_size %d mismatch\n",
+		     h.binSize );
+	    exit( 1 );
+	}
+    }
+
+    free( h.pIn );
+    free( h.pPacked );
+    free( h.pOut );
+}
+
+
+/*
+ *  Packing many histograms at once, as MUD_closeWrite() after
+ *  MUD_setPackThreads()
+ */
+#define BENCH_PACK_HISTS    64
+
+typedef struct {
+    int nThreads;
+    UINT32 nBins[BENCH_PACK_HISTS];
+    UINT32* ppIn[BENCH_PACK_HISTS];
+    caddr_t ppOut[BENCH_PACK_HISTS];
+    UINT32 nBytes[BENCH_PACK_HISTS];
+} BENCH_PACK;
+
+static void
+bench_packHists( void* arg )
+{
+    BENCH_PACK* p = (BENCH_PACK*)arg;
+    int i;
+
+    MUD_packHists( BENCH_PACK_HISTS, p->nBins, p->ppIn, p->ppOut, p->nBytes,
+		   p->nThreads );
+    for( i = 0; i < BENCH_PACK_HISTS; i++ ) _free( p->ppOut[i] );
+}
+
+static void
+bench_packs( void )
+{
+    static int threads[] = { 1, 2, 4, 8, 0 };
+    BENCH_PACK p;
+    char params[64];
+    int i;
+
+    for( i = 0; i < BENCH_PACK_HISTS; i++ )
+    {
+	p.nBins[i] = bench_bins;
+	p.ppIn[i] = (UINT32*)zalloc( 4*bench_bins );
+	p.ppOut[i] = NULL;
+	bench_fill( p.ppIn[i], bench_bins, 0 );
+    }
+
+    for( i = 0; i < sizeof( threads )/sizeof( threads[0] ); i++ )
+    {
+	p.nThreads = threads[i];
+	sprintf( params, "\"threads\": %d, \"hists\": %d, \"bins\": %d",
+		 p.nThreads, BENCH_PACK_HISTS, bench_bins );
+	bench_run( "pack_hists", params, "bins/s",
+		   (double)BENCH_PACK_HISTS*bench_bins, bench_packHists, &p );
+    }
+
+    for( i = 0; i < BENCH_PACK_HISTS; i++ ) free( p.ppIn[i] );
+}
+
+
+/*
+ *  Floating point decoding
+ */
+typedef struct {
+    int num;
+    char* pBuf;
+    void* pOut;
+} BENCH_FLOAT;
+
+static void
+bench_float( void* arg )
+{
+    BENCH_FLOAT* p = (BENCH_FLOAT*)arg;
+    float* pOut = (float*)p->pOut;
+    int i;
+
+    for( i = 0; i < p->num; i++ ) bdecode_float( &p->pBuf[4*i], &pOut[i] );
+}
+
+static void
+bench_double( void* arg )
+{
+    BENCH_FLOAT* p = (BENCH_FLOAT*)arg;
+    double* pOut = (double*)p->pOut;
+    int i;
+
+    for( i = 0; i < p->num; i++ ) bdecode_double( &p->pBuf[8*i], &pOut[i] );
+}
+
+static void
+bench_floats( void )
+{
+    BENCH_FLOAT f;
+    char params[32];
+    float fv;
+    double dv;
+    int i;
+
+    f.num = bench_bins;
+    f.pBuf = (char*)zalloc( 8*f.num );
+    f.pOut = zalloc( 8*f.num );
+    sprintf( params, "\"values\": %d", f.num );
+
+    for( i = 0; i < f.num; i++ )
+    {
+	fv = (float)bench_rand()/7.0f;
+	bencode_float( &f.pBuf[4*i], &fv );
+    }
+    bench_run( "bdecode_float", params, "values/s", f.num, bench_float, &f );
+
+    for( i = 0; i < f.num; i++ )
+    {
+	dv = (double)bench_rand()/7.0;
+	bencode_double( &f.pBuf[8*i], &dv );
+    }
+    bench_run( "bdecode_double", params, "values/s", f.num, bench_double, &f );
+
+    free( f.pBuf );
+    free( f.pOut );
+}
+
+
+/*
+ *  Searching: a tree of groups "depth" deep, each with "fanout" members,
+ *  searched for the last member at each level
+ */
+typedef struct {
+    int depth;
+    int fanout;
+    MUD_SEC_GRP* pTop;
+} BENCH_SEARCH;
+
+static MUD_SEC_GRP*
+bench_tree( int depth, int fanout, UINT32 instanceID )
+{
+    MUD_SEC_GRP* pGrp;
+    int i;
+
+    pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, instanceID );
+    for( i = 1; i <= fanout; i++ )
+    {
+	if( ( depth > 1 ) && ( i == fanout ) )
+	    MUD_addToGroup( pGrp, bench_tree( depth-1, fanout, i ) );
+	else
+	    MUD_addToGroup( pGrp, MUD_new( MUD_SEC_CMT_ID, i ) );
+    }
+    return( pGrp );
+}
+
+static void
+bench_search( void* arg )
+{
+    BENCH_SEARCH* p = (BENCH_SEARCH*)arg;
+    MUD_SEC* pHead = p->pTop->pMem;
+    UINT32 id = p->fanout;
+    void* pFound = NULL;
+
+    switch( p->depth )
+    {
+	case 1:
+	    pFound = MUD_search( pHead, MUD_SEC_CMT_ID, id, 0 );
+	    break;
+	case 2:
+	    pFound = MUD_search( pHead, MUD_SEC_GRP_ID, id,
+				 MUD_SEC_CMT_ID, id, 0 );
+	    break;
+	case 4:
+	    pFound = MUD_search( pHead, MUD_SEC_GRP_ID, id, MUD_SEC_GRP_ID, id,
+				 MUD_SEC_GRP_ID, id, MUD_SEC_CMT_ID, id, 0 );
+	    break;
+    }
+    if( pFound == NULL )
+    {
+	fprintf( stderr, "mud_bench: search depth %d failed\n", p->depth );
+	exit( 1 );
+    }
+}
+
+static void
+bench_searches( void )
+{
+    static int cases[][2] = { { 1, 16 }, { 1, 256 }, { 1, 4096 },
+			      { 2, 16 }, { 4, 16 } };
+    BENCH_SEARCH s;
+    char params[48];
+    int i;
+
+    for( i = 0; i < sizeof( cases )/sizeof( cases[0] ); i++ )
+    {
+	s.depth = cases[i][0];
+	s.fanout = cases[i][1];
+	s.pTop = bench_tree( s.depth, s.fanout, 1 );
+	sprintf( params, "\"depth\": %d, \"fanout\": %d", s.depth, s.fanout );
+
+	bench_run( "search", params, "sections/s",
+		   (double)s.depth*s.fanout, bench_search, &s );
+	MUD_free( s.pTop );
+    }
+}
+
+
+/*
+ *  Group building: N comments added one by one, then sized as by
+ *  MUD_closeWrite()
+ */
+static void
+bench_group( void* arg )
+{
+    int num = *(int*)arg;
+    MUD_SEC_GRP* pGrp;
+    int i;
+
+    pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_CMT_ID );
+    for( i = 1; i <= num; i++ )
+	MUD_addToGroup( pGrp, MUD_new( MUD_SEC_CMT_ID, i ) );
+    MUD_setSizes( pGrp );
+    MUD_free( pGrp );
+}
+
+static void
+bench_groups( void )
+{
+    static int cases[] = { 256, 4096, 65536 };
+    char params[48];
+    int i;
+
+    for( i = 0; i < sizeof( cases )/sizeof( cases[0] ); i++ )
+    {
+	sprintf( params, "\"members\": %d", cases[i] );
+	bench_run( "group", params, "sections/s", (double)cases[i],
+		   bench_group, &cases[i] );
+    }
+}
+
+
+/*
+ *  Whole runs: a TD run of bench_hists packed histograms
+ */
+typedef struct {
+    MUD_SEC_GRP* pRun;
+    BUF buf;
+    int size;			/* encoded size (decoding changes buf.size) */
+    FILE* fio;
+} BENCH_RUN;
+
+static MUD_SEC_GRP*
+bench_makeRun( void )
+{
+    MUD_SEC_GRP* pRun;
+    MUD_SEC_GRP* pGrp;
+    MUD_SEC_GEN_RUN_DESC* pDesc;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    MUD_SEC_GEN_SCALER* pScal;
+    UINT32* pData;
+    char title[32];
+    int i;
+
+    pRun = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_FMT_TRI_TD_ID );
+
+    pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_new( MUD_SEC_GEN_RUN_DESC_ID, 1 );
+    pDesc->exptNumber = 1234;
+    pDesc->runNumber = 40033;
+    pDesc->title = strdup( "mud_bench run" );
+    pDesc->lab = strdup( "TRIUMF" );
+    pDesc->area = strdup( "BNMR" );
+    pDesc->method = strdup( "TD-MuSR" );
+    MUD_addToGroup( pRun, pDesc );
+
+    pData = (UINT32*)zalloc( 4*bench_bins );
+    pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_HIST_ID );
+    for( i = 1; i <= bench_hists; i++ )
+    {
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_new( MUD_SEC_GEN_HIST_HDR_ID, i );
+	pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_new( MUD_SEC_GEN_HIST_DAT_ID, i );
+	sprintf( title, "hist %d", i );
+	pHdr->title = strdup( title );
+	pHdr->nBins = bench_bins;
+	pHdr->fsPerBin = 390625;
+
+	bench_fill( pData, bench_bins, 4 );
+	pDat->pData = (caddr_t)zalloc( 4*bench_bins + 32 );
+	pDat->nBytes = pHdr->nBytes =
+	    MUD_SEC_GEN_HIST_pack( bench_bins, 4, pData, 0, pDat->pData );
+
+	MUD_addToGroup( pGrp, pHdr );
+	MUD_addToGroup( pGrp, pDat );
+    }
+    MUD_addToGroup( pRun, pGrp );
+    free( pData );
+
+    pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_SCALER_ID );
+    for( i = 1; i <= 16; i++ )
+    {
+	pScal = (MUD_SEC_GEN_SCALER*)MUD_new( MUD_SEC_GEN_SCALER_ID, i );
+	sprintf( title, "scaler %d", i );
+	pScal->label = strdup( title );
+	pScal->counts[0] = bench_rand();
+	MUD_addToGroup( pGrp, pScal );
+    }
+    MUD_addToGroup( pRun, pGrp );
+
+    MUD_setSizes( pRun );
+    return( pRun );
+}
+
+static void
+bench_encode( void* arg )
+{
+    BENCH_RUN* p = (BENCH_RUN*)arg;
+    BUF buf;
+
+    bzero( &buf, sizeof( BUF ) );
+    MUD_encode( &buf, p->pRun, MUD_ALL );
+    _free( buf.buf );
+}
+
+static void
+bench_decode( void* arg )
+{
+    BENCH_RUN* p = (BENCH_RUN*)arg;
+
+    for( p->buf.pos = 0; p->buf.pos < p->size; )
+    {
+	MUD_free( MUD_decode( &p->buf ) );
+    }
+}
+
+static void
+bench_write( void* arg )
+{
+    BENCH_RUN* p = (BENCH_RUN*)arg;
+
+    MUD_writeFile( p->fio, p->pRun );
+    fflush( p->fio );
+}
+
+static void
+bench_read( void* arg )
+{
+    BENCH_RUN* p = (BENCH_RUN*)arg;
+
+    MUD_free( MUD_readFile( p->fio ) );
+}
+
+static void
+bench_runs( void )
+{
+    BENCH_RUN r;
+    char params[48];
+    double mb;
+    int num = 0;
+
+    r.pRun = bench_makeRun();
+    bzero( &r.buf, sizeof( BUF ) );
+    MUD_encode( &r.buf, r.pRun, MUD_ALL );
+    r.size = r.buf.size;
+    mb = r.size/1.0e6;
+    sprintf( params, "\"hists\": %d, \"bins\": %d", bench_hists, bench_bins );
+
+    for( r.buf.pos = 0; r.buf.pos < r.size; num++ )
+    {
+	MUD_free( MUD_decode( &r.buf ) );
+    }
+
+    bench_run( "encode", params, "MB/s", mb, bench_encode, &r );
+    bench_run( "decode", params, "MB/s", mb, bench_decode, &r );
+    bench_run( "decode_sections", params, "sections/s", num, bench_decode, &r );
+
+    r.fio = tmpfile();
+    if( r.fio == NULL )
+    {
+	perror( "mud_bench: tmpfile" );
+	exit( 1 );
+    }
+    bench_run( "write", params, "MB/s", mb, bench_write, &r );
+    bench_run( "read", params, "MB/s", mb, bench_read, &r );
+    fclose( r.fio );
+
+    _free( r.buf.buf );
+    MUD_free( r.pRun );
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    int i;
+
+    bench_out = stdout;
+    for( i = 1; i < argc; i++ )
+    {
+	if( ( strcmp( argv[i], "-t" ) == 0 ) && ( i+1 < argc ) )
+	    bench_time = atof( argv[++i] );
+	else if( ( strcmp( argv[i], "-n" ) == 0 ) && ( i+1 < argc ) )
+	    bench_bins = atoi( argv[++i] );
+	else if( ( strcmp( argv[i], "-h" ) == 0 ) && ( i+1 < argc ) )
+	    bench_hists = atoi( argv[++i] );
+	else if( ( strcmp( argv[i], "-o" ) == 0 ) && ( i+1 < argc ) )
+	{
+	    bench_out = fopen( argv[++i], "w" );
+	    if( bench_out == NULL )
+	    {
+		perror( argv[i] );
+		return( 1 );
+	    }
+	}
+	else
+	{
+	    fprintf( stderr,
+		     "usage: %s [-t seconds] [-n bins] [-h hists] [-o file]\n",
+		     argv[0] );
+	    return( 1 );
+	}
+    }
+    if( ( bench_bins < 1 ) || ( bench_hists < 1 ) )
+    {
+	fprintf( stderr, "mud_bench: bins and hists must be positive\n" );
+	return( 1 );
+    }
+
+    fprintf( bench_out, "{\"benchmark\": \"mud_bench\", \"version\": %d,\n"
+	     " \"bins\": %d, \"hists\": %d, \"min_seconds\": %g,\n"
+	     " \"results\": [\n",
+	     BENCH_VERSION, bench_bins, bench_hists, bench_time );
+
+    bench_hist();
+    bench_packs();
+    bench_floats();
+    bench_searches();
+    bench_groups();
+    bench_runs();
+
+    fprintf( bench_out, "\n]}\n" );
+    if( bench_out != stdout ) fclose( bench_out );
+
+    return( 0 );
+}
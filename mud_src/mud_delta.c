@@ -0,0 +1,434 @@
+/*
+ *  mud_delta.c -- histograms stored as zigzag deltas of the bins
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *   v1.1   19-Oct-2026  agent  Unpack only data of the nBytes given
+ *
+ *  Description:
+ *    Histograms with bytesPerBin MUD_BIN_SIZE_DELTA hold, for each bin, the
+ *    difference from the bin before it (the first from 0), modulo 2^32,
+ *    zigzag encoded so that small differences of either sign are small:
+ *
+ *      z = ( d << 1 ) ^ ( d >> 31 )	    (d as a signed 32-bit integer)
+ *
+ *    The values z are stored in 1 to 4 little-endian bytes each, in the
+ *    layout of stream-VByte: first (nBins+3)/4 control bytes, each giving
+ *    the lengths less one of 4 values in 2 bits (the first value in the
+ *    low bits), then the bytes of all the values.  Control bits past the
+ *    last bin are 0.  At most _delta_max_bytes( nBins ) bytes are used.
+ *
+ *    The neighbouring bins of a decay curve are close in value, so most
+ *    take 1 or 2 bytes where packing (bytesPerBin 0) keeps 2 or 3.
+ *
+ *    MUD_deltaPack() encodes num bins of inBinSize (1, 2 or 4) bytes into
+ *    outHist and returns the number of bytes used.  MUD_deltaBytes()
+ *    returns the bytes that num bins take, from their control bytes, or
+ *    -1 if those are not all within nBytes.  MUD_deltaUnpack() decodes
+ *    num bins of nBytes into outHist as bins of outBinSize (1, 2 or 4)
+ *    bytes, truncated as by MUD_SEC_GEN_HIST_unpack(), and returns
+ *    num*outBinSize.  MUD_deltaUnpackRebin() decodes num bins of nBytes,
+ *    adding each factor of them into one UINT64, as
+ *    MUD_SEC_GEN_HIST_unpackRebin(), and returns the number of UINT64s.
+ *    Both check first that the control bytes give exactly nBytes, and
+ *    return 0, with nothing decoded, if not: no byte past nBytes is read
+ *    whatever the data hold.  They are called by those functions for
+ *    MUD_BIN_SIZE_DELTA.
+ *
+ *    4-byte bins are encoded and decoded 4 at a time with SSSE3 shuffles
+ *    when built with GCC or Clang for x86 and the processor has them
+ *    (checked when called), and one at a time otherwise, or when built
+ *    with MUD_NO_SIMD (meson option simd=false).  Both give the same
+ *    bytes.
+ */
+
+#include "mud.h"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) ) && \
+    !defined(MUD_NO_SIMD)
+#define DELTA_SSSE3
+#include <tmmintrin.h>
+#endif /* __GNUC__ && x86 */
+
+/*
+ *  Bytes of the 4 values of control byte c, for each c, built by the
+ *  preprocessor
+ */
+#define _dLen( c, j )	( ( ( (c) >> ( 2*(j) ) ) & 3 ) + 1 )
+#define _dEnd1( c )	_dLen( c, 0 )
+#define _dEnd2( c )	( _dEnd1( c ) + _dLen( c, 1 ) )
+#define _dEnd3( c )	( _dEnd2( c ) + _dLen( c, 2 ) )
+#define _dEnd4( c )	( _dEnd3( c ) + _dLen( c, 3 ) )
+
+#define _dRows4( R, c )	    R( c ), R( (c)+1 ), R( (c)+2 ), R( (c)+3 )
+#define _dRows16( R, c )    _dRows4( R, c ), _dRows4( R, (c)+4 ), \
+			    _dRows4( R, (c)+8 ), _dRows4( R, (c)+12 )
+#define _dRows64( R, c )    _dRows16( R, c ), _dRows16( R, (c)+16 ), \
+			    _dRows16( R, (c)+32 ), _dRows16( R, (c)+48 )
+#define _dRows256( R )	    _dRows64( R, 0 ), _dRows64( R, 64 ), \
+			    _dRows64( R, 128 ), _dRows64( R, 192 )
+
+static const UINT8 delta_length[256] = { _dRows256( _dEnd4 ) };
+
+#define _zigzag( d )	( ( (d) << 1 ) ^ ( 0 - ( (d) >> 31 ) ) )
+#define _unzigzag( z )	( ( (z) >> 1 ) ^ ( 0 - ( (z) & 1 ) ) )
+
+static UINT32 delta_getBin _ANSI_ARGS_(( UINT8* pIn, int binSize, int i ));
+static void delta_setBin _ANSI_ARGS_(( UINT8* pOut, int binSize, int i, UINT32 val ));
+static int delta_pack _ANSI_ARGS_(( int first, int num, int inBinSize, UINT8* pIn, UINT32 prev, UINT8* pCtl, UINT8* pData ));
+static int delta_unpack _ANSI_ARGS_(( int first, int num, UINT8* pCtl, UINT8* pData, UINT32 prev, int outBinSize, UINT8* pOut ));
+#ifdef DELTA_SSSE3
+static int delta_packSsse3 _ANSI_ARGS_(( int num, UINT32* pIn, UINT8* pCtl, UINT8** ppData ));
+static int delta_unpackSsse3 _ANSI_ARGS_(( int num, UINT8* pCtl, UINT8** ppData, UINT8* pEnd, UINT32* pOut ));
+#endif /* DELTA_SSSE3 */
+
+
+static UINT32
+delta_getBin( UINT8* pIn, int binSize, int i )
+{
+    UINT16 s;
+    UINT32 l;
+
+    switch( binSize )
+    {
+	case 1:
+	    return( pIn[i] );
+	case 2:
+	    bcopy( &pIn[2*i], &s, 2 );
+	    return( s );
+	default:
+	    bcopy( &pIn[4*i], &l, 4 );
+	    return( l );
+    }
+}
+
+
+static void
+delta_setBin( UINT8* pOut, int binSize, int i, UINT32 val )
+{
+    UINT16 s;
+
+    switch( binSize )
+    {
+	case 1:
+	    pOut[i] = (UINT8)val;
+	    break;
+	case 2:
+	    s = (UINT16)val;
+	    bcopy( &s, &pOut[2*i], 2 );
+	    break;
+	default:
+	    bcopy( &val, &pOut[4*i], 4 );
+	    break;
+    }
+}
+
+
+/*
+ *  Encode bins first to num-1, following a bin of value prev.  Returns
+ *  the bytes of data written at pData.
+ */
+static int
+delta_pack( int first, int num, int inBinSize, UINT8* pIn, UINT32 prev,
+	    UINT8* pCtl, UINT8* pData )
+{
+    UINT8* p = pData;
+    UINT32 val, z;
+    int i, code;
+
+    for( i = first; i < num; i++ )
+    {
+	val = delta_getBin( pIn, inBinSize, i );
+	z = val - prev;
+	z = _zigzag( z );
+	prev = val;
+
+	code = ( z > 0xFF ) + ( z > 0xFFFF ) + ( z > 0xFFFFFF );
+	if( ( i & 3 ) == 0 ) pCtl[i >> 2] = 0;
+	pCtl[i >> 2] |= code << ( 2*( i & 3 ) );
+
+	*p++ = (UINT8)z;
+	if( code > 0 ) *p++ = (UINT8)( z >> 8 );
+	if( code > 1 ) *p++ = (UINT8)( z >> 16 );
+	if( code > 2 ) *p++ = (UINT8)( z >> 24 );
+    }
+
+    return( (int)( p - pData ) );
+}
+
+
+/*
+ *  Decode bins first to num-1, following a bin of value prev.  Returns
+ *  the bytes of data read at pData.
+ */
+static int
+delta_unpack( int first, int num, UINT8* pCtl, UINT8* pData, UINT32 prev,
+	      int outBinSize, UINT8* pOut )
+{
+    UINT8* p = pData;
+    UINT32 z;
+    int i, code;
+
+    for( i = first; i < num; i++ )
+    {
+	code = ( pCtl[i >> 2] >> ( 2*( i & 3 ) ) ) & 3;
+	z = *p++;
+	if( code > 0 ) z |= (UINT32)( *p++ ) << 8;
+	if( code > 1 ) z |= (UINT32)( *p++ ) << 16;
+	if( code > 2 ) z |= (UINT32)( *p++ ) << 24;
+
+	prev += _unzigzag( z );
+	delta_setBin( pOut, outBinSize, i, prev );
+    }
+
+    return( (int)( p - pData ) );
+}
+
+
+int
+MUD_deltaPack( int num, int inBinSize, void* inHist, void* outHist )
+{
+    UINT8* pCtl = (UINT8*)outHist;
+    UINT8* pData = &pCtl[( num + 3 )/4];
+    UINT32 prev = 0;
+    int first = 0;
+
+    if( ( inBinSize != 1 ) && ( inBinSize != 2 ) && ( inBinSize != 4 ) )
+	return( 0 );
+
+#ifdef DELTA_SSSE3
+    if( ( inBinSize == 4 ) && __builtin_cpu_supports( "ssse3" ) )
+    {
+	first = delta_packSsse3( num, (UINT32*)inHist, pCtl, &pData );
+	if( first > 0 ) prev = delta_getBin( (UINT8*)inHist, 4, first - 1 );
+    }
+#endif /* DELTA_SSSE3 */
+
+    pData += delta_pack( first, num, inBinSize, (UINT8*)inHist, prev, pCtl, pData );
+
+    return( (int)( pData - (UINT8*)outHist ) );
+}
+
+
+int
+MUD_deltaBytes( int num, void* inHist, UINT32 nBytes )
+{
+    UINT8* pCtl = (UINT8*)inHist;
+    UINT32 nCtl = ( num + 3 )/4;
+    UINT32 n;
+    int i;
+
+    if( ( num < 0 ) || ( nCtl > nBytes ) ) return( -1 );
+
+    n = nCtl;
+    for( i = 0; i < num/4; i++ ) n += delta_length[pCtl[i]];
+    for( i = num & ~3; i < num; i++ )
+	n += ( ( pCtl[i >> 2] >> ( 2*( i & 3 ) ) ) & 3 ) + 1;
+
+    return( (int)n );
+}
+
+
+int
+MUD_deltaUnpack( int num, void* inHist, UINT32 nBytes, int outBinSize, void* outHist )
+{
+    UINT8* pCtl = (UINT8*)inHist;
+    UINT8* pData = &pCtl[( num + 3 )/4];
+    UINT32 prev = 0;
+    int first = 0;
+    int n;
+
+    if( ( outBinSize != 1 ) && ( outBinSize != 2 ) && ( outBinSize != 4 ) )
+	return( 0 );
+
+    n = MUD_deltaBytes( num, inHist, nBytes );
+    if( ( n < 0 ) || ( (UINT32)n != nBytes ) ) return( 0 );
+
+#ifdef DELTA_SSSE3
+    if( ( outBinSize == 4 ) && __builtin_cpu_supports( "ssse3" ) )
+    {
+	first = delta_unpackSsse3( num, pCtl, &pData, &pCtl[nBytes],
+				   (UINT32*)outHist );
+	if( first > 0 ) prev = delta_getBin( (UINT8*)outHist, 4, first - 1 );
+    }
+#endif /* DELTA_SSSE3 */
+
+    delta_unpack( first, num, pCtl, pData, prev, outBinSize, (UINT8*)outHist );
+
+    return( num*outBinSize );
+}
+
+
+int
+MUD_deltaUnpackRebin( int num, void* inHist, UINT32 nBytes, int factor, UINT64* outHist )
+{
+    UINT8* pCtl = (UINT8*)inHist;
+    UINT8* p = &pCtl[( num + 3 )/4];
+    UINT64* pOut = outHist;
+    UINT64 sum = 0;
+    UINT32 val = 0, z;
+    int i, code, n, count = 0;
+
+    if( factor < 1 ) return( 0 );
+
+    n = MUD_deltaBytes( num, inHist, nBytes );
+    if( ( n < 0 ) || ( (UINT32)n != nBytes ) ) return( 0 );
+
+    for( i = 0; i < num; i++ )
+    {
+	code = ( pCtl[i >> 2] >> ( 2*( i & 3 ) ) ) & 3;
+	z = *p++;
+	if( code > 0 ) z |= (UINT32)( *p++ ) << 8;
+	if( code > 1 ) z |= (UINT32)( *p++ ) << 16;
+	if( code > 2 ) z |= (UINT32)( *p++ ) << 24;
+
+	val += _unzigzag( z );
+	sum += val;
+	if( ++count == factor )
+	{
+	    *pOut++ += sum;
+	    sum = 0;
+	    count = 0;
+	}
+    }
+    if( count > 0 ) *pOut++ += sum;
+
+    return( (int)( pOut - outHist ) );
+}
+
+
+#ifdef DELTA_SSSE3
+
+/*
+ *  Shuffles between 4 values in 16 bytes and the bytes they are stored
+ *  in, for each control byte, built by the preprocessor.  An index with
+ *  the high bit set (0x80) gives a zero byte.
+ */
+
+/* byte k of value j, from the stored bytes */
+#define _dDec( c, j, k, start ) \
+    ( ( (k) < _dLen( c, j ) ) ? (start) + (k) : 0x80 )
+#define _dDecValue( c, j, start ) \
+    _dDec( c, j, 0, start ), _dDec( c, j, 1, start ), \
+    _dDec( c, j, 2, start ), _dDec( c, j, 3, start )
+#define _dDecRow( c ) \
+    { _dDecValue( c, 0, 0 ), _dDecValue( c, 1, _dEnd1( c ) ), \
+      _dDecValue( c, 2, _dEnd2( c ) ), _dDecValue( c, 3, _dEnd3( c ) ) }
+
+/* stored byte p, from the values */
+#define _dEnc( c, p ) \
+    ( ( (p) < _dEnd1( c ) ) ? (p) : \
+      ( (p) < _dEnd2( c ) ) ? 4 + (p) - _dEnd1( c ) : \
+      ( (p) < _dEnd3( c ) ) ? 8 + (p) - _dEnd2( c ) : \
+      ( (p) < _dEnd4( c ) ) ? 12 + (p) - _dEnd3( c ) : 0x80 )
+#define _dEncRow( c ) \
+    { _dEnc( c, 0 ), _dEnc( c, 1 ), _dEnc( c, 2 ), _dEnc( c, 3 ), \
+      _dEnc( c, 4 ), _dEnc( c, 5 ), _dEnc( c, 6 ), _dEnc( c, 7 ), \
+      _dEnc( c, 8 ), _dEnc( c, 9 ), _dEnc( c, 10 ), _dEnc( c, 11 ), \
+      _dEnc( c, 12 ), _dEnc( c, 13 ), _dEnc( c, 14 ), _dEnc( c, 15 ) }
+
+static const UINT8 delta_decShuffle[256][16] = { _dRows256( _dDecRow ) };
+static const UINT8 delta_encShuffle[256][16] = { _dRows256( _dEncRow ) };
+
+/*
+ *  Encode the leading bins 4 at a time, stopping 12 bins short of num so
+ *  that the 16-byte stores stay within the data.  Returns the number of
+ *  bins encoded, and moves *ppData past their bytes.
+ */
+__attribute__(( target( "ssse3" ) ))
+static int
+delta_packSsse3( int num, UINT32* pIn, UINT8* pCtl, UINT8** ppData )
+{
+    UINT8* pData = *ppData;
+    __m128i prev = _mm_setzero_si128();
+    __m128i sign = _mm_set1_epi32( (int)0x80000000 );
+    __m128i max1 = _mm_set1_epi32( (int)( 0x80000000 | 0xFF ) );
+    __m128i max2 = _mm_set1_epi32( (int)( 0x80000000 | 0xFFFF ) );
+    __m128i max3 = _mm_set1_epi32( (int)( 0x80000000 | 0xFFFFFF ) );
+    __m128i val, z, zs, codes;
+    UINT32 x;
+    int i, ctl;
+
+    for( i = 0; i + 16 <= num; i += 4 )
+    {
+	val = _mm_loadu_si128( (__m128i*)&pIn[i] );
+	z = _mm_sub_epi32( val, _mm_alignr_epi8( val, prev, 12 ) );
+	z = _mm_xor_si128( _mm_slli_epi32( z, 1 ), _mm_srai_epi32( z, 31 ) );
+	prev = val;
+
+	/*
+	 *  Lengths less one, by unsigned compares, into a control byte
+	 */
+	zs = _mm_xor_si128( z, sign );
+	codes = _mm_add_epi32( _mm_add_epi32( _mm_cmpgt_epi32( zs, max1 ),
+					      _mm_cmpgt_epi32( zs, max2 ) ),
+			       _mm_cmpgt_epi32( zs, max3 ) );
+	codes = _mm_sub_epi32( _mm_setzero_si128(), codes );
+	codes = _mm_packs_epi32( codes, codes );
+	x = (UINT32)_mm_cvtsi128_si32( _mm_packus_epi16( codes, codes ) );
+	ctl = ( x | ( x >> 6 ) | ( x >> 12 ) | ( x >> 18 ) ) & 0xFF;
+
+	pCtl[i >> 2] = (UINT8)ctl;
+	_mm_storeu_si128( (__m128i*)pData,
+			  _mm_shuffle_epi8( z, _mm_loadu_si128(
+				(__m128i*)delta_encShuffle[ctl] ) ) );
+	pData += delta_length[ctl];
+    }
+
+    *ppData = pData;
+    return( i );
+}
+
+/*
+ *  Decode the leading bins 4 at a time, while the 16-byte loads stay
+ *  before pEnd, the end of the data.  Returns the number of bins
+ *  decoded, and moves *ppData past their bytes.
+ */
+__attribute__(( target( "ssse3" ) ))
+static int
+delta_unpackSsse3( int num, UINT8* pCtl, UINT8** ppData, UINT8* pEnd, UINT32* pOut )
+{
+    UINT8* pData = *ppData;
+    __m128i prev = _mm_setzero_si128();
+    __m128i one = _mm_set1_epi32( 1 );
+    __m128i z, d;
+    int i, ctl;
+
+    for( i = 0; ( i + 4 <= num ) && ( pData + 16 <= pEnd ); i += 4 )
+    {
+	ctl = pCtl[i >> 2];
+	z = _mm_shuffle_epi8( _mm_loadu_si128( (__m128i*)pData ),
+			      _mm_loadu_si128( (__m128i*)delta_decShuffle[ctl] ) );
+	pData += delta_length[ctl];
+
+	/*
+	 *  Undo the zigzag, then sum the differences along the bins
+	 */
+	d = _mm_xor_si128( _mm_srli_epi32( z, 1 ),
+			   _mm_sub_epi32( _mm_setzero_si128(),
+					  _mm_and_si128( z, one ) ) );
+	d = _mm_add_epi32( d, _mm_slli_si128( d, 4 ) );
+	d = _mm_add_epi32( d, _mm_slli_si128( d, 8 ) );
+	d = _mm_add_epi32( d, prev );
+
+	_mm_storeu_si128( (__m128i*)&pOut[i], d );
+	prev = _mm_shuffle_epi32( d, 0xFF );
+    }
+
+    *ppData = pData;
+    return( i );
+}
+
+#endif /* DELTA_SSSE3 */
@@ -19,6 +19,9 @@
  *
  *  Float conversions adapted from Sun RPC xdr_float.c, which is covered by a separate
  *  license (unrestricted use).
+ *
+ *  Revision history:
+ *   19-Oct-2026  agent  decode_str stores strings with MUD_strDecode
  */
 
 #include "mud.h"
@@ -126,8 +129,10 @@ decode_str( BUF* pB, char** ps )
 #endif /* DEBUG */
     pB->pos += 2;
     pB->size += 2;
-    if( *ps == NULL ) *ps = (char*)zalloc( len+1 );
-    strncpy( *ps, &pB->buf[pB->pos], len );
+    if( *ps == NULL ) 
+	*ps = MUD_strDecode( &pB->buf[pB->pos], len );
+    else
+	strncpy( *ps, &pB->buf[pB->pos], len );
     pB->pos += len;
     pB->size += len;
 #ifdef DEBUG
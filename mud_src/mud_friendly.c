@@ -32,6 +32,39 @@
  *    22-Apr-2003  v1.6  DJA  Add mud_openReadWrite
  *    25-May-2011  v1.7  DJA  Fix cast in MUD_setHistSecondsPerBin
  *    15-Oct-2020  v1.8  DF   Fix group/instance numbers in _sea_cmtgrp
+ *    18-Oct-2026  v1.9  agent Use the sidecar index (MUD_writeIndex) in
+ *                             MUD_openRead, reading histogram data on demand
+ *    19-Oct-2026  v1.10 agent Add MUD_exportColumnar
+ *    19-Oct-2026  v1.11 agent MUD_closeWrite updates changed sections of a
+ *                             MUD_openReadWrite file in place when their
+ *                             sizes are unchanged
+ *    19-Oct-2026  v1.12 agent Add MUD_openWriteStream
+ *    19-Oct-2026  v1.13 agent Add MUD_getStats
+ *    19-Oct-2026  v1.14 agent Trace points around open and close
+ *    19-Oct-2026  v1.15 agent Keep strings of files read in a string arena
+ *    19-Oct-2026  v1.16 agent Add MUD_getHistDataRebinned
+ *    19-Oct-2026  v1.17 agent Add MUD_getHistAsym
+ *    19-Oct-2026  v1.18 agent Add MUD_getHistDataOffset, for mapping
+ *                             4-byte histograms in place
+ *    19-Oct-2026  v1.19 agent Add MUD_getHistDataLocation
+ *    19-Oct-2026  v1.20 agent Handles may be used on several threads at
+ *                             once (one thread per handle); 64 handles
+ *    19-Oct-2026  v1.21 agent Add MUD_setPackThreads, to pack histograms
+ *                             together when the file is closed
+ *    19-Oct-2026  v1.22 agent Histograms of bytesPerBin MUD_BIN_SIZE_DELTA
+ *                             (zigzag deltas, see mud_delta.c)
+ *    19-Oct-2026  v1.23 agent Add MUD_releaseHist and MUD_setReleaseHists,
+ *                             to free histogram data until needed again
+ *    19-Oct-2026  v1.24 agent MUD_exportColumnar writes comment bodies whole
+ *    19-Oct-2026  v1.25 agent Add MUD_getFileNo, to map the file that was read
+ *    19-Oct-2026  v1.26 agent Streamed files are laid out as MUD_closeWrite
+ *                             writes them, each histogram header before
+ *                             its data
+ *    19-Oct-2026  v1.27 agent Data left for MUD_setPackThreads is packed
+ *                             before the number of bins or bytes per bin
+ *                             of its histogram changes
+ *    19-Oct-2026  v1.28 agent Histograms are unpacked only if their data
+ *                             are their bins within the bytes read
  *
  *  Description:
  *
@@ -48,6 +81,7 @@
  *    int MUD_openRead( char* filename, UINT32* pType )
  *    int MUD_openWrite( char* filename, UINT32 type )
  *    int MUD_openReadWrite( char* filename, UINT32* pType )
+ *    int MUD_openWriteStream( char* filename, UINT32 type )
  *    int MUD_closeRead( int fd )
  *    int MUD_closeWrite( int fd )
  *    int MUD_closeWriteFile( int fd, char* filename )
@@ -140,15 +174,23 @@
  *    int MUD_getHistNumEvents( int fd, int num, UINT32* pNumEvents )
  *    int MUD_getHistTitle( int fd, int num, char* title, int strdim )
  *    int MUD_getHistData( int fd, int num, void* pData )
+ *    int MUD_getHistDataRebinned( int fd, int num, int factor, UINT64* pData )
+ *    int MUD_getHistAsym( int fd, int numF, int numB, REAL64* pAsym, REAL64* pErr )
+ *    int MUD_getHistDataOffset( int fd, int num, UINT32* pOffset )
+ *    int MUD_getHistDataLocation( int fd, int num, UINT32* pOffset, UINT32* pNumBytes )
+ *    int MUD_getFileNo( int fd )
  *    int MUD_getHistpData( int fd, int num, void** ppData )
  *    int MUD_getHistTimeData( int fd, int num, UINT32* pTimeData )
  *    int MUD_getHistpTimeData( int fd, int num, UINT32** ppTimeData )
+ *    int MUD_releaseHist( int fd, int num )
+ *    int MUD_setReleaseHists( int fd, int release )
  *
  *    int MUD_setHists( int fd, UINT32 type, UINT32 num )
  *    int MUD_setHistType( int fd, int num, UINT32 type )
  *    int MUD_setHistNumBytes( int fd, int num, UINT32 numBytes )
  *    int MUD_setHistNumBins( int fd, int num, UINT32 numBins )
  *    int MUD_setHistBytesPerBin( int fd, int num, UINT32 bytesPerBin )
+ *                  (0 packed, 1, 2, 4, or MUD_BIN_SIZE_DELTA)
  *    int MUD_setHistFsPerBin( int fd, int num, UINT32 fsPerBin )
  *    int MUD_setHistSecondsPerBin( int fd, int num, REAL64 secondsPerBin )
  *    int MUD_setHistT0_Ps( int fd, int num, UINT32 t0_ps )
@@ -163,6 +205,7 @@
  *    int MUD_setHistpData( int fd, int num, void* pData )
  *    int MUD_setHistTimeData( int fd, int num, UINT32* pTimeData )
  *    int MUD_setHistpTimeData( int fd, int num, UINT32* pTimeData )
+ *    int MUD_setPackThreads( int fd, int nThreads )
  * 
  *    int MUD_pack( int num, int inBinSize, void* inArray, int outBinSize, void* outArray )
  *    int MUD_unpack( int num, int inBinSize, void* inArray, int outBinSize, void* outArray )
@@ -215,6 +258,54 @@
  *    int MUD_setIndVarTimeData( int fd, int num, UINT32* pTimeData )
  *    int MUD_setIndVarpData( int fd, int num, void* pData )
  *    int MUD_setIndVarpTimeData( int fd, int num, UINT32* pTimeData )
+ *
+ *    Export:
+ *
+ *    int MUD_exportColumnar( int fd, char* outfile )
+ *
+ *    Performance counters:
+ *
+ *    int MUD_getStats( int fd, MUD_STATS* pStats )
+ *
+ *  Streaming:
+ *
+ *    A file opened with MUD_openWriteStream is written as the run is
+ *    built, so that histogram data need not all be held in memory, and
+ *    is laid out as MUD_closeWrite would write the same run.  The run
+ *    description, comments, scalers and independent variables must be
+ *    set up (MUD_setRunDesc etc.) before MUD_setHists, which starts the
+ *    file with them.  Each histogram's data is packed and written, after
+ *    its header, when set with MUD_setHistData or MUD_setHistpData; the
+ *    data must be set in order of histogram number, and only once.
+ *    Everything else, including the histogram headers, may be changed
+ *    until MUD_closeWrite, which writes it again in place and fills in
+ *    the group headers, but not in size: strings must keep their length,
+ *    or MUD_closeWrite fails.
+ *
+ *  Deferred packing:
+ *
+ *    After MUD_setPackThreads( fd, nThreads ) with nThreads != 0,
+ *    MUD_setHistData keeps a copy of the data of packed histograms
+ *    (bytesPerBin 0) rather than packing it, and MUD_closeWrite (or
+ *    MUD_closeWriteFile) packs them all at once on nThreads threads (< 0:
+ *    one per processor) with MUD_packHists before writing the file.  The
+ *    copies take 4 bytes per bin until then, and MUD_getHistNumBytes is
+ *    not up to date; getting the data of a histogram packs it first, as
+ *    does changing its number of bins or bytes per bin (so the data are
+ *    packed as set, just as without deferring).  Not for files opened
+ *    with MUD_openWriteStream.
+ *
+ *  Releasing histogram data:
+ *
+ *    MUD_releaseHist( fd, num ) frees the data of histogram num as
+ *    stored (packed or not), which is read from the file again, through
+ *    the index if there is one, when next needed.  After
+ *    MUD_setReleaseHists( fd, TRUE ) this is done by MUD_getHistData,
+ *    MUD_getHistDataRebinned and MUD_getHistAsym once they have unpacked
+ *    it, so that a handle held open keeps only what was asked for.  Data
+ *    can only be released while the file is unchanged (as for
+ *    MUD_getHistDataLocation); MUD_releaseHist fails otherwise.  Pointers
+ *    from MUD_getHistpData are not valid after the data is released.
  */
 
 #include <stdlib.h>
@@ -223,98 +314,325 @@
 
 #include "mud.h"
 
-#define MUD_MAX_FILES 16
+#define MUD_MAX_FILES 64
 #define MUD_FILE_READ  1
 #define MUD_FILE_WRITE 2
 
+/*
+ *  Open files, by handle.  A handle is taken and given back under
+ *  MUD_lock (MUD_newFd, MUD_freeFd); in between it is only used by the
+ *  thread that opened it, so that runs can be read on several threads.
+ */
 static FILE* mud_f[MUD_MAX_FILES] = { 0 };
 static MUD_SEC_GRP* pMUD_fileGrp[MUD_MAX_FILES];
+static MUD_IDX* pMUD_idx[MUD_MAX_FILES];
+static MUD_STR_ARENA* pMUD_strs[MUD_MAX_FILES];   /* strings read */
+
+/*
+ *  Sections changed since MUD_openReadWrite, for writing in place
+ */
+#define MUD_PATCH_NONE     0  /* not opened with MUD_openReadWrite */
+#define MUD_PATCH_OK       1  /* changed sections can be written in place */
+#define MUD_PATCH_REWRITE  2  /* structure changed: rewrite the file */
+
+typedef struct _MUD_DIRTY {
+  struct _MUD_DIRTY* pNext;
+  MUD_SEC* pMUD;
+  UINT32 offset;              /* offset of section in file */
+  UINT32 size;                /* size of section in file */
+} MUD_DIRTY;
+
+static int mud_patch[MUD_MAX_FILES];
+static MUD_DIRTY* pMUD_dirty[MUD_MAX_FILES];
+
+/*
+ *  Run in memory no longer the same as the file: set by the "set"
+ *  routines, and for files opened with MUD_openWrite
+ */
+static BOOL mud_changed[MUD_MAX_FILES];
+
+/*
+ *  Files opened with MUD_openWriteStream
+ */
+typedef struct _MUD_STREAMED {
+  struct _MUD_STREAMED* pNext;
+  MUD_SEC* pMUD;              /* section written before it was final */
+  UINT32 offset;              /* of the section in the file */
+  UINT32 size;                /* as written, with its members if a group */
+} MUD_STREAMED;
+
+typedef struct _MUD_STREAM {
+  MUD_SEC_GRP* pFileGrp;      /* file group header, as written */
+  MUD_SEC_GRP* pHistGrp;      /* histogram group header, as written */
+  MUD_SEC_GRP* pHists;        /* histogram group being streamed */
+  MUD_SEC* pNextHist;         /* next member of pHists to be written */
+  MUD_STREAMED* pStreamed;    /* to be written again by MUD_closeWrite */
+} MUD_STREAM;
+
+static MUD_STREAM* pMUD_stream[MUD_MAX_FILES];
+
+/*
+ *  Histogram data set but not yet packed, after MUD_setPackThreads
+ */
+typedef struct _MUD_UNPACKED {
+  struct _MUD_UNPACKED* pNext;
+  MUD_SEC_GEN_HIST_HDR* pHdr;
+  MUD_SEC_GEN_HIST_DAT* pDat;
+  UINT32 nBins;
+  UINT32* pData;              /* copy of the 4-byte bins */
+} MUD_UNPACKED;
+
+static int mud_packThreads[MUD_MAX_FILES];    /* 0: pack when set */
+static MUD_UNPACKED* pMUD_unpacked[MUD_MAX_FILES];
+
+/*
+ *  Histogram data freed by MUD_releaseHist, from a file with no index
+ */
+typedef struct _MUD_RELEASED {
+  struct _MUD_RELEASED* pNext;
+  MUD_SEC_GEN_HIST_DAT* pDat;
+  UINT32 offset;              /* of the data in the file */
+} MUD_RELEASED;
+
+static BOOL mud_releaseHists[MUD_MAX_FILES];  /* release once unpacked */
+static MUD_RELEASED* pMUD_released[MUD_MAX_FILES];
+
+/*
+ *  Counters since open; pMUD_stats points at those of the handle in use
+ */
+static MUD_STATS mud_stats[MUD_MAX_FILES];
+
+#define _start_stats( fd ) \
+  bzero( &mud_stats[fd], sizeof( MUD_STATS ) ); \
+  pMUD_stats = &mud_stats[fd]
+
+static int MUD_newFd _ANSI_ARGS_(( FILE* fp ));
+static void MUD_freeFd _ANSI_ARGS_(( int fd ));
+static int MUD_loadHistDat _ANSI_ARGS_(( int fd, MUD_SEC_GRP* pMUD_histGrp, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static int MUD_unpackHist _ANSI_ARGS_(( int fd, int num, int outBinSize, void* pData ));
+static BOOL MUD_findOffset _ANSI_ARGS_(( MUD_SEC_GRP* pMUD_grp, UINT32 grpOffset, MUD_SEC* pMUD, UINT32* pOffset ));
+static void MUD_markDirty _ANSI_ARGS_(( int fd, void* pMUD ));
+static BOOL MUD_patchFile _ANSI_ARGS_(( int fd ));
+static void MUD_freeDirty _ANSI_ARGS_(( int fd ));
+static BOOL MUD_startStream _ANSI_ARGS_(( int fd, MUD_SEC_GRP* pMUD_histGrp ));
+static BOOL MUD_writeStreamSec _ANSI_ARGS_(( int fd, MUD_SEC_GRP* pMUD_grp, MUD_SEC* pMUD, BOOL again ));
+static BOOL MUD_streamInOrder _ANSI_ARGS_(( int fd, MUD_SEC_GRP* pMUD_histGrp, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static int MUD_streamHistDat _ANSI_ARGS_(( int fd, MUD_SEC_GRP* pMUD_histGrp, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static BOOL MUD_endStream _ANSI_ARGS_(( int fd ));
+static void MUD_freeStream _ANSI_ARGS_(( int fd ));
+static int MUD_deferPack _ANSI_ARGS_(( int fd, MUD_SEC_GEN_HIST_HDR* pMUD_histHdr, MUD_SEC_GEN_HIST_DAT* pMUD_histDat, void* pData ));
+static int MUD_packUnpacked _ANSI_ARGS_(( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static int MUD_packUnpackedHdr _ANSI_ARGS_(( int fd, MUD_SEC_GEN_HIST_HDR* pMUD_histHdr ));
+static void MUD_freeUnpacked _ANSI_ARGS_(( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static int MUD_releaseHistDat _ANSI_ARGS_(( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static int MUD_rereadHistDat _ANSI_ARGS_(( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat ));
+static void MUD_freeReleased _ANSI_ARGS_(( int fd ));
+
+#define _mark_rewrite( fd ) \
+  mud_changed[fd] = TRUE; \
+  if( mud_patch[fd] == MUD_PATCH_OK ) mud_patch[fd] = MUD_PATCH_REWRITE
+
+#define _check_stream( fd )  if( ( pMUD_stream[fd] != NULL ) && \
+                                 ( pMUD_stream[fd]->pHists != NULL ) ) \
+                               return( 0 )
 
 #define _strncpy( To, From, Len) strncpy( To, From, Len )[Len-1]='\0'
 
-int 
-MUD_openRead( char* filename, UINT32* pType )
+#define _file_type( fd ) \
+  ( ( pMUD_fileGrp[fd] != NULL ) ? MUD_instanceID( pMUD_fileGrp[fd] ) : 0 )
+
+#define _open_return( type, fd ) \
+  { _trace( open_end, MUD_TRACE_OPEN_END, type, fd, 0 ); return( fd ); }
+
+#define _close_return( type, fd, ok ) \
+  { _trace( close_end, MUD_TRACE_CLOSE_END, type, fd, 0 ); return( ok ); }
+
+/*
+ *  Take a free handle for open file fp, or return -1 if there is none
+ */
+static int
+MUD_newFd( FILE* fp )
 {
   int fd;
 
+  MUD_lock();
   for( fd = 0; fd < MUD_MAX_FILES; fd++ ) 
   {
-    if( mud_f[fd] == NULL ) break;
+    if( mud_f[fd] == NULL ) 
+    {
+      mud_f[fd] = fp;
+      break;
+    }
   }
-  if( fd == MUD_MAX_FILES ) return( -1 );
+  MUD_unlock();
+
+  if( fd >= MUD_MAX_FILES ) return( -1 );
+
+  mud_packThreads[fd] = 0;
+  pMUD_unpacked[fd] = NULL;
+  mud_releaseHists[fd] = FALSE;
+  pMUD_released[fd] = NULL;
+  return( fd );
+}
+
+/*
+ *  Give back handle fd, once its file is closed
+ */
+static void
+MUD_freeFd( int fd )
+{
+  MUD_lock();
+  mud_f[fd] = NULL;
+  MUD_unlock();
+}
 
-  mud_f[fd] = MUD_openInput( filename );
-  if( mud_f[fd] == NULL ) return( -1 );
+int 
+MUD_openRead( char* filename, UINT32* pType )
+{
+  FILE* fin;
+  int fd;
+
+  _trace( open_begin, MUD_TRACE_OPEN_BEGIN, 0, -1, 0 );
+
+  fin = MUD_openInput( filename );
+  if( fin == NULL ) _open_return( 0, -1 );
+  fd = MUD_newFd( fin );
+  if( fd < 0 )
+  {
+    fclose( fin );
+    _open_return( 0, -1 );
+  }
+  _start_stats( fd );
 
   /*
-   *  Just read the whole file
-   *  Might want to make this more complicated, 
-   *  i.e., only read when needed, keep track of 
-   *  what's already read.
+   *  With an up-to-date index, read everything but the histogram
+   *  data, which is read when asked for.  Otherwise just read the
+   *  whole file.
    */
-  pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readFile( mud_f[fd] );
+  pMUD_fileGrp[fd] = NULL;
+  mud_patch[fd] = MUD_PATCH_NONE;
+  mud_changed[fd] = FALSE;
+  pMUD_stream[fd] = NULL;
+  pMUD_strs[fd] = MUD_newStrArena( TRUE );
+  pMUD_strArena = pMUD_strs[fd];
+  pMUD_idx[fd] = MUD_readIndex( filename );
+  if( pMUD_idx[fd] != NULL )
+  {
+    pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readFileIndexed( mud_f[fd], pMUD_idx[fd] );
+    if( pMUD_fileGrp[fd] == NULL )
+    {
+      MUD_freeIndex( pMUD_idx[fd] );
+      pMUD_idx[fd] = NULL;
+    }
+  }
+  if( pMUD_fileGrp[fd] == NULL )
+  {
+    pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readFile( mud_f[fd] );
+  }
+  pMUD_strArena = NULL;
   if( pMUD_fileGrp[fd] == NULL )
   {
+    MUD_freeStrArena( pMUD_strs[fd] );
+    pMUD_strs[fd] = NULL;
     fclose( mud_f[fd] );
-    mud_f[fd] = NULL;
-    return( -1 );
+    MUD_freeFd( fd );
+    _open_return( 0, -1 );
   }
 
   *pType = MUD_instanceID( pMUD_fileGrp[fd] );
 
-  return( fd );
+  _open_return( *pType, fd );
 }
 
 int 
 MUD_openReadWrite( char* filename, UINT32* pType )
 {
+  FILE* fio;
   int fd;
 
-  for( fd = 0; fd < MUD_MAX_FILES; fd++ ) 
+  _trace( open_begin, MUD_TRACE_OPEN_BEGIN, 0, -1, 0 );
+
+  fio = MUD_openInOut( filename );
+  if( fio == NULL ) _open_return( 0, -1 );
+  fd = MUD_newFd( fio );
+  if( fd < 0 )
   {
-    if( mud_f[fd] == NULL ) break;
+    fclose( fio );
+    _open_return( 0, -1 );
   }
-  if( fd == MUD_MAX_FILES ) return( -1 );
-
-  mud_f[fd] = MUD_openInOut( filename );
-  if( mud_f[fd] == NULL ) return( -1 );
+  _start_stats( fd );
 
   /*
    *  Just read the whole file.  Must do so in ReadWrite version.
    */
+  pMUD_strs[fd] = MUD_newStrArena( TRUE );
+  pMUD_strArena = pMUD_strs[fd];
   pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_readFile( mud_f[fd] );
+  pMUD_strArena = NULL;
   if( pMUD_fileGrp[fd] == NULL ) 
   {
+    MUD_freeStrArena( pMUD_strs[fd] );
+    pMUD_strs[fd] = NULL;
     fclose( mud_f[fd] );
-    mud_f[fd] = NULL;
-    return( -1 );
+    MUD_freeFd( fd );
+    _open_return( 0, -1 );
   }
+  mud_patch[fd] = MUD_PATCH_OK;
+  mud_changed[fd] = FALSE;
+  pMUD_stream[fd] = NULL;
 
   *pType = MUD_instanceID( pMUD_fileGrp[fd] );
 
-  return( fd );
+  _open_return( *pType, fd );
 }
 
 
 int 
 MUD_openWrite( char* filename, UINT32 type )
 {
+  FILE* fout;
   int fd;
 
-  for( fd = 0; fd < MUD_MAX_FILES; fd++ ) 
+  _trace( open_begin, MUD_TRACE_OPEN_BEGIN, type, -1, 0 );
+
+  fout = MUD_openOutput( filename );
+  if( fout == NULL ) _open_return( type, -1 );
+  fd = MUD_newFd( fout );
+  if( fd < 0 )
   {
-    if( mud_f[fd] == NULL ) break;
+    fclose( fout );
+    _open_return( type, -1 );
   }
-  if( fd == MUD_MAX_FILES ) return( -1 );
-
-  mud_f[fd] = MUD_openOutput( filename );
-  if( mud_f[fd] == NULL ) return( -1 );
+  _start_stats( fd );
 
   pMUD_fileGrp[fd] = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_fileGrp[fd] == NULL )
   {
     fclose( mud_f[fd] );
-    mud_f[fd] = NULL;
+    MUD_freeFd( fd );
+    _open_return( type, -1 );
+  }
+  mud_patch[fd] = MUD_PATCH_NONE;
+  mud_changed[fd] = TRUE;
+  pMUD_stream[fd] = NULL;
+  pMUD_strs[fd] = NULL;
+
+  _open_return( type, fd );
+}
+
+
+int 
+MUD_openWriteStream( char* filename, UINT32 type )
+{
+  int fd;
+
+  fd = MUD_openWrite( filename, type );
+  if( fd < 0 ) return( -1 );
+
+  pMUD_stream[fd] = (MUD_STREAM*)zalloc( sizeof( MUD_STREAM ) );
+  if( pMUD_stream[fd] == NULL )
+  {
+    MUD_closeRead( fd );
     return( -1 );
   }
 
@@ -325,22 +643,38 @@ MUD_openWrite( char* filename, UINT32 type )
 int 
 MUD_closeRead( int fd )
 {
+  UINT32 type;
+
   if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
   {
     return( 0 );
   }
+  pMUD_stats = &mud_stats[fd];
+  type = _file_type( fd );
+  _trace( close_begin, MUD_TRACE_CLOSE_BEGIN, type, fd, 0 );
 
   /*
    *  Free the list
    */
+  pMUD_strArena = pMUD_strs[fd];
   if( pMUD_fileGrp[fd] != NULL )
   {
     MUD_free( pMUD_fileGrp[fd] );
     pMUD_fileGrp[fd] = NULL;
   }
+  MUD_freeStrArena( pMUD_strs[fd] );
+  pMUD_strs[fd] = NULL;
+  MUD_freeIndex( pMUD_idx[fd] );
+  pMUD_idx[fd] = NULL;
+  MUD_freeDirty( fd );
+  MUD_freeStream( fd );
+  MUD_freeUnpacked( fd, NULL );
+  MUD_freeReleased( fd );
 
   fclose( mud_f[fd] );
-  mud_f[fd] = NULL;
+  MUD_freeFd( fd );
+  pMUD_stats = NULL;
+  _trace( close_end, MUD_TRACE_CLOSE_END, type, fd, 0 );
 
   return( 1 );
 }
@@ -349,53 +683,106 @@ MUD_closeRead( int fd )
 int 
 MUD_closeWrite( int fd )
 {
+  UINT32 type;
+  int ok = 1;
+
   if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
   {
     return( 0 );
   }
+  pMUD_stats = &mud_stats[fd];
+  type = _file_type( fd );
+  _trace( close_begin, MUD_TRACE_CLOSE_BEGIN, type, fd, 0 );
+
+  if( !MUD_loadHistDat( fd, NULL, NULL ) ) _close_return( type, fd, 0 );
+  MUD_freeIndex( pMUD_idx[fd] );
+  pMUD_idx[fd] = NULL;
 
   /*
-   *  Re-index mud groups (memSize and index.offset)
-   */
-  MUD_setSizes( pMUD_fileGrp[fd] );
-  /*
-   *  Write the file out if it's an output file
+   *  Finish a streamed file, or write just the changed sections of a 
+   *  ReadWrite file if they still fit, otherwise write the whole file
    */
-  MUD_writeFile( mud_f[fd], pMUD_fileGrp[fd] ); 
+  if( ( pMUD_stream[fd] != NULL ) && ( pMUD_stream[fd]->pHists != NULL ) )
+  {
+    ok = MUD_endStream( fd );
+  }
+  else if( !MUD_patchFile( fd ) )
+  {
+    /*
+     *  Re-index mud groups (memSize and index.offset)
+     */
+    MUD_setSizes( pMUD_fileGrp[fd] );
+    /*
+     *  Write the file out if it's an output file
+     */
+    MUD_writeFile( mud_f[fd], pMUD_fileGrp[fd] ); 
+  }
+  MUD_freeDirty( fd );
+  MUD_freeStream( fd );
+  MUD_freeUnpacked( fd, NULL );
+  MUD_freeReleased( fd );
 
   /*
    *  Free the list
    */
+  pMUD_strArena = pMUD_strs[fd];
   if( pMUD_fileGrp[fd] != NULL )
   {
     MUD_free( pMUD_fileGrp[fd] );
     pMUD_fileGrp[fd] = NULL;
   }
+  MUD_freeStrArena( pMUD_strs[fd] );
+  pMUD_strs[fd] = NULL;
 
   fclose( mud_f[fd] );
-  mud_f[fd] = NULL;
+  MUD_freeFd( fd );
+  pMUD_stats = NULL;
+  _trace( close_end, MUD_TRACE_CLOSE_END, type, fd, 0 );
 
-  return( 1 );
+  return( ok );
 }
 
 int 
 MUD_closeWriteFile( int fd, char* outname )
 {
+  FILE* fout;
+  UINT32 type;
+
   if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
   {
     return( 0 );
   }
+  pMUD_stats = &mud_stats[fd];
+  type = _file_type( fd );
+  _trace( close_begin, MUD_TRACE_CLOSE_BEGIN, type, fd, 0 );
 
   /*
-   * Close the input file
+   *  A streamed file is already being written where it was opened
    */
+  if( pMUD_stream[fd] != NULL ) _close_return( type, fd, 0 );
+
+  /*
+   *  Read any histogram data not yet read, then close the input file
+   */
+  if( !MUD_loadHistDat( fd, NULL, NULL ) ) _close_return( type, fd, 0 );
+  MUD_freeIndex( pMUD_idx[fd] );
+  pMUD_idx[fd] = NULL;
+  MUD_freeDirty( fd );
+  MUD_freeUnpacked( fd, NULL );
+  MUD_freeReleased( fd );
+
   fclose( mud_f[fd] );
 
   /*
-   * Open output file on same fd index
+   * Open output file on same fd index, which stays taken meanwhile
    */
-  mud_f[fd] = MUD_openOutput( outname );
-  if( mud_f[fd] == NULL ) return( 0 );
+  fout = MUD_openOutput( outname );
+  if( fout == NULL ) 
+  {
+    MUD_freeFd( fd );
+    _close_return( type, fd, 0 );
+  }
+  mud_f[fd] = fout;
 
   /*
    *  Re-index mud groups (memSize and index.offset)
@@ -409,14 +796,19 @@ MUD_closeWriteFile( int fd, char* outname )
   /*
    *  Free the list
    */
+  pMUD_strArena = pMUD_strs[fd];
   if( pMUD_fileGrp[fd] != NULL )
   {
     MUD_free( pMUD_fileGrp[fd] );
     pMUD_fileGrp[fd] = NULL;
   }
+  MUD_freeStrArena( pMUD_strs[fd] );
+  pMUD_strs[fd] = NULL;
 
   fclose( mud_f[fd] );
-  mud_f[fd] = NULL;
+  MUD_freeFd( fd );
+  pMUD_stats = NULL;
+  _trace( close_end, MUD_TRACE_CLOSE_END, type, fd, 0 );
 
   return( 1 );
 }
@@ -424,7 +816,402 @@ MUD_closeWriteFile( int fd, char* outname )
 
 #define _check_fd( fd )  if( ( fd < 0 ) || \
                              ( fd >= MUD_MAX_FILES ) || \
-                             ( mud_f[fd] == NULL ) ) return( 0 )
+                             ( mud_f[fd] == NULL ) ) return( 0 ); \
+                         pMUD_stats = &mud_stats[fd]
+
+/*
+ *  Read histogram data left unread by MUD_openRead with an index or
+ *  released by MUD_releaseHist, or pack data left unpacked by
+ *  MUD_setHistData: the section pMUD_histDat of group pMUD_histGrp, or
+ *  all of them when pMUD_histGrp is NULL.
+ */
+static int
+MUD_loadHistDat( int fd, MUD_SEC_GRP* pMUD_histGrp, 
+                 MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_SEC* pMUD_grp;
+  MUD_SEC* pMUD;
+  MUD_SEC_GEN_HIST_DAT* pMUD_read;
+  int grp, dat;
+
+  if( !MUD_packUnpacked( fd, pMUD_histDat ) ) return( 0 );
+  if( ( pMUD_idx[fd] == NULL ) && ( pMUD_released[fd] == NULL ) ) 
+    return( 1 );
+
+  if( pMUD_histGrp == NULL )
+  {
+    for( pMUD_grp = pMUD_fileGrp[fd]->pMem; pMUD_grp != NULL; 
+         pMUD_grp = pMUD_grp->core.pNext )
+    {
+      if( MUD_secID( pMUD_grp ) != MUD_SEC_GRP_ID ) continue;
+      for( pMUD = ((MUD_SEC_GRP*)pMUD_grp)->pMem; pMUD != NULL; 
+           pMUD = pMUD->core.pNext )
+      {
+        if( ( MUD_secID( pMUD ) == MUD_SEC_GEN_HIST_DAT_ID ) &&
+            !MUD_loadHistDat( fd, (MUD_SEC_GRP*)pMUD_grp, 
+                              (MUD_SEC_GEN_HIST_DAT*)pMUD ) ) return( 0 );
+      }
+    }
+    return( 1 );
+  }
+
+  if( ( pMUD_histDat->pData != NULL ) || ( pMUD_histDat->nBytes == 0 ) )
+    return( 1 );
+  if( pMUD_idx[fd] == NULL ) return( MUD_rereadHistDat( fd, pMUD_histDat ) );
+
+  /*
+   *  Histogram groups are members of the file group (entry 0)
+   */
+  grp = MUD_findIndex( pMUD_idx[fd], 0, MUD_SEC_GRP_ID, 
+                       MUD_instanceID( pMUD_histGrp ) );
+  if( grp < 0 ) return( 0 );
+  dat = MUD_findIndex( pMUD_idx[fd], grp, MUD_SEC_GEN_HIST_DAT_ID,
+                       MUD_instanceID( pMUD_histDat ) );
+  if( dat < 0 ) return( 0 );
+
+  pMUD_read = (MUD_SEC_GEN_HIST_DAT*)MUD_readEntry( mud_f[fd], 
+                                         &pMUD_idx[fd]->pEntry[dat] );
+  if( pMUD_read == NULL ) return( 0 );
+
+  pMUD_histDat->nBytes = pMUD_read->nBytes;
+  pMUD_histDat->pData = pMUD_read->pData;
+  pMUD_read->pData = NULL;
+  MUD_free( pMUD_read );
+
+  return( 1 );
+}
+
+/*
+ *  Offset in the file of section pMUD within group pMUD_grp (at 
+ *  grpOffset), from the group member index as read from the file.
+ */
+static BOOL
+MUD_findOffset( MUD_SEC_GRP* pMUD_grp, UINT32 grpOffset, MUD_SEC* pMUD,
+                UINT32* pOffset )
+{
+  MUD_SEC* pMember;
+  MUD_INDEX* pIndex;
+  UINT32 offset;
+
+  if( pMUD == (MUD_SEC*)pMUD_grp )
+  {
+    *pOffset = grpOffset;
+    return( TRUE );
+  }
+
+  for( pMember = pMUD_grp->pMem, pIndex = pMUD_grp->pMemIndex;
+       pMember != NULL;
+       pMember = pMember->core.pNext, pIndex = pIndex->pNext )
+  {
+    if( ( pIndex == NULL ) || 
+        ( pIndex->secID != MUD_secID( pMember ) ) ||
+        ( pIndex->instanceID != MUD_instanceID( pMember ) ) )
+      return( FALSE );
+
+    offset = grpOffset + MUD_size( pMUD_grp ) + pIndex->offset;
+    if( pMember == pMUD )
+    {
+      *pOffset = offset;
+      return( TRUE );
+    }
+    if( ( MUD_secID( pMember ) == MUD_SEC_GRP_ID ) &&
+        MUD_findOffset( (MUD_SEC_GRP*)pMember, offset, pMUD, pOffset ) )
+      return( TRUE );
+  }
+
+  return( FALSE );
+}
+
+/*
+ *  Note a change to section pMUD, and for a ReadWrite file where it is
+ *  in the file.  Called by the "set" routines.
+ */
+static void
+MUD_markDirty( int fd, void* pMUD )
+{
+  MUD_DIRTY* pDirty;
+
+  mud_changed[fd] = TRUE;
+  if( ( mud_patch[fd] != MUD_PATCH_OK ) || ( pMUD == NULL ) ) return;
+
+  for( pDirty = pMUD_dirty[fd]; pDirty != NULL; pDirty = pDirty->pNext )
+  {
+    if( pDirty->pMUD == (MUD_SEC*)pMUD ) return;
+  }
+
+  pDirty = (MUD_DIRTY*)malloc( sizeof( MUD_DIRTY ) );
+  if( ( pDirty == NULL ) ||
+      !MUD_findOffset( pMUD_fileGrp[fd], 0, (MUD_SEC*)pMUD, &pDirty->offset ) )
+  {
+    _free( pDirty );
+    mud_patch[fd] = MUD_PATCH_REWRITE;
+    return;
+  }
+  pDirty->pMUD = (MUD_SEC*)pMUD;
+  pDirty->size = MUD_size( pMUD );
+  pDirty->pNext = pMUD_dirty[fd];
+  pMUD_dirty[fd] = pDirty;
+}
+
+/*
+ *  Write the changed sections of a ReadWrite file in place.  Returns
+ *  FALSE, having written nothing, if the file must be rewritten instead;
+ *  or if a write fails, leaving the rewrite to correct the file.
+ */
+static BOOL
+MUD_patchFile( int fd )
+{
+  MUD_DIRTY* pDirty;
+  BUF buf;
+  char core[12];
+  UINT32 size, secID, instanceID;
+  BOOL ok = TRUE;
+
+  if( mud_patch[fd] != MUD_PATCH_OK ) return( FALSE );
+
+  /*
+   *  Check that every section still fits, and is where it should be
+   */
+  for( pDirty = pMUD_dirty[fd]; pDirty != NULL; pDirty = pDirty->pNext )
+  {
+    if( MUD_getSize( pDirty->pMUD ) != pDirty->size ) return( FALSE );
+    if( MUD_pread( mud_f[fd], core, 12, pDirty->offset ) != 12 ) 
+      return( FALSE );
+    bdecode_4( &core[0], &size );
+    bdecode_4( &core[4], &secID );
+    bdecode_4( &core[8], &instanceID );
+    if( ( size != pDirty->size ) || 
+        ( secID != MUD_secID( pDirty->pMUD ) ) ||
+        ( instanceID != MUD_instanceID( pDirty->pMUD ) ) ) return( FALSE );
+  }
+
+  for( pDirty = pMUD_dirty[fd]; ok && ( pDirty != NULL ); 
+       pDirty = pDirty->pNext )
+  {
+    bzero( &buf, sizeof( BUF ) );
+    ok = MUD_encode( &buf, pDirty->pMUD, MUD_ONE ) &&
+         ( MUD_pwrite( mud_f[fd], buf.buf, buf.size, pDirty->offset ) == 
+           buf.size );
+    _free( buf.buf );
+  }
+
+  return( ok );
+}
+
+static void
+MUD_freeDirty( int fd )
+{
+  MUD_DIRTY* pDirty;
+
+  while( pMUD_dirty[fd] != NULL )
+  {
+    pDirty = pMUD_dirty[fd];
+    pMUD_dirty[fd] = pDirty->pNext;
+    free( pDirty );
+  }
+  mud_patch[fd] = MUD_PATCH_NONE;
+}
+
+/*
+ *  Write section pMUD, with its members if it is a group, as the next
+ *  member of group pMUD_grp of a streamed file.  If it may still change
+ *  (again), note where, to be written again by MUD_endStream.
+ */
+static BOOL
+MUD_writeStreamSec( int fd, MUD_SEC_GRP* pMUD_grp, MUD_SEC* pMUD, BOOL again )
+{
+  MUD_STREAM* pStream = pMUD_stream[fd];
+  MUD_STREAMED* pStreamed;
+  long offset;
+
+  offset = ftell( mud_f[fd] );
+
+  if( MUD_secID( pMUD ) == MUD_SEC_GRP_ID ) MUD_setSizes( pMUD );
+  if( !MUD_writeGrpMem( mud_f[fd], pMUD_grp, pMUD ) ) return( FALSE );
+  if( ( MUD_secID( pMUD ) == MUD_SEC_GRP_ID ) &&
+      !MUD_write( mud_f[fd], ((MUD_SEC_GRP*)pMUD)->pMem, MUD_ALL ) )
+    return( FALSE );
+
+  if( !again ) return( TRUE );
+
+  pStreamed = (MUD_STREAMED*)malloc( sizeof( MUD_STREAMED ) );
+  if( pStreamed == NULL ) return( FALSE );
+  pStreamed->pMUD = pMUD;
+  pStreamed->offset = (UINT32)offset;
+  pStreamed->size = (UINT32)( ftell( mud_f[fd] ) - offset );
+  pStreamed->pNext = pStream->pStreamed;
+  pStream->pStreamed = pStreamed;
+
+  return( TRUE );
+}
+
+/*
+ *  Start writing a streamed file, at the histogram group just added by
+ *  MUD_setHists: the file group, the members before the histogram group,
+ *  and the histogram group header.
+ */
+static BOOL
+MUD_startStream( int fd, MUD_SEC_GRP* pMUD_histGrp )
+{
+  MUD_STREAM* pStream = pMUD_stream[fd];
+  MUD_SEC* pMember;
+  int num = 0;
+
+  for( pMember = pMUD_fileGrp[fd]->pMem; pMember != NULL; 
+       pMember = pMember->core.pNext ) num++;
+
+  pStream->pFileGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, 
+                                      MUD_instanceID( pMUD_fileGrp[fd] ) );
+  pStream->pHistGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, 
+                                      MUD_instanceID( pMUD_histGrp ) );
+  if( ( pStream->pFileGrp == NULL ) || ( pStream->pHistGrp == NULL ) ) 
+    return( FALSE );
+
+  rewind( mud_f[fd] );
+  if( !MUD_writeGrpStart( mud_f[fd], NULL, pStream->pFileGrp, num ) )
+    return( FALSE );
+
+  for( pMember = pMUD_fileGrp[fd]->pMem; pMember != (MUD_SEC*)pMUD_histGrp;
+       pMember = pMember->core.pNext )
+  {
+    if( !MUD_writeStreamSec( fd, pStream->pFileGrp, pMember, TRUE ) ) 
+      return( FALSE );
+  }
+
+  if( !MUD_writeGrpStart( mud_f[fd], pStream->pFileGrp, pStream->pHistGrp, 
+                          pMUD_histGrp->num ) ) 
+    return( FALSE );
+
+  pStream->pHists = pMUD_histGrp;
+  pStream->pNextHist = pMUD_histGrp->pMem;
+  return( TRUE );
+}
+
+/*
+ *  Whether the data of histogram pMUD_histDat may be set now: not yet
+ *  written, and the data of the histograms before it already written.
+ */
+static BOOL
+MUD_streamInOrder( int fd, MUD_SEC_GRP* pMUD_histGrp,
+                   MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_STREAM* pStream = pMUD_stream[fd];
+  MUD_SEC* pMember;
+
+  if( ( pStream == NULL ) || ( pStream->pHists != pMUD_histGrp ) ) 
+    return( TRUE );
+
+  for( pMember = pStream->pNextHist; pMember != (MUD_SEC*)pMUD_histDat;
+       pMember = pMember->core.pNext )
+  {
+    if( ( pMember == NULL ) || 
+        ( MUD_secID( pMember ) == MUD_SEC_GEN_HIST_DAT_ID ) ) return( FALSE );
+  }
+  return( TRUE );
+}
+
+/*
+ *  Write histogram data as it is set, if streaming, after the headers
+ *  before it
+ */
+static int
+MUD_streamHistDat( int fd, MUD_SEC_GRP* pMUD_histGrp,
+                   MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_STREAM* pStream = pMUD_stream[fd];
+  MUD_SEC* pMember;
+
+  if( ( pStream == NULL ) || ( pStream->pHists != pMUD_histGrp ) ) 
+    return( 1 );
+
+  while( ( pMember = pStream->pNextHist ) != NULL )
+  {
+    if( !MUD_writeStreamSec( fd, pStream->pHistGrp, pMember, 
+                             ( pMember != (MUD_SEC*)pMUD_histDat ) ) ) 
+      return( 0 );
+    pStream->pNextHist = pMember->core.pNext;
+    if( pMember == (MUD_SEC*)pMUD_histDat ) break;
+  }
+
+  return( 1 );
+}
+
+/*
+ *  Finish a streamed file: the rest of the histogram group, any members
+ *  of the file group added after it, and the group headers.  Then write
+ *  the sections which were written before they were final again, in
+ *  place; they must not have changed in size.
+ */
+static BOOL
+MUD_endStream( int fd )
+{
+  MUD_STREAM* pStream = pMUD_stream[fd];
+  MUD_STREAMED* pStreamed;
+  MUD_SEC* pMember;
+  BUF buf;
+  BOOL ok = TRUE;
+
+  for( pMember = pStream->pNextHist; pMember != NULL;
+       pMember = pMember->core.pNext )
+  {
+    if( !MUD_writeStreamSec( fd, pStream->pHistGrp, pMember, FALSE ) ) 
+      return( FALSE );
+  }
+  pStream->pNextHist = NULL;
+  if( !MUD_writeGrpEnd( mud_f[fd], pStream->pHistGrp ) ) return( FALSE );
+
+  for( pMember = pStream->pHists->core.pNext; pMember != NULL;
+       pMember = pMember->core.pNext )
+  {
+    if( !MUD_writeStreamSec( fd, pStream->pFileGrp, pMember, FALSE ) ) 
+      return( FALSE );
+  }
+  if( !MUD_writeGrpEnd( mud_f[fd], pStream->pFileGrp ) ||
+      !MUD_writeEnd( mud_f[fd] ) || ( fflush( mud_f[fd] ) == EOF ) ) 
+    return( FALSE );
+
+  for( pStreamed = pStream->pStreamed; ok && ( pStreamed != NULL );
+       pStreamed = pStreamed->pNext )
+  {
+    pMember = pStreamed->pMUD;
+    bzero( &buf, sizeof( BUF ) );
+    if( MUD_secID( pMember ) == MUD_SEC_GRP_ID ) 
+    {
+      MUD_setSizes( pMember );
+      ok = MUD_encode( &buf, pMember, MUD_ONE ) &&
+           MUD_encode( &buf, ((MUD_SEC_GRP*)pMember)->pMem, MUD_ALL );
+    }
+    else
+    {
+      ok = MUD_encode( &buf, pMember, MUD_ONE );
+    }
+    ok = ok && ( buf.size == pStreamed->size ) &&
+         ( MUD_pwrite( mud_f[fd], buf.buf, buf.size, pStreamed->offset ) == 
+           buf.size );
+    _free( buf.buf );
+  }
+
+  return( ok );
+}
+
+static void
+MUD_freeStream( int fd )
+{
+  MUD_STREAMED* pStreamed;
+
+  if( pMUD_stream[fd] == NULL ) return;
+
+  while( pMUD_stream[fd]->pStreamed != NULL )
+  {
+    pStreamed = pMUD_stream[fd]->pStreamed;
+    pMUD_stream[fd]->pStreamed = pStreamed->pNext;
+    free( pStreamed );
+  }
+  MUD_free( pMUD_stream[fd]->pHistGrp );
+  MUD_free( pMUD_stream[fd]->pFileGrp );
+  free( pMUD_stream[fd] );
+  pMUD_stream[fd] = NULL;
+}
 
 /*
  *  Run Description
@@ -487,8 +1274,10 @@ int name( int fd, UINT32 var) \
   _sea_desc( fd ); \
   switch( MUD_instanceID( pMUD_fileGrp[fd] ) ) \
   { \
-    case MUD_FMT_TRI_TI_ID: pMUD_idesc->var = var; break; \
-    case MUD_FMT_TRI_TD_ID: default: pMUD_desc->var = var; break; \
+    case MUD_FMT_TRI_TI_ID: pMUD_idesc->var = var; \
+      MUD_markDirty( fd, pMUD_idesc ); break; \
+    case MUD_FMT_TRI_TD_ID: default: pMUD_desc->var = var; \
+      MUD_markDirty( fd, pMUD_desc ); break; \
   } \
   return( 1 ); \
 }
@@ -520,9 +1309,11 @@ int name( int fd, char* var ) \
   switch( MUD_instanceID( pMUD_fileGrp[fd] ) ) \
   { \
     case MUD_FMT_TRI_TI_ID: \
-      _free( pMUD_idesc->var ); pMUD_idesc->var = strdup( var ); break; \
+      _free_str( pMUD_idesc->var ); pMUD_idesc->var = strdup( var ); \
+      MUD_markDirty( fd, pMUD_idesc ); break; \
     case MUD_FMT_TRI_TD_ID: default: \
-      _free( pMUD_desc->var ); pMUD_desc->var = strdup( var ); break; \
+      _free_str( pMUD_desc->var ); pMUD_desc->var = strdup( var ); \
+      MUD_markDirty( fd, pMUD_desc ); break; \
   } \
   return( 1 ); \
 }
@@ -545,8 +1336,9 @@ int name( int fd, char* var ) \
   MUD_SEC_GEN_RUN_DESC* pMUD_desc=0; \
   _check_fd( fd ); \
   _sea_gdesc( fd ); \
-  _free( pMUD_desc->var ); \
+  _free_str( pMUD_desc->var ); \
   pMUD_desc->var = strdup( var ); \
+  MUD_markDirty( fd, pMUD_desc ); \
   return( 1 ); \
 }
 
@@ -568,8 +1360,9 @@ int name( int fd, char* var ) \
   MUD_SEC_TRI_TI_RUN_DESC* pMUD_idesc=0; \
   _check_fd( fd ); \
   _sea_idesc( fd ); \
-  _free( pMUD_idesc->var ); \
+  _free_str( pMUD_idesc->var ); \
   pMUD_idesc->var = strdup( var ); \
+  MUD_markDirty( fd, pMUD_idesc ); \
   return( 1 ); \
 }
 
@@ -611,6 +1404,8 @@ MUD_setRunDesc( int fd, UINT32 type )
   MUD_SEC_TRI_TI_RUN_DESC* pMUD_idesc=0;
 
   _check_fd( fd );
+  _check_stream( fd );
+  _mark_rewrite( fd );
 
   switch( MUD_instanceID( pMUD_fileGrp[fd] ) )
   {
@@ -720,6 +1515,7 @@ name( int fd, int num, UINT32 var ) \
   _sea_cmtgrp( fd ); \
   _sea_cmt( fd, num ); \
   pMUD_cmt->var = var; \
+  MUD_markDirty( fd, pMUD_cmt ); \
   return( 1 ); \
 }
 
@@ -746,8 +1542,9 @@ name( int fd, int num, char* var ) \
   _check_fd( fd ); \
   _sea_cmtgrp( fd ); \
   _sea_cmt( fd, num ); \
-  _free( pMUD_cmt->var ); \
+  _free_str( pMUD_cmt->var ); \
   pMUD_cmt->var = strdup( var ); \
+  MUD_markDirty( fd, pMUD_cmt ); \
   return( 1 ); \
 }
 
@@ -772,6 +1569,8 @@ MUD_setComments( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _check_stream( fd );
+  _mark_rewrite( fd );
 
   pMUD_cmtGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_cmtGrp == NULL ) return( 0 );
@@ -865,6 +1664,27 @@ name( int fd, int num, UINT32 var ) \
   _sea_histgrp( fd ); \
   _sea_histhdr( fd, num ); \
   pMUD_histHdr->var = var; \
+  MUD_markDirty( fd, pMUD_histHdr ); \
+  return( 1 ); \
+}
+
+/*
+ *  Fields which say how the data are packed: pack any data left for
+ *  MUD_setPackThreads as they were set first
+ */
+#define _hist_uint_packproc( name, var ) \
+int \
+name( int fd, int num, UINT32 var ) \
+{ \
+  MUD_SEC_GRP* pMUD_histGrp=0; \
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0; \
+  _check_fd( fd ); \
+  _sea_histgrp( fd ); \
+  _sea_histhdr( fd, num ); \
+  if( ( pMUD_histHdr->var != var ) && \
+      !MUD_packUnpackedHdr( fd, pMUD_histHdr ) ) return( 0 ); \
+  pMUD_histHdr->var = var; \
+  MUD_markDirty( fd, pMUD_histHdr ); \
   return( 1 ); \
 }
 
@@ -890,8 +1710,9 @@ name( int fd, int num, char* var ) \
   _check_fd( fd ); \
   _sea_histgrp( fd ); \
   _sea_histhdr( fd, num ); \
-  _free( pMUD_histHdr->var ); \
+  _free_str( pMUD_histHdr->var ); \
   pMUD_histHdr->var = strdup( var ); \
+  MUD_markDirty( fd, pMUD_histHdr ); \
   return( 1 ); \
 }
 
@@ -925,6 +1746,8 @@ MUD_setHists( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _check_stream( fd );
+  _mark_rewrite( fd );
 
   pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_grp == NULL ) return( 0 );
@@ -949,6 +1772,12 @@ MUD_setHists( int fd, UINT32 type, UINT32 num )
 
   MUD_addToGroup( pMUD_fileGrp[fd], pMUD_grp );
 
+  /*
+   *  Start writing a streamed file
+   */
+  if( ( pMUD_stream[fd] != NULL ) && !MUD_startStream( fd, pMUD_grp ) ) 
+    return( 0 );
+
   return( 1 );
 }
 
@@ -968,8 +1797,8 @@ _hist_char_getproc( MUD_getHistTitle, title )
 
 _hist_uint_setproc( MUD_setHistType, histType )
 _hist_uint_setproc( MUD_setHistNumBytes, nBytes )
-_hist_uint_setproc( MUD_setHistNumBins, nBins )
-_hist_uint_setproc( MUD_setHistBytesPerBin, bytesPerBin )
+_hist_uint_packproc( MUD_setHistNumBins, nBins )
+_hist_uint_packproc( MUD_setHistBytesPerBin, bytesPerBin )
 _hist_uint_setproc( MUD_setHistFsPerBin, fsPerBin )
 _hist_uint_setproc( MUD_setHistT0_Ps, t0_ps )
 _hist_uint_setproc( MUD_setHistT0_Bin, t0_bin )
@@ -992,6 +1821,7 @@ MUD_getHistpData( int fd, int num, void** ppData )
                              MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
                              (UINT32)0 );
   if( pMUD_histDat == NULL ) return( 0 );
+  if( !MUD_loadHistDat( fd, pMUD_histGrp, pMUD_histDat ) ) return( 0 );
 
   *ppData = pMUD_histDat->pData;
   return( 1 );
@@ -1009,40 +1839,351 @@ MUD_setHistpData( int fd, int num, void* pData )
                              MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
                              (UINT32)0 );
   if( pMUD_histDat == NULL ) return( 0 );
+  if( !MUD_streamInOrder( fd, pMUD_histGrp, pMUD_histDat ) ) return( 0 );
 
+  MUD_freeUnpacked( fd, pMUD_histDat );
   pMUD_histDat->pData = (caddr_t)pData;
+  MUD_markDirty( fd, pMUD_histDat );
+  return( MUD_streamHistDat( fd, pMUD_histGrp, pMUD_histDat ) );
+}
+
+/*
+ *  Unpack histogram num into pData as bins of outBinSize bytes (0 for
+ *  its own size, unpacked), checking first that its data are its
+ *  nBins bins within the bytes read
+ */
+static int
+MUD_unpackHist( int fd, int num, int outBinSize, void* pData )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  UINT64 t;
+  int n;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+  
+  pMUD_histHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_HDR_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histHdr == NULL ) return( 0 );
+
+  pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histDat == NULL ) return( 0 );
+  if( !MUD_loadHistDat( fd, pMUD_histGrp, pMUD_histDat ) ) return( 0 );
+  if( pMUD_histDat->pData == NULL ) return( 0 );
+
+  if( outBinSize == 0 )
+    outBinSize = _unpacked_bin_size( pMUD_histHdr->bytesPerBin );
+
+  /*
+   *  Do unpacking/byte swapping
+   */
+  _stat_time( t );
+  n = MUD_SEC_GEN_HIST_unpackChecked( pMUD_histHdr->nBins, 
+            pMUD_histHdr->bytesPerBin, pMUD_histDat->pData, 
+            pMUD_histDat->nBytes, outBinSize, pData );
+  _stat_since( nsUnpack, t );
+  if( mud_releaseHists[fd] ) MUD_releaseHistDat( fd, pMUD_histDat );
+
+  return( n >= 0 );
+}
+
+int 
+MUD_getHistData( int fd, int num, void* pData )
+{
+  return( MUD_unpackHist( fd, num, 0, pData ) );
+}
+
+/*
+ *  Histogram data summed over each factor adjacent bins, as UINT64, into
+ *  pData of (nBins+factor-1)/factor elements.  The last element is the
+ *  sum of the bins left over when factor does not divide nBins.
+ */
+int
+MUD_getHistDataRebinned( int fd, int num, int factor, UINT64* pData )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
+  MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  UINT64 t;
+  int n;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+
+  if( factor < 1 ) return( 0 );
+
+  pMUD_histHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_HDR_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histHdr == NULL ) return( 0 );
+
+  pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histDat == NULL ) return( 0 );
+  if( !MUD_loadHistDat( fd, pMUD_histGrp, pMUD_histDat ) ) return( 0 );
+  if( pMUD_histDat->pData == NULL ) return( 0 );
+
+  _stat_time( t );
+  bzero( pData, ( ( pMUD_histHdr->nBins + factor - 1 )/factor )*sizeof( UINT64 ) );
+  n = MUD_SEC_GEN_HIST_unpackRebin( pMUD_histHdr->nBins, 
+                                    pMUD_histHdr->bytesPerBin,
+                                    pMUD_histDat->pData, pMUD_histDat->nBytes,
+                                    factor, pData );
+  _stat_since( nsUnpack, t );
+  if( mud_releaseHists[fd] ) MUD_releaseHistDat( fd, pMUD_histDat );
+
+  return( ( n > 0 ) || ( pMUD_histHdr->nBins == 0 ) );
+}
+
+/*
+ *  Asymmetry of histograms numF and numB, and its error, less the
+ *  backgrounds of their bkgd1 to bkgd2 windows (see mud_asym.c), into
+ *  pAsym and pErr of nBins elements each.
+ */
+int
+MUD_getHistAsym( int fd, int numF, int numB, REAL64* pAsym, REAL64* pErr )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr[2];
+  MUD_SEC_GEN_HIST_DAT* pMUD_histDat[2];
+  int num[2];
+  int i, ok;
+  UINT64 t;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+
+  num[0] = numF;
+  num[1] = numB;
+  for( i = 0; i < 2; i++ )
+  {
+    pMUD_histHdr[i] = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_HDR_ID, (UINT32)num[i],
+                             (UINT32)0 );
+    if( pMUD_histHdr[i] == NULL ) return( 0 );
+
+    pMUD_histDat[i] = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num[i],
+                             (UINT32)0 );
+    if( pMUD_histDat[i] == NULL ) return( 0 );
+    if( !MUD_loadHistDat( fd, pMUD_histGrp, pMUD_histDat[i] ) ) return( 0 );
+  }
+
+  _stat_time( t );
+  ok = MUD_asymHists( pMUD_histHdr[0], pMUD_histDat[0], 
+                      pMUD_histHdr[1], pMUD_histDat[1], pAsym, pErr );
+  _stat_since( nsUnpack, t );
+  if( mud_releaseHists[fd] )
+  {
+    MUD_releaseHistDat( fd, pMUD_histDat[0] );
+    MUD_releaseHistDat( fd, pMUD_histDat[1] );
+  }
+
+  return( ok ? 1 : 0 );
+}
+
+/*
+ *  Free the stored data of histogram num until it is next needed
+ */
+int
+MUD_releaseHist( int fd, int num )
+{
+  MUD_SEC_GRP* pMUD_histGrp=0;
+  MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  _check_fd( fd );
+  _sea_histgrp( fd );
+
+  pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
+                             MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
+                             (UINT32)0 );
+  if( pMUD_histDat == NULL ) return( 0 );
+
+  return( MUD_releaseHistDat( fd, pMUD_histDat ) );
+}
+
+int
+MUD_setReleaseHists( int fd, int release )
+{
+  _check_fd( fd );
+  mud_releaseHists[fd] = release ? TRUE : FALSE;
   return( 1 );
 }
 
-int 
-MUD_getHistData( int fd, int num, void* pData )
+/*
+ *  Free the data of section pMUD_histDat, if it can be read again from
+ *  the unchanged file: through the index if there is one, otherwise at
+ *  the offset noted here
+ */
+static int
+MUD_releaseHistDat( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_RELEASED* pReleased;
+  UINT32 offset;
+
+  if( pMUD_histDat->pData == NULL ) return( 1 );
+  if( mud_changed[fd] || ( mud_patch[fd] != MUD_PATCH_NONE ) ) return( 0 );
+
+  if( pMUD_idx[fd] == NULL )
+  {
+    for( pReleased = pMUD_released[fd]; pReleased != NULL; 
+         pReleased = pReleased->pNext )
+    {
+      if( pReleased->pDat == pMUD_histDat ) break;
+    }
+    if( pReleased == NULL )
+    {
+      if( !MUD_findOffset( pMUD_fileGrp[fd], 0, (MUD_SEC*)pMUD_histDat, 
+                           &offset ) ) return( 0 );
+      pReleased = (MUD_RELEASED*)malloc( sizeof( MUD_RELEASED ) );
+      if( pReleased == NULL ) return( 0 );
+
+      /*
+       *  Skip the section core and nBytes
+       */
+      pReleased->pDat = pMUD_histDat;
+      pReleased->offset = offset + MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL ) + 
+                          sizeof( UINT32 );
+      pReleased->pNext = pMUD_released[fd];
+      pMUD_released[fd] = pReleased;
+    }
+  }
+
+  _free( pMUD_histDat->pData );
+  return( 1 );
+}
+
+/*
+ *  Read the data of section pMUD_histDat, released from a file with no
+ *  index, again
+ */
+static int
+MUD_rereadHistDat( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_RELEASED* pReleased;
+  caddr_t pData;
+
+  for( pReleased = pMUD_released[fd]; pReleased != NULL; 
+       pReleased = pReleased->pNext )
+  {
+    if( pReleased->pDat == pMUD_histDat ) break;
+  }
+  if( pReleased == NULL ) return( 0 );
+
+  pData = (caddr_t)zalloc( pMUD_histDat->nBytes );
+  if( pData == NULL ) return( 0 );
+  if( MUD_pread( mud_f[fd], pData, pMUD_histDat->nBytes, pReleased->offset ) != 
+      pMUD_histDat->nBytes )
+  {
+    free( pData );
+    return( 0 );
+  }
+
+  pMUD_histDat->pData = pData;
+  return( 1 );
+}
+
+static void
+MUD_freeReleased( int fd )
+{
+  MUD_RELEASED* pReleased;
+
+  while( pMUD_released[fd] != NULL )
+  {
+    pReleased = pMUD_released[fd];
+    pMUD_released[fd] = pReleased->pNext;
+    free( pReleased );
+  }
+}
+
+/*
+ *  Offset in the file of the data (packed or not) of histogram num, and
+ *  its size in bytes, for a file opened with MUD_openRead and unchanged.
+ *  The data can then be read or mapped separately.
+ */
+int
+MUD_getHistDataLocation( int fd, int num, UINT32* pOffset, UINT32* pNumBytes )
 {
   MUD_SEC_GRP* pMUD_histGrp=0;
-  MUD_SEC_GEN_HIST_HDR* pMUD_histHdr=0;
   MUD_SEC_GEN_HIST_DAT* pMUD_histDat=0;
+  UINT32 offset;
+  int grp, dat;
   _check_fd( fd );
   _sea_histgrp( fd );
-  
-  pMUD_histHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pMUD_histGrp->pMem,
-                             MUD_SEC_GEN_HIST_HDR_ID, (UINT32)num,
-                             (UINT32)0 );
-  if( pMUD_histHdr == NULL ) return( 0 );
+
+  if( mud_changed[fd] || ( mud_patch[fd] != MUD_PATCH_NONE ) ) return( 0 );
 
   pMUD_histDat = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pMUD_histGrp->pMem,
                              MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
                              (UINT32)0 );
   if( pMUD_histDat == NULL ) return( 0 );
 
+  if( pMUD_idx[fd] != NULL )
+  {
+    grp = MUD_findIndex( pMUD_idx[fd], 0, MUD_SEC_GRP_ID, 
+                         MUD_instanceID( pMUD_histGrp ) );
+    if( grp < 0 ) return( 0 );
+    dat = MUD_findIndex( pMUD_idx[fd], grp, MUD_SEC_GEN_HIST_DAT_ID,
+                         MUD_instanceID( pMUD_histDat ) );
+    if( dat < 0 ) return( 0 );
+    offset = pMUD_idx[fd]->pEntry[dat].offset;
+  }
+  else if( !MUD_findOffset( pMUD_fileGrp[fd], 0, (MUD_SEC*)pMUD_histDat, 
+                            &offset ) ) 
+  {
+    return( 0 );
+  }
+
   /*
-   *  Do unpacking/byte swapping
+   *  Skip the section core and nBytes
    */
-  MUD_unpack( pMUD_histHdr->nBins, 
-            pMUD_histHdr->bytesPerBin, pMUD_histDat->pData, 
-    ( pMUD_histHdr->bytesPerBin == 0 ) ? 4 : pMUD_histHdr->bytesPerBin, pData );
+  *pOffset = offset + MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL ) + sizeof( UINT32 );
+  *pNumBytes = pMUD_histDat->nBytes;
 
   return( 1 );
 }
 
+/*
+ *  Offset in the file of the bins of histogram num, if they are stored
+ *  just as MUD_getHistData would return them (4 bytes per bin, on a
+ *  little-endian host), as for MUD_getHistDataLocation.  The bins can
+ *  then be mapped rather than read.
+ */
+int
+MUD_getHistDataOffset( int fd, int num, UINT32* pOffset )
+{
+#ifdef MUD_BIG_ENDIAN
+  return( 0 );
+#else
+  UINT32 bytesPerBin, nBins, nBytes;
+
+  if( !MUD_getHistBytesPerBin( fd, num, &bytesPerBin ) ||
+      !MUD_getHistNumBins( fd, num, &nBins ) ||
+      !MUD_getHistDataLocation( fd, num, pOffset, &nBytes ) ) return( 0 );
+
+  return( ( bytesPerBin == 4 ) && ( nBytes == 4*nBins ) );
+#endif /* MUD_BIG_ENDIAN */
+}
+
+/*
+ *  Descriptor of the file open on fd (-1 if none), so that offsets from
+ *  MUD_getHistDataLocation can be applied to the file that was read,
+ *  even if another has since been put in its place.
+ */
+int
+MUD_getFileNo( int fd )
+{
+  if( ( fd < 0 ) || ( fd >= MUD_MAX_FILES ) || ( mud_f[fd] == NULL ) ) 
+    return( -1 );
+#ifdef _WIN32
+  return( _fileno( mud_f[fd] ) );
+#else
+  return( fileno( mud_f[fd] ) );
+#endif /* _WIN32 */
+}
+
 int 
 MUD_setHistData( int fd, int num, void* pData )
 {
@@ -1061,14 +2202,23 @@ MUD_setHistData( int fd, int num, void* pData )
                              MUD_SEC_GEN_HIST_DAT_ID, (UINT32)num,
                              (UINT32)0 );
   if( pMUD_histDat == NULL ) return( 0 );
+  if( !MUD_streamInOrder( fd, pMUD_histGrp, pMUD_histDat ) ) return( 0 );
 
   _free( pMUD_histDat->pData );
 
+  if( ( mud_packThreads[fd] != 0 ) && ( pMUD_histHdr->bytesPerBin == 0 ) )
+    return( MUD_deferPack( fd, pMUD_histHdr, pMUD_histDat, pData ) );
+  MUD_freeUnpacked( fd, pMUD_histDat );
+
   switch( pMUD_histHdr->bytesPerBin )
   {
     case 0:
       pMUD_histDat->pData = (caddr_t)zalloc( 4*pMUD_histHdr->nBins + 32 );
       break;
+    case MUD_BIN_SIZE_DELTA:
+      pMUD_histDat->pData = (caddr_t)zalloc( 
+                               _delta_max_bytes( pMUD_histHdr->nBins ) );
+      break;
     default:
       pMUD_histDat->pData = (caddr_t)zalloc( 
                                pMUD_histHdr->nBins*pMUD_histHdr->bytesPerBin );
@@ -1080,12 +2230,215 @@ MUD_setHistData( int fd, int num, void* pData )
    */
   pMUD_histDat->nBytes = pMUD_histHdr->nBytes = 
     MUD_pack( pMUD_histHdr->nBins, 
-              ( pMUD_histHdr->bytesPerBin == 0 ) ? 4 : pMUD_histHdr->bytesPerBin, pData,
+              _unpacked_bin_size( pMUD_histHdr->bytesPerBin ), pData,
               pMUD_histHdr->bytesPerBin, pMUD_histDat->pData );
+  MUD_markDirty( fd, pMUD_histHdr );
+  MUD_markDirty( fd, pMUD_histDat );
+
+  /*
+   *  When streaming, write the packed data now and let it go
+   */
+  if( ( pMUD_stream[fd] != NULL ) && ( pMUD_stream[fd]->pHists == pMUD_histGrp ) )
+  {
+    if( !MUD_streamHistDat( fd, pMUD_histGrp, pMUD_histDat ) ) return( 0 );
+    _free( pMUD_histDat->pData );
+  }
+
+  return( 1 );
+}
+
+/*
+ *  Deferred packing (MUD_setPackThreads)
+ */
+int 
+MUD_setPackThreads( int fd, int nThreads )
+{
+  _check_fd( fd );
+  if( pMUD_stream[fd] != NULL ) return( 0 );
+
+  /*
+   *  Pack what was left for later, with the old setting
+   */
+  if( ( nThreads == 0 ) && !MUD_packUnpacked( fd, NULL ) ) return( 0 );
+
+  mud_packThreads[fd] = nThreads;
+  return( 1 );
+}
+
+/*
+ *  Keep a copy of the data of a packed histogram, to be packed later
+ */
+static int
+MUD_deferPack( int fd, MUD_SEC_GEN_HIST_HDR* pMUD_histHdr, 
+               MUD_SEC_GEN_HIST_DAT* pMUD_histDat, void* pData )
+{
+  MUD_UNPACKED* pUnpacked;
+  UINT32* pCopy;
 
+  pCopy = (UINT32*)malloc( 4*(size_t)pMUD_histHdr->nBins + 4 );
+  if( pCopy == NULL ) return( 0 );
+  bcopy( pData, pCopy, 4*(size_t)pMUD_histHdr->nBins );
+
+  for( pUnpacked = pMUD_unpacked[fd]; pUnpacked != NULL; 
+       pUnpacked = pUnpacked->pNext )
+  {
+    if( pUnpacked->pDat == pMUD_histDat ) break;
+  }
+  if( pUnpacked == NULL )
+  {
+    pUnpacked = (MUD_UNPACKED*)zalloc( sizeof( MUD_UNPACKED ) );
+    if( pUnpacked == NULL )
+    {
+      free( pCopy );
+      return( 0 );
+    }
+    pUnpacked->pNext = pMUD_unpacked[fd];
+    pMUD_unpacked[fd] = pUnpacked;
+  }
+  _free( pUnpacked->pData );
+
+  pUnpacked->pHdr = pMUD_histHdr;
+  pUnpacked->pDat = pMUD_histDat;
+  pUnpacked->nBins = pMUD_histHdr->nBins;
+  pUnpacked->pData = pCopy;
+
+  pMUD_histDat->pData = NULL;
+  pMUD_histDat->nBytes = 0;
+  MUD_markDirty( fd, pMUD_histHdr );
+  MUD_markDirty( fd, pMUD_histDat );
+
+  return( 1 );
+}
+
+/*
+ *  Pack the data left by MUD_deferPack for section pMUD_histDat, or for
+ *  all sections (on mud_packThreads[fd] threads) when it is NULL
+ */
+static int
+MUD_packUnpacked( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_UNPACKED* pUnpacked;
+  MUD_UNPACKED** ppUnpacked;
+  UINT32* nBins;
+  UINT32** ppIn;
+  caddr_t* ppOut;
+  UINT32* pNBytes;
+  int i, num = 0;
+  int ok = 1;
+
+  for( pUnpacked = pMUD_unpacked[fd]; pUnpacked != NULL; 
+       pUnpacked = pUnpacked->pNext )
+  {
+    if( ( pMUD_histDat == NULL ) || ( pUnpacked->pDat == pMUD_histDat ) ) num++;
+  }
+  if( num == 0 ) return( 1 );
+
+  nBins = (UINT32*)zalloc( num*sizeof( UINT32 ) );
+  ppIn = (UINT32**)zalloc( num*sizeof( UINT32* ) );
+  ppOut = (caddr_t*)zalloc( num*sizeof( caddr_t ) );
+  pNBytes = (UINT32*)zalloc( num*sizeof( UINT32 ) );
+  if( ( nBins == NULL ) || ( ppIn == NULL ) || ( ppOut == NULL ) || 
+      ( pNBytes == NULL ) ) 
+  {
+    ok = 0;
+  }
+
+  if( ok )
+  {
+    i = 0;
+    for( pUnpacked = pMUD_unpacked[fd]; pUnpacked != NULL; 
+         pUnpacked = pUnpacked->pNext )
+    {
+      if( ( pMUD_histDat != NULL ) && ( pUnpacked->pDat != pMUD_histDat ) ) 
+        continue;
+      nBins[i] = pUnpacked->nBins;
+      ppIn[i++] = pUnpacked->pData;
+    }
+
+    MUD_packHists( num, nBins, ppIn, ppOut, pNBytes, 
+                   ( pMUD_histDat != NULL ) ? 1 : mud_packThreads[fd] );
+
+    /*
+     *  Hand the packed data to the sections, in the same order
+     */
+    i = 0;
+    ppUnpacked = &pMUD_unpacked[fd];
+    while( *ppUnpacked != NULL )
+    {
+      pUnpacked = *ppUnpacked;
+      if( ( pMUD_histDat != NULL ) && ( pUnpacked->pDat != pMUD_histDat ) ) 
+      {
+        ppUnpacked = &pUnpacked->pNext;
+        continue;
+      }
+      if( ppOut[i] == NULL )
+      {
+        ok = 0;
+        ppUnpacked = &pUnpacked->pNext;
+        i++;
+        continue;
+      }
+      pUnpacked->pDat->pData = ppOut[i];
+      pUnpacked->pDat->nBytes = pUnpacked->pHdr->nBytes = pNBytes[i];
+      i++;
+
+      *ppUnpacked = pUnpacked->pNext;
+      _free( pUnpacked->pData );
+      free( pUnpacked );
+    }
+  }
+
+  _free( nBins );
+  _free( ppIn );
+  _free( ppOut );
+  _free( pNBytes );
+
+  return( ok );
+}
+
+/*
+ *  Pack the data left by MUD_deferPack for the histogram of header
+ *  pMUD_histHdr, if any
+ */
+static int
+MUD_packUnpackedHdr( int fd, MUD_SEC_GEN_HIST_HDR* pMUD_histHdr )
+{
+  MUD_UNPACKED* pUnpacked;
+
+  for( pUnpacked = pMUD_unpacked[fd]; pUnpacked != NULL; 
+       pUnpacked = pUnpacked->pNext )
+  {
+    if( pUnpacked->pHdr == pMUD_histHdr ) 
+      return( MUD_packUnpacked( fd, pUnpacked->pDat ) );
+  }
   return( 1 );
 }
 
+/*
+ *  Drop the data left by MUD_deferPack for section pMUD_histDat, or for
+ *  all sections when it is NULL
+ */
+static void
+MUD_freeUnpacked( int fd, MUD_SEC_GEN_HIST_DAT* pMUD_histDat )
+{
+  MUD_UNPACKED* pUnpacked;
+  MUD_UNPACKED** ppUnpacked;
+
+  ppUnpacked = &pMUD_unpacked[fd];
+  while( *ppUnpacked != NULL )
+  {
+    pUnpacked = *ppUnpacked;
+    if( ( pMUD_histDat != NULL ) && ( pUnpacked->pDat != pMUD_histDat ) ) 
+    {
+      ppUnpacked = &pUnpacked->pNext;
+      continue;
+    }
+    *ppUnpacked = pUnpacked->pNext;
+    _free( pUnpacked->pData );
+    free( pUnpacked );
+  }
+}
+
 int 
 MUD_getHistpTimeData( int fd, int num, UINT32** ppTimeData )
 {
@@ -1133,8 +2486,15 @@ MUD_pack( int num, int inBinSize, void*inArray, int outBinSize, void* outArray )
 int 
 MUD_unpack( int num, int inBinSize, void* inArray, int outBinSize, void* outArray )
 {
-  return( MUD_SEC_GEN_HIST_unpack( num, inBinSize, inArray,
-                                   outBinSize, outArray ) );
+  int n;
+  UINT64 t;
+
+  _stat_time( t );
+  n = MUD_SEC_GEN_HIST_unpack( num, inBinSize, inArray,
+                               outBinSize, outArray );
+  _stat_since( nsUnpack, t );
+
+  return( n );
 }
 
 
@@ -1188,6 +2548,8 @@ MUD_setScalers( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _check_stream( fd );
+  _mark_rewrite( fd );
 
   pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_grp == NULL ) return( 0 );
@@ -1231,8 +2593,9 @@ MUD_setScalerLabel( int fd, int num, char* label )
   _check_fd( fd );
   _sea_scalgrp( fd );
   _sea_scal( fd, num );
-  _free( pMUD_scal->label );
+  _free_str( pMUD_scal->label );
   pMUD_scal->label = strdup( label );
+  MUD_markDirty( fd, pMUD_scal );
 
   return( 1 );
 }
@@ -1265,6 +2628,7 @@ MUD_setScalerCounts( int fd, int num, UINT32* pCounts )
 
   pMUD_scal->counts[0] = pCounts[0];
   pMUD_scal->counts[1] = pCounts[1];
+  MUD_markDirty( fd, pMUD_scal );
 
   return( 1 );
 }
@@ -1341,6 +2705,7 @@ name( int fd, int num, double var ) \
   _sea_indvargrp( fd ); \
   _sea_indvar( fd, num ); \
   pMUD_indVar->var = var; \
+  MUD_markDirty( fd, pMUD_indVar ); \
   return( 1 ); \
 }
 
@@ -1367,8 +2732,9 @@ name( int fd, int num, char* var ) \
   _check_fd( fd ); \
   _sea_indvargrp( fd ); \
   _sea_indvar( fd, num ); \
-  _free( pMUD_indVar->var ); \
+  _free_str( pMUD_indVar->var ); \
   pMUD_indVar->var = strdup( var ); \
+  MUD_markDirty( fd, pMUD_indVar ); \
   return( 1 ); \
 }
 
@@ -1396,6 +2762,7 @@ name( int fd, int n, UINT32 var ) \
   _sea_indvargrp( fd ); \
   _sea_indvardat( fd, n ); \
   pMUD_array->var = var; \
+  MUD_markDirty( fd, pMUD_array ); \
   return( 1 ); \
 }
 
@@ -1434,6 +2801,8 @@ MUD_setIndVars( int fd, UINT32 type, UINT32 num )
   int i;
 
   _check_fd( fd );
+  _check_stream( fd );
+  _mark_rewrite( fd );
 
   pMUD_grp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, type );
   if( pMUD_grp == NULL ) return( 0 );
@@ -1513,6 +2882,7 @@ MUD_setIndVarpData( int fd, int num, void* pData )
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   pMUD_array->pData = (caddr_t)pData;
+  MUD_markDirty( fd, pMUD_array );
   return( 1 ); 
 }
 
@@ -1576,6 +2946,7 @@ MUD_setIndVarData( int fd, int num, void* pData )
       bcopy( pData, pMUD_array->pData, pMUD_array->num*pMUD_array->elemSize );
       break;
   }
+  MUD_markDirty( fd, pMUD_array );
 
   return( 1 ); 
 }
@@ -1601,6 +2972,7 @@ MUD_setIndVarpTimeData( int fd, int num, UINT32* pData )
   _sea_indvargrp( fd ); 
   _sea_indvardat( fd, num ); 
   pMUD_array->pTime = (TIME*)pData;
+  MUD_markDirty( fd, pMUD_array );
   return( 1 ); 
 }
 
@@ -1638,6 +3010,7 @@ MUD_setIndVarTimeData( int fd, int num, UINT32* pData )
    */
   bcopy( pData, pMUD_array->pTime, 4*pMUD_array->num );
   pMUD_array->hasTime = 1;
+  MUD_markDirty( fd, pMUD_array );
 
   return( 1 ); 
 }
@@ -1673,3 +3046,439 @@ MUD_setHistSecondsPerBin( int fd, int num, REAL64 secondsPerBin )
     return( 0 );
   return( MUD_setHistFsPerBin( fd, num, (UINT32)(1.0e15 * secondsPerBin ) ) );
 }
+
+
+/*
+ *  Columnar export
+ *
+ *  MUD_exportColumnar() writes the run open on fd to outfile in a
+ *  self-describing binary form which can be used without decoding
+ *  (e.g. with numpy.memmap):
+ *
+ *    bytes 0-15:   "MUDC", version, header length, data offset
+ *                  (UINT32, little-endian)
+ *    bytes 16-:    header, a JSON object giving the run description,
+ *                  histogram headers, scalers, independent variables
+ *                  and comments, keyed by mudpy attribute names
+ *    data offset:  columns, each starting on a 64-byte boundary:
+ *                  histogram data as little-endian UINT32 ("<u4"), and
+ *                  independent variable low, high, mean, stddev and
+ *                  skewness as little-endian REAL64 ("<f8")
+ *
+ *  Column offsets in the header are relative to the data offset.
+ */
+#define MUD_COL_MAGIC    0x4344554D  /* "MUDC" */
+#define MUD_COL_VERSION  1
+#define MUD_COL_ALIGN    64
+#define MUD_COL_STRDIM   256
+
+typedef struct {
+  char* key;
+  int (*proc)( int fd, UINT32* pVal );
+} MUD_COL_UINT_DESC;
+
+typedef struct {
+  char* key;
+  int (*proc)( int fd, char* str, int strdim );
+} MUD_COL_CHAR_DESC;
+
+typedef struct {
+  char* key;
+  int (*proc)( int fd, int num, UINT32* pVal );
+} MUD_COL_UINT_ITEM;
+
+static MUD_COL_UINT_DESC col_desc_uint[] = {
+  { "description", MUD_getRunDesc },
+  { "exp", MUD_getExptNumber },
+  { "run", MUD_getRunNumber },
+  { "duration", MUD_getElapsedSec },
+  { "start_time", MUD_getTimeBegin },
+  { "end_time", MUD_getTimeEnd },
+};
+
+static MUD_COL_CHAR_DESC col_desc_char[] = {
+  { "title", MUD_getTitle },
+  { "lab", MUD_getLab },
+  { "area", MUD_getArea },
+  { "method", MUD_getMethod },
+  { "apparatus", MUD_getApparatus },
+  { "mode", MUD_getInsert },
+  { "sample", MUD_getSample },
+  { "orientation", MUD_getOrient },
+  { "das", MUD_getDas },
+  { "experimenter", MUD_getExperimenter },
+  { "temperature", MUD_getTemperature },
+  { "field", MUD_getField },
+};
+
+static MUD_COL_UINT_ITEM col_hist_uint[] = {
+  { "htype", MUD_getHistType },
+  { "n_bytes", MUD_getHistNumBytes },
+  { "n_bins", MUD_getHistNumBins },
+  { "n_events", MUD_getHistNumEvents },
+  { "fs_per_bin", MUD_getHistFsPerBin },
+  { "t0_ps", MUD_getHistT0_Ps },
+  { "t0_bin", MUD_getHistT0_Bin },
+  { "good_bin1", MUD_getHistGoodBin1 },
+  { "good_bin2", MUD_getHistGoodBin2 },
+  { "background1", MUD_getHistBkgd1 },
+  { "background2", MUD_getHistBkgd2 },
+};
+
+static char* col_ivar_name[] = { "low", "high", "mean", "std", "skew" };
+static int (*col_ivar_proc[])( int fd, int num, double* pVal ) = {
+  MUD_getIndVarLow, MUD_getIndVarHigh, MUD_getIndVarMean,
+  MUD_getIndVarStddev, MUD_getIndVarSkewness,
+};
+
+#define _col_num( a )  ( sizeof( a )/sizeof( a[0] ) )
+
+
+static int
+MUD_colPuts( BUF* pB, char* s )
+{
+  int n = strlen( s );
+  char* p;
+
+  if( pB->pos + n + 1 > pB->size )
+  {
+    p = (char*)realloc( pB->buf, 2*( pB->pos + n + 1 ) );
+    if( p == NULL ) return( 0 );
+    pB->buf = p;
+    pB->size = 2*( pB->pos + n + 1 );
+  }
+  strcpy( &pB->buf[pB->pos], s );
+  pB->pos += n;
+
+  return( 1 );
+}
+
+/*
+ *  JSON string; MUD strings are Latin-1
+ */
+static int
+MUD_colPutStr( BUF* pB, char* s )
+{
+  char tmp[8];
+  unsigned char* p;
+  int ok;
+
+  ok = MUD_colPuts( pB, "\"" );
+  for( p = (unsigned char*)s; ok && *p; p++ )
+  {
+    if( *p == '"' || *p == '\\' )
+      sprintf( tmp, "\\%c", *p );
+    else if( *p < 0x20 || *p >= 0x7f )
+      sprintf( tmp, "\\u%04x", *p );
+    else
+      sprintf( tmp, "%c", *p );
+    ok = MUD_colPuts( pB, tmp );
+  }
+  return( ok && MUD_colPuts( pB, "\"" ) );
+}
+
+static int
+MUD_colPutKey( BUF* pB, char* key, int first )
+{
+  return( ( first || MUD_colPuts( pB, ", " ) ) && 
+          MUD_colPutStr( pB, key ) && MUD_colPuts( pB, ": " ) );
+}
+
+static int
+MUD_colPutUint( BUF* pB, char* key, UINT32 val, int first )
+{
+  char tmp[16];
+
+  sprintf( tmp, "%lu", (unsigned long)val );
+  return( MUD_colPutKey( pB, key, first ) && MUD_colPuts( pB, tmp ) );
+}
+
+static int
+MUD_colPutDouble( BUF* pB, char* key, double val, int first )
+{
+  char tmp[32];
+
+  if( val != val || val - val != 0.0 ) /* NaN or Inf */
+    strcpy( tmp, "null" );
+  else
+    sprintf( tmp, "%.17g", val );
+  return( MUD_colPutKey( pB, key, first ) && MUD_colPuts( pB, tmp ) );
+}
+
+static int
+MUD_colPutColumn( BUF* pB, char* key, char* dtype, UINT32 offset, UINT32 length,
+                  int first )
+{
+  return( MUD_colPutKey( pB, key, first ) &&
+          MUD_colPuts( pB, "{\"dtype\": " ) && MUD_colPutStr( pB, dtype ) &&
+          MUD_colPutUint( pB, "offset", offset, 0 ) &&
+          MUD_colPutUint( pB, "length", length, 0 ) &&
+          MUD_colPuts( pB, "}" ) );
+}
+
+static int
+MUD_colWrite( FILE* fout, void* data, UINT32 size, UINT32* pPos, UINT32 offset )
+{
+  char zero[MUD_COL_ALIGN];
+
+  bzero( zero, MUD_COL_ALIGN );
+  if( ( offset > *pPos ) && 
+      ( fwrite( zero, offset - *pPos, 1, fout ) != 1 ) ) return( 0 );
+  if( ( size > 0 ) && ( fwrite( data, size, 1, fout ) != 1 ) ) return( 0 );
+  *pPos = offset + size;
+
+  return( 1 );
+}
+
+/*
+ *  Comment body, whole (MUD_getCommentBody needs a buffer of a given size)
+ */
+static char*
+MUD_colCommentBody( int fd, int num )
+{
+  MUD_SEC_GRP* pMUD_cmtGrp=0;
+  MUD_SEC_CMT* pMUD_cmt=0;
+  _sea_cmtgrp( fd );
+  _sea_cmt( fd, num );
+  return( pMUD_cmt->comment );
+}
+
+
+int
+MUD_exportColumnar( int fd, char* outfile )
+{
+  BUF hdr;
+  FILE* fout;
+  char str[MUD_COL_STRDIM];
+  char* body;
+  UINT32 type, num, nHists, nIvars, val;
+  UINT32 counts[2];
+  UINT32 pre[4];
+  UINT32* pHistOff = NULL;
+  UINT32* pHistLen = NULL;
+  UINT32 ivarOff = 0;
+  UINT32 offset, pos;
+  UINT32* pBins = NULL;
+  double* pStat = NULL;
+  double dval;
+  int i, j;
+  int ok = 1;
+
+  _check_fd( fd );
+
+  bzero( &hdr, sizeof( BUF ) );
+  if( !MUD_getHists( fd, &type, &nHists ) ) nHists = 0;
+  if( !MUD_getIndVars( fd, &type, &nIvars ) ) nIvars = 0;
+
+  /*
+   *  Lay out the columns
+   */
+  pHistOff = (UINT32*)zalloc( ( nHists + 1 )*sizeof( UINT32 ) );
+  pHistLen = (UINT32*)zalloc( ( nHists + 1 )*sizeof( UINT32 ) );
+  if( pHistOff == NULL || pHistLen == NULL ) ok = 0;
+
+  offset = 0;
+  for( i = 0; ok && i < nHists; i++ )
+  {
+    if( !MUD_getHistNumBins( fd, i+1, &pHistLen[i] ) ) pHistLen[i] = 0;
+    pHistOff[i] = offset;
+    offset = _roundUp( offset + 4*pHistLen[i], MUD_COL_ALIGN );
+  }
+  ivarOff = offset;
+
+  /*
+   *  Header
+   */
+  ok = ok && MUD_colPuts( &hdr, "{" ) &&
+       MUD_colPutKey( &hdr, "format", 1 ) && MUD_colPutStr( &hdr, "MUDC" ) &&
+       MUD_colPutUint( &hdr, "version", MUD_COL_VERSION, 0 ) &&
+       MUD_colPutUint( &hdr, "type", MUD_instanceID( pMUD_fileGrp[fd] ), 0 );
+
+  for( i = 0; ok && i < _col_num( col_desc_uint ); i++ )
+  {
+    if( col_desc_uint[i].proc( fd, &val ) )
+      ok = MUD_colPutUint( &hdr, col_desc_uint[i].key, val, 0 );
+  }
+  for( i = 0; ok && i < _col_num( col_desc_char ); i++ )
+  {
+    if( col_desc_char[i].proc( fd, str, MUD_COL_STRDIM ) )
+      ok = MUD_colPutKey( &hdr, col_desc_char[i].key, 0 ) && 
+           MUD_colPutStr( &hdr, str );
+  }
+
+  if( ok && MUD_getHists( fd, &type, &num ) )
+  {
+    ok = MUD_colPutKey( &hdr, "hist", 0 ) && MUD_colPuts( &hdr, "[" );
+    for( i = 0; ok && i < nHists; i++ )
+    {
+      ok = MUD_colPuts( &hdr, i ? ", {" : "{" ) &&
+           MUD_colPutUint( &hdr, "id_number", i+1, 1 );
+      if( ok && MUD_getHistTitle( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "title", 0 ) && MUD_colPutStr( &hdr, str );
+      for( j = 0; ok && j < _col_num( col_hist_uint ); j++ )
+      {
+        if( col_hist_uint[j].proc( fd, i+1, &val ) )
+          ok = MUD_colPutUint( &hdr, col_hist_uint[j].key, val, 0 );
+      }
+      if( ok && MUD_getHistSecondsPerBin( fd, i+1, &dval ) )
+        ok = MUD_colPutDouble( &hdr, "s_per_bin", dval, 0 );
+      ok = ok && MUD_colPutColumn( &hdr, "data", "<u4", pHistOff[i], 
+                                   pHistLen[i], 0 ) &&
+           MUD_colPuts( &hdr, "}" );
+    }
+    ok = ok && MUD_colPuts( &hdr, "]" );
+  }
+
+  if( ok && MUD_getScalers( fd, &type, &num ) )
+  {
+    ok = MUD_colPutKey( &hdr, "sclr", 0 ) && MUD_colPuts( &hdr, "[" );
+    for( i = 0; ok && i < num; i++ )
+    {
+      ok = MUD_colPuts( &hdr, i ? ", {" : "{" ) &&
+           MUD_colPutUint( &hdr, "id_number", i+1, 1 );
+      if( ok && MUD_getScalerLabel( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "title", 0 ) && MUD_colPutStr( &hdr, str );
+      if( ok && MUD_getScalerCounts( fd, i+1, counts ) )
+      {
+        sprintf( str, "[%lu, %lu]", (unsigned long)counts[0], 
+                 (unsigned long)counts[1] );
+        ok = MUD_colPutKey( &hdr, "counts_total_recent", 0 ) && 
+             MUD_colPuts( &hdr, str );
+      }
+      ok = ok && MUD_colPuts( &hdr, "}" );
+    }
+    ok = ok && MUD_colPuts( &hdr, "]" );
+  }
+
+  if( ok && MUD_getIndVars( fd, &type, &num ) )
+  {
+    ok = MUD_colPutKey( &hdr, "ivar", 0 ) && MUD_colPuts( &hdr, "[" );
+    for( i = 0; ok && i < nIvars; i++ )
+    {
+      ok = MUD_colPuts( &hdr, i ? ", {" : "{" ) &&
+           MUD_colPutUint( &hdr, "id_number", i+1, 1 );
+      if( ok && MUD_getIndVarName( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "title", 0 ) && MUD_colPutStr( &hdr, str );
+      if( ok && MUD_getIndVarDescription( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "description", 0 ) && 
+             MUD_colPutStr( &hdr, str );
+      if( ok && MUD_getIndVarUnits( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "units", 0 ) && MUD_colPutStr( &hdr, str );
+      ok = ok && MUD_colPuts( &hdr, "}" );
+    }
+    ok = ok && MUD_colPuts( &hdr, "]" );
+
+    ok = ok && MUD_colPutKey( &hdr, "ivar_columns", 0 ) && 
+         MUD_colPuts( &hdr, "{" );
+    for( j = 0; ok && j < _col_num( col_ivar_name ); j++ )
+    {
+      ok = MUD_colPutColumn( &hdr, col_ivar_name[j], "<f8", 
+                      ivarOff + j*_roundUp( 8*nIvars, MUD_COL_ALIGN ), 
+                      nIvars, ( j == 0 ) );
+    }
+    ok = ok && MUD_colPuts( &hdr, "}" );
+  }
+
+  if( ok && MUD_getComments( fd, &type, &num ) )
+  {
+    ok = MUD_colPutKey( &hdr, "comments", 0 ) && MUD_colPuts( &hdr, "[" );
+    for( i = 0; ok && i < num; i++ )
+    {
+      ok = MUD_colPuts( &hdr, i ? ", {" : "{" ) &&
+           MUD_colPutUint( &hdr, "id_number", i+1, 1 );
+      if( ok && MUD_getCommentTime( fd, i+1, &val ) )
+        ok = MUD_colPutUint( &hdr, "time", val, 0 );
+      if( ok && MUD_getCommentTitle( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "title", 0 ) && MUD_colPutStr( &hdr, str );
+      if( ok && MUD_getCommentAuthor( fd, i+1, str, MUD_COL_STRDIM ) )
+        ok = MUD_colPutKey( &hdr, "author", 0 ) && MUD_colPutStr( &hdr, str );
+      if( ok && ( body = MUD_colCommentBody( fd, i+1 ) ) != NULL )
+        ok = MUD_colPutKey( &hdr, "body", 0 ) && MUD_colPutStr( &hdr, body );
+      ok = ok && MUD_colPuts( &hdr, "}" );
+    }
+    ok = ok && MUD_colPuts( &hdr, "]" );
+  }
+
+  ok = ok && MUD_colPuts( &hdr, "}\n" );
+
+  /*
+   *  Write the preamble, header and columns
+   */
+  fout = ok ? MUD_openOutput( outfile ) : NULL;
+  if( fout == NULL ) ok = 0;
+
+  if( ok )
+  {
+    pre[0] = MUD_COL_MAGIC;
+    pre[1] = MUD_COL_VERSION;
+    pre[2] = hdr.pos;
+    pre[3] = _roundUp( 16 + hdr.pos, MUD_COL_ALIGN );
+    for( i = 0; i < 4; i++ ) bencode_4( &pre[i], &pre[i] );
+    pos = 0;
+    ok = MUD_colWrite( fout, pre, 16, &pos, 0 ) &&
+         MUD_colWrite( fout, hdr.buf, hdr.pos, &pos, 16 );
+    bdecode_4( &pre[3], &offset );
+    ok = ok && MUD_colWrite( fout, NULL, 0, &pos, offset );
+  }
+
+  pos = 0;
+  for( i = 0; ok && i < nHists; i++ )
+  {
+    if( pHistLen[i] == 0 ) continue;
+    pBins = (UINT32*)zalloc( 4*pHistLen[i] );
+    ok = ( pBins != NULL ) && MUD_unpackHist( fd, i+1, 4, pBins );
+    if( ok )
+    {
+#ifdef MUD_BIG_ENDIAN
+      for( j = 0; j < pHistLen[i]; j++ ) bencode_4( &pBins[j], &pBins[j] );
+#endif /* MUD_BIG_ENDIAN */
+      ok = MUD_colWrite( fout, pBins, 4*pHistLen[i], &pos, pHistOff[i] );
+    }
+    _free( pBins );
+  }
+
+  if( ok && nIvars > 0 )
+  {
+    pStat = (double*)zalloc( 8*nIvars );
+    ok = ( pStat != NULL );
+    for( j = 0; ok && j < _col_num( col_ivar_name ); j++ )
+    {
+      for( i = 0; i < nIvars; i++ )
+      {
+        if( !col_ivar_proc[j]( fd, i+1, &pStat[i] ) ) pStat[i] = 0.0;
+#ifdef MUD_BIG_ENDIAN
+        bencode_8( &pStat[i], &pStat[i] );
+#endif /* MUD_BIG_ENDIAN */
+      }
+      ok = MUD_colWrite( fout, pStat, 8*nIvars, &pos, 
+                         ivarOff + j*_roundUp( 8*nIvars, MUD_COL_ALIGN ) );
+    }
+    _free( pStat );
+  }
+
+  if( fout != NULL )
+  {
+    ok = ( fclose( fout ) == 0 ) && ok;
+    if( !ok ) remove( outfile );
+  }
+
+  _free( hdr.buf );
+  _free( pHistOff );
+  _free( pHistLen );
+
+  return( ok );
+}
+
+
+/*
+ *  Performance counters
+ */
+int
+MUD_getStats( int fd, MUD_STATS* pStats )
+{
+  _check_fd( fd );
+
+  bcopy( &mud_stats[fd], pStats, sizeof( MUD_STATS ) );
+
+  return( 1 );
+}
@@ -24,6 +24,15 @@
  *   v1.0d  11-Jul-1994  [TW] Fixed "unaligned data access" messages in
  *			 MUD_SEC_GEN_HIST_pack()
  *          25-Nov-2009  DA  Handle 8-byte time_t
+ *          19-Oct-2026  agent  Time REAL32/REAL64 array decoding (MUD_STATS)
+ *          19-Oct-2026  agent  Trace points around histogram pack/unpack
+ *          19-Oct-2026  agent  Free strings with _free_str (string arenas)
+ *          19-Oct-2026  agent  Pass pack_op to dopack etc., for use in threads
+ *          19-Oct-2026  agent  Add MUD_SEC_GEN_HIST_unpackRebin
+ *          19-Oct-2026  agent  Pack and unpack MUD_BIN_SIZE_DELTA (mud_delta.c)
+ *          19-Oct-2026  agent  Add MUD_SEC_GEN_HIST_dataBytes and
+ *                              MUD_SEC_GEN_HIST_unpackChecked, to unpack
+ *                              only data within the bytes read
  */
 
 #include <time.h>
@@ -33,12 +42,12 @@
 /* #define DEBUG 1 */ /*  (un)comment for debug */  
 #define PACK_OP 1
 #define UNPACK_OP 2
-static int pack_op;
 
-static int MUD_SEC_GEN_HIST_dopack _ANSI_ARGS_(( int num, int inBinSize, void* inHist, int outBinSize, void* outHist ));
+static int MUD_SEC_GEN_HIST_dopack _ANSI_ARGS_(( int pack_op, int num, int inBinSize, void* inHist, int outBinSize, void* outHist ));
 static int n_bytes_needed _ANSI_ARGS_(( UINT32 val ));
-static UINT32 varBinArray _ANSI_ARGS_(( void* pHistData, int binSize, int index ));
-static void next_few_bins _ANSI_ARGS_(( int num_tot, int inBinSize, void* pHistData, int outBinSize_now, MUD_VAR_BIN_LEN_TYPE *pNum_next, MUD_VAR_BIN_SIZ_TYPE *pOutBinSize_next ));
+static UINT32 varBinArray _ANSI_ARGS_(( int pack_op, void* pHistData, int binSize, int index ));
+static void next_few_bins _ANSI_ARGS_(( int pack_op, int num_tot, int inBinSize, void* pHistData, int outBinSize_now, MUD_VAR_BIN_LEN_TYPE *pNum_next, MUD_VAR_BIN_SIZ_TYPE *pOutBinSize_next ));
+static UINT8* rebin_bins _ANSI_ARGS_(( int num, int inBinSize, UINT8* inHist, int factor, UINT64** ppOut, int* pCount ));
 
 
 int
@@ -52,18 +61,18 @@ MUD_SEC_GEN_RUN_DESC_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_RUN_DESC* pMUD )
     switch( op )
     {
 	case MUD_FREE:
-	    _free( pMUD->title );
-	    _free( pMUD->lab );
-	    _free( pMUD->area );
-	    _free( pMUD->method );
-	    _free( pMUD->apparatus );
-	    _free( pMUD->insert );
-	    _free( pMUD->sample );
-	    _free( pMUD->orient );
-	    _free( pMUD->das );
-	    _free( pMUD->experimenter );
-	    _free( pMUD->temperature );
-	    _free( pMUD->field );
+	    _free_str( pMUD->title );
+	    _free_str( pMUD->lab );
+	    _free_str( pMUD->area );
+	    _free_str( pMUD->method );
+	    _free_str( pMUD->apparatus );
+	    _free_str( pMUD->insert );
+	    _free_str( pMUD->sample );
+	    _free_str( pMUD->orient );
+	    _free_str( pMUD->das );
+	    _free_str( pMUD->experimenter );
+	    _free_str( pMUD->temperature );
+	    _free_str( pMUD->field );
 	    break;
 	case MUD_DECODE:
 	    decode_4( pBuf, &pMUD->exptNumber );
@@ -202,7 +211,7 @@ MUD_SEC_GEN_HIST_HDR_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_HIST_HDR* pMUD )
     switch( op )
     {
 	case MUD_FREE:
-	    _free( pMUD->title );
+	    _free_str( pMUD->title );
 	    break;
 	case MUD_DECODE:
 	    decode_4( pBuf, &pMUD->histType );
@@ -320,7 +329,7 @@ MUD_SEC_GEN_SCALER_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_SCALER* pMUD )
     switch( op )
     {
 	case MUD_FREE:
-	    _free( pMUD->label );
+	    _free_str( pMUD->label );
 	    break;
 	case MUD_DECODE:
 	    decode_4( pBuf, &pMUD->counts[0] );
@@ -361,9 +370,9 @@ MUD_SEC_GEN_IND_VAR_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_IND_VAR* pMUD )
     switch( op )
     {
 	case MUD_FREE:
-	    _free( pMUD->name );
-	    _free( pMUD->description );
-	    _free( pMUD->units );
+	    _free_str( pMUD->name );
+	    _free_str( pMUD->description );
+	    _free_str( pMUD->units );
 	    break;
 	case MUD_DECODE:
 	    decode_double( pBuf, &pMUD->low );
@@ -420,6 +429,7 @@ MUD_SEC_GEN_ARRAY_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_ARRAY* pMUD )
 {
     int size;
     int i;
+    UINT64 t;
 
     switch( op )
     {
@@ -440,6 +450,7 @@ MUD_SEC_GEN_ARRAY_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_ARRAY* pMUD )
                 _decode_obj( pBuf, pMUD->pData, pMUD->nBytes );
                 break;
               case 2:
+                _stat_time( t );
                 switch( pMUD->elemSize )
                 {
                   case 4:
@@ -455,6 +466,7 @@ MUD_SEC_GEN_ARRAY_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_ARRAY* pMUD )
                     }
                     break;
                 }
+                _stat_since( nsFloat, t );
                 break;
               case 3:
                 _decode_obj( pBuf, pMUD->pData, pMUD->nBytes );
@@ -533,19 +545,207 @@ MUD_SEC_GEN_ARRAY_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_GEN_ARRAY* pMUD )
 int
 MUD_SEC_GEN_HIST_pack( int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
 {
-  pack_op = PACK_OP;
-  return( MUD_SEC_GEN_HIST_dopack( num, inBinSize, inHist, outBinSize, outHist ) );
+  int n;
+
+  _trace( pack_begin, MUD_TRACE_PACK_BEGIN, inBinSize, outBinSize, num );
+  n = MUD_SEC_GEN_HIST_dopack( PACK_OP, num, inBinSize, inHist, outBinSize, outHist );
+  _trace( pack_end, MUD_TRACE_PACK_END, inBinSize, outBinSize, n );
+
+  return( n );
 }
 
 int
 MUD_SEC_GEN_HIST_unpack( int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
 {
-  pack_op = UNPACK_OP;
-  return( MUD_SEC_GEN_HIST_dopack( num, inBinSize, inHist, outBinSize, outHist ) );
+  int n;
+
+  _trace( unpack_begin, MUD_TRACE_UNPACK_BEGIN, inBinSize, outBinSize, num );
+  n = MUD_SEC_GEN_HIST_dopack( UNPACK_OP, num, inBinSize, inHist, outBinSize, outHist );
+  _trace( unpack_end, MUD_TRACE_UNPACK_END, inBinSize, outBinSize, n );
+
+  return( n );
+}
+
+/*
+ *  MUD_SEC_GEN_HIST_dataBytes() - the bytes taken by num bins of
+ *  inBinSize bytes (0 for packed, or MUD_BIN_SIZE_DELTA) at inHist, as
+ *  told by their run headers or control bytes, reading none past
+ *  nBytes.  Returns -1 if they do not fit in nBytes, or, for delta data,
+ *  do not fill them exactly; or if a packed run is empty, of an unknown
+ *  size, or past bin num.  No data (nBytes 0) stand for num bins of 0,
+ *  and take 0 bytes.
+ */
+int
+MUD_SEC_GEN_HIST_dataBytes( int num, int inBinSize, void* inHist, UINT32 nBytes )
+{
+  UINT8* pIn = (UINT8*)inHist;
+  UINT32 n = 0;
+  int bin, num_temp, inBinSize_temp;
+
+  if( num < 0 ) return( -1 );
+  if( nBytes == 0 ) return( 0 );
+
+  switch( inBinSize )
+  {
+    case MUD_BIN_SIZE_DELTA:
+      bin = MUD_deltaBytes( num, pIn, nBytes );
+      return( ( ( bin < 0 ) || ( (UINT32)bin != nBytes ) ) ? -1 : bin );
+    case 1:
+    case 2:
+    case 4:
+      return( ( (UINT32)num > nBytes/inBinSize ) ? -1 : num*inBinSize );
+    case 0:
+      break;
+    default:
+      return( -1 );
+  }
+
+  for( bin = 0; bin < num; bin += num_temp )
+  {
+      if( nBytes - n < 3 ) return( -1 );
+      num_temp = pIn[n] | ( pIn[n+1] << 8 );
+      inBinSize_temp = pIn[n+2];
+      n += 3;
+
+      if( ( num_temp == 0 ) || ( num_temp > num - bin ) ) return( -1 );
+      if( ( inBinSize_temp != 0 ) && ( inBinSize_temp != 1 ) &&
+	  ( inBinSize_temp != 2 ) && ( inBinSize_temp != 4 ) ) return( -1 );
+      if( (UINT32)( num_temp*inBinSize_temp ) > nBytes - n ) return( -1 );
+      n += num_temp*inBinSize_temp;
+  }
+
+  return( (int)n );
+}
+
+/*
+ *  MUD_SEC_GEN_HIST_unpackChecked() - MUD_SEC_GEN_HIST_unpack() of data
+ *  read into nBytes, such as a histogram of a file.  Returns -1, with
+ *  nothing unpacked, if the data are not num bins within nBytes (see
+ *  MUD_SEC_GEN_HIST_dataBytes).
+ */
+int
+MUD_SEC_GEN_HIST_unpackChecked( int num, int inBinSize, void* inHist, UINT32 nBytes, int outBinSize, void* outHist )
+{
+  int n;
+
+  if( MUD_SEC_GEN_HIST_dataBytes( num, inBinSize, inHist, nBytes ) < 0 )
+      return( -1 );
+  if( nBytes == 0 )
+  {
+      bzero( outHist, num*outBinSize );
+      return( num*outBinSize );
+  }
+  if( inBinSize != MUD_BIN_SIZE_DELTA )
+      return( MUD_SEC_GEN_HIST_unpack( num, inBinSize, inHist, outBinSize, outHist ) );
+
+  _trace( unpack_begin, MUD_TRACE_UNPACK_BEGIN, inBinSize, outBinSize, num );
+  n = MUD_deltaUnpack( num, inHist, nBytes, outBinSize, outHist );
+  _trace( unpack_end, MUD_TRACE_UNPACK_END, inBinSize, outBinSize, n );
+
+  return( ( n > 0 || num == 0 ) ? n : -1 );
+}
+
+/*
+ *  MUD_SEC_GEN_HIST_unpackRebin() - unpack num bins of inBinSize bytes
+ *  (0 for packed, or MUD_BIN_SIZE_DELTA) read into nBytes, adding each
+ *  factor adjacent bins into one UINT64 of outHist, which the caller
+ *  zeroes (or fills with a sum to add to).  The last output bin holds
+ *  what is left over if factor does not divide num.  Full-resolution
+ *  bins are never stored.
+ *
+ *  Returns the number of output bins, or 0, with nothing added, if the
+ *  data are not num bins within nBytes (see MUD_SEC_GEN_HIST_dataBytes).
+ */
+int
+MUD_SEC_GEN_HIST_unpackRebin( int num, int inBinSize, void* inHist, UINT32 nBytes, int factor, UINT64* outHist )
+{
+  UINT8* pIn = (UINT8*)inHist;
+  UINT64* pOut = outHist;
+  int count = 0;
+  int bin, num_temp, inBinSize_temp;
+
+  if( factor < 1 ) return( 0 );
+  if( MUD_SEC_GEN_HIST_dataBytes( num, inBinSize, inHist, nBytes ) < 0 )
+      return( 0 );
+  if( nBytes == 0 ) return( ( num + factor - 1 )/factor );
+
+  _trace( unpack_begin, MUD_TRACE_UNPACK_BEGIN, inBinSize, 8, num );
+
+  if( inBinSize == MUD_BIN_SIZE_DELTA )
+  {
+      pOut += MUD_deltaUnpackRebin( num, pIn, nBytes, factor, outHist );
+  }
+  else if( inBinSize == 0 )
+  {
+      for( bin = 0; bin < num; bin += num_temp )
+      {
+	  num_temp = pIn[0] | ( pIn[1] << 8 );
+	  inBinSize_temp = pIn[2];
+	  pIn = rebin_bins( num_temp, inBinSize_temp, &pIn[3],
+			    factor, &pOut, &count );
+      }
+  }
+  else
+  {
+      rebin_bins( num, inBinSize, pIn, factor, &pOut, &count );
+  }
+  if( count > 0 ) pOut++;
+
+  _trace( unpack_end, MUD_TRACE_UNPACK_END, inBinSize, 8, (UINT32)( pOut - outHist ) );
+
+  return( (int)( pOut - outHist ) );
 }
 
+
+/*
+ *  Add num little-endian bins of inBinSize bytes (0 for all zero) to
+ *  *ppOut, which already holds *pCount of its factor bins.  Returns the
+ *  input following the bins.
+ */
+static UINT8*
+rebin_bins( int num, int inBinSize, UINT8* inHist, int factor, UINT64** ppOut, int* pCount )
+{
+  UINT8* p = inHist;
+  UINT64 sum;
+  int i, n;
+
+  while( num > 0 )
+  {
+      n = _min( num, factor - *pCount );
+      sum = 0;
+
+      switch( inBinSize )
+      {
+	case 1:
+	  for( i = 0; i < n; i++ ) sum += p[i];
+	  break;
+	case 2:
+	  for( i = 0; i < n; i++ ) sum += (UINT32)( p[2*i] | ( p[2*i+1] << 8 ) );
+	  break;
+	case 4:
+	  for( i = 0; i < n; i++ )
+	      sum += (UINT32)p[4*i] | ( (UINT32)p[4*i+1] << 8 ) |
+		     ( (UINT32)p[4*i+2] << 16 ) | ( (UINT32)p[4*i+3] << 24 );
+	  break;
+      }
+
+      **ppOut += sum;
+      p += n*inBinSize;
+      num -= n;
+      *pCount += n;
+      if( *pCount == factor )
+      {
+	  (*ppOut)++;
+	  *pCount = 0;
+      }
+  }
+
+  return( p );
+}
+
+
 static int
-MUD_SEC_GEN_HIST_dopack( int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
+MUD_SEC_GEN_HIST_dopack( int pack_op, int num, int inBinSize, void* inHist, int outBinSize, void* outHist )
 {
     int i;
     int outLen = 0;
@@ -575,7 +775,19 @@ MUD_SEC_GEN_HIST_dopack( int num, int inBinSize, void* inHist, int outBinSize, v
 
 #endif /* DEBUG */
     
-    if( inBinSize == 1 && outBinSize == 1 )
+    if( outBinSize == MUD_BIN_SIZE_DELTA )
+    {
+	outLen = ( pack_op == PACK_OP ) ? 
+	    MUD_deltaPack( num, inBinSize, inHist, outHist ) : 0;
+    }
+    else if( inBinSize == MUD_BIN_SIZE_DELTA )
+    {
+	outLen = ( pack_op == UNPACK_OP ) ? 
+	    MUD_deltaUnpack( num, inHist, (UINT32)MUD_deltaBytes( num, inHist,
+					      _delta_max_bytes( num ) ),
+			     outBinSize, outHist ) : 0;
+    }
+    else if( inBinSize == 1 && outBinSize == 1 )
     {
 	bcopy( inHist, outHist, num );
 	outLen = num*outBinSize;
@@ -844,11 +1056,11 @@ MUD_SEC_GEN_HIST_dopack( int num, int inBinSize, void* inHist, int outBinSize, v
 	bin = 0;
 	inLoc = 0;
 	outLoc = 0;
-        outBinSize_now = n_bytes_needed( varBinArray( inHist, inBinSize, 0 ) );
+        outBinSize_now = n_bytes_needed( varBinArray( pack_op, inHist, inBinSize, 0 ) );
 
 	while( bin < num )
 	{
-	    next_few_bins( num - bin, inBinSize, &((char*)inHist)[inLoc],
+	    next_few_bins( pack_op, num - bin, inBinSize, &((char*)inHist)[inLoc],
 			   outBinSize_now, &num_temp, &outBinSize_next );
 
 #ifdef DEBUG
@@ -912,7 +1124,7 @@ n_bytes_needed( UINT32 val )
 
 
 static UINT32
-varBinArray( void* pHistData, int binSize, int index )
+varBinArray( int pack_op, void* pHistData, int binSize, int index )
 {
   UINT8  c;
   UINT16 s;
@@ -954,7 +1166,7 @@ varBinArray( void* pHistData, int binSize, int index )
 
 
 static void
-next_few_bins( int num_tot, int inBinSize, void* pHistData, int outBinSize_now,
+next_few_bins( int pack_op, int num_tot, int inBinSize, void* pHistData, int outBinSize_now,
                MUD_VAR_BIN_LEN_TYPE* pNum_next, MUD_VAR_BIN_SIZ_TYPE* pOutBinSize_next )
 {
     int val;
@@ -997,7 +1209,7 @@ next_few_bins( int num_tot, int inBinSize, void* pHistData, int outBinSize_now,
         break;
       } 
 
-	val = varBinArray( pHistData, inBinSize, num_next );
+	val = varBinArray( pack_op, pHistData, inBinSize, num_next );
 	outBinSize_next = n_bytes_needed( val );
 	if( outBinSize_next == outBinSize_now ) 
 	{
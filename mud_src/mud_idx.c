@@ -0,0 +1,567 @@
+/*
+ *  mud_idx.c -- persistent section-offset index ("sidecar") for MUD files
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   18-Oct-2026  agent  Initial version
+ *
+ *  Description:
+ *    Finding a section in a MUD file means walking the group headers from
+ *    the start of the file, and every process does that walk again.
+ *    MUD_writeIndex() records the absolute offset, size and IDs of every
+ *    section of a file in "<file>.idx" (MUD_IDX_SUFFIX), in file order.
+ *    MUD_readIndex() loads such an index back, but only while the size and
+ *    modification time of the data file still match the values recorded in
+ *    it; a stale index is simply ignored.
+ *
+ *    With an index, MUD_readFileIndexed() builds the usual section tree
+ *    with one MUD_pread() per run of adjacent sections, and leaves the
+ *    histogram data (MUD_SEC_GEN_HIST_DAT) sections as empty placeholders
+ *    (pData == NULL, nBytes != 0) which are filled on demand with
+ *    MUD_readEntry() -- a single read of exactly the bytes needed.
+ *
+ *  Index file layout (all values 4-byte little-endian, as in MUD files):
+ *    magic ("MUDI"), version, fileSize, fileTime, num
+ *    num * [ offset, size, secID, instanceID, parent ]
+ *    where parent is the entry number of the enclosing group, or
+ *    0xFFFFFFFF for sections at the top level.
+ */
+
+#include <sys/stat.h>
+#include "mud.h"
+
+#define MUD_IDX_MAGIC	    0x4944554D	    /* "MUDI" */
+#define MUD_IDX_VERSION	    1
+#define MUD_IDX_NHDR	    5		    /* UINT32 words in the header */
+#define MUD_IDX_NENT	    5		    /* UINT32 words per entry */
+
+static int MUD_idxAdd _ANSI_ARGS_(( MUD_IDX* pIdx, UINT32 offset, UINT32 size, UINT32 secID, UINT32 instanceID, INT32 parent ));
+static BOOL MUD_idxScanSec _ANSI_ARGS_(( FILE* fin, MUD_IDX* pIdx, UINT32 pos, INT32 parent, UINT32* pNext ));
+static BOOL MUD_idxStat _ANSI_ARGS_(( char* filename, UINT32* pSize, TIME* pTime ));
+static char* MUD_idxName _ANSI_ARGS_(( char* filename ));
+
+
+static int
+MUD_idxAdd( MUD_IDX* pIdx, UINT32 offset, UINT32 size,
+	    UINT32 secID, UINT32 instanceID, INT32 parent )
+{
+    MUD_IDX_ENTRY* pEntry;
+
+    if( pIdx->num == pIdx->alloc )
+    {
+	pIdx->alloc = ( pIdx->alloc == 0 ) ? 64 : 2*pIdx->alloc;
+	pEntry = (MUD_IDX_ENTRY*)realloc( pIdx->pEntry,
+				pIdx->alloc*sizeof( MUD_IDX_ENTRY ) );
+	if( pEntry == NULL ) return( -1 );
+	pIdx->pEntry = pEntry;
+    }
+
+    pEntry = &pIdx->pEntry[pIdx->num];
+    pEntry->offset = offset;
+    pEntry->size = size;
+    pEntry->secID = secID;
+    pEntry->instanceID = instanceID;
+    pEntry->parent = parent;
+
+    return( pIdx->num++ );
+}
+
+
+/*
+ *  Index the section at pos and (for a group) its members, which
+ *  follow the group header directly, exactly as MUD_read() finds them.
+ */
+static BOOL
+MUD_idxScanSec( FILE* fin, MUD_IDX* pIdx, UINT32 pos, INT32 parent,
+		UINT32* pNext )
+{
+    char core[16];
+    UINT32 size, secID, instanceID, num;
+    UINT32 i;
+    int self;
+
+    if( MUD_pread( fin, core, 16, pos ) < 12 ) return( FALSE );
+
+    bdecode_4( &core[0], &size );
+    bdecode_4( &core[4], &secID );
+    bdecode_4( &core[8], &instanceID );
+    if( size < 12 ) return( FALSE );
+
+    self = MUD_idxAdd( pIdx, pos, size, secID, instanceID, parent );
+    if( self < 0 ) return( FALSE );
+
+    *pNext = pos + size;
+
+    if( secID == MUD_SEC_GRP_ID )
+    {
+	bdecode_4( &core[12], &num );
+	for( i = 0; i < num; i++ )
+	{
+	    if( !MUD_idxScanSec( fin, pIdx, *pNext, self, pNext ) )
+		return( FALSE );
+	    if( pIdx->pEntry[pIdx->num-1].secID == MUD_SEC_EOF_ID ) break;
+	}
+    }
+
+    return( TRUE );
+}
+
+
+static BOOL
+MUD_idxStat( char* filename, UINT32* pSize, TIME* pTime )
+{
+    struct stat st;
+
+    if( stat( filename, &st ) != 0 ) return( FALSE );
+
+    *pSize = (UINT32)st.st_size;
+    *pTime = (TIME)st.st_mtime;
+
+    return( TRUE );
+}
+
+
+static char*
+MUD_idxName( char* filename )
+{
+    char* idxname;
+
+    idxname = (char*)malloc( strlen( filename ) + strlen( MUD_IDX_SUFFIX ) + 1 );
+    if( idxname == NULL ) return( NULL );
+
+    strcpy( idxname, filename );
+    strcat( idxname, MUD_IDX_SUFFIX );
+
+    return( idxname );
+}
+
+
+/*
+ *  MUD_scanIndex() - build the index of an open file by walking
+ *  the section headers.  Only the headers are read.
+ */
+MUD_IDX*
+MUD_scanIndex( FILE* fin )
+{
+    MUD_IDX* pIdx;
+    UINT32 pos = 0;
+    UINT32 next;
+    UINT32 num;
+
+    pIdx = (MUD_IDX*)zalloc( sizeof( MUD_IDX ) );
+    if( pIdx == NULL ) return( NULL );
+
+    for( ;; )
+    {
+	num = pIdx->num;
+	if( !MUD_idxScanSec( fin, pIdx, pos, -1, &next ) )
+	{
+	    /*
+	     *  Like MUD_read, accept a file that ends without an EOF
+	     *  section, but not a partially indexed one.
+	     */
+	    pIdx->num = num;
+	    break;
+	}
+	if( pIdx->pEntry[num].secID == MUD_SEC_EOF_ID ) break;
+	pos = next;
+    }
+
+    if( pIdx->num == 0 )
+    {
+	MUD_freeIndex( pIdx );
+	return( NULL );
+    }
+
+    return( pIdx );
+}
+
+
+/*
+ *  MUD_writeIndex() - write the sidecar index for a MUD file
+ */
+BOOL
+MUD_writeIndex( char* filename )
+{
+    FILE* fin;
+    FILE* fout;
+    MUD_IDX* pIdx;
+    char* idxname;
+    char* tmpname;
+    char* buf;
+    UINT32 hdr[MUD_IDX_NHDR];
+    UINT32 i, j, n;
+    BOOL ok;
+
+    fin = MUD_openInput( filename );
+    if( fin == NULL ) return( FALSE );
+
+    pIdx = MUD_scanIndex( fin );
+    fclose( fin );
+    if( pIdx == NULL ) return( FALSE );
+
+    if( !MUD_idxStat( filename, &pIdx->fileSize, &pIdx->fileTime ) )
+    {
+	MUD_freeIndex( pIdx );
+	return( FALSE );
+    }
+
+    n = 4*( MUD_IDX_NHDR + MUD_IDX_NENT*pIdx->num );
+    buf = (char*)malloc( n );
+    idxname = MUD_idxName( filename );
+    tmpname = MUD_idxName( idxname ? idxname : filename );
+    if( buf == NULL || idxname == NULL || tmpname == NULL )
+    {
+	_free( buf );
+	_free( idxname );
+	_free( tmpname );
+	MUD_freeIndex( pIdx );
+	return( FALSE );
+    }
+
+    hdr[0] = MUD_IDX_MAGIC;
+    hdr[1] = MUD_IDX_VERSION;
+    hdr[2] = pIdx->fileSize;
+    hdr[3] = pIdx->fileTime;
+    hdr[4] = pIdx->num;
+    for( j = 0; j < MUD_IDX_NHDR; j++ ) bencode_4( &buf[4*j], &hdr[j] );
+
+    for( i = 0; i < pIdx->num; i++ )
+    {
+	j = 4*( MUD_IDX_NHDR + MUD_IDX_NENT*i );
+	bencode_4( &buf[j], &pIdx->pEntry[i].offset );
+	bencode_4( &buf[j+4], &pIdx->pEntry[i].size );
+	bencode_4( &buf[j+8], &pIdx->pEntry[i].secID );
+	bencode_4( &buf[j+12], &pIdx->pEntry[i].instanceID );
+	bencode_4( &buf[j+16], &pIdx->pEntry[i].parent );
+    }
+
+    /*
+     *  Write a temporary file and rename it, so that a concurrent reader
+     *  never sees a half-written index.
+     */
+    ok = FALSE;
+    fout = MUD_openOutput( tmpname );
+    if( fout != NULL )
+    {
+	ok = ( fwrite( buf, n, 1, fout ) == 1 );
+	ok = ( fclose( fout ) == 0 ) && ok;
+#ifdef _WIN32
+	if( ok ) remove( idxname );
+#endif /* _WIN32 */
+	if( ok ) ok = ( rename( tmpname, idxname ) == 0 );
+	if( !ok ) remove( tmpname );
+    }
+
+    free( buf );
+    free( idxname );
+    free( tmpname );
+    MUD_freeIndex( pIdx );
+
+    return( ok );
+}
+
+
+/*
+ *  MUD_readIndex() - load the sidecar index of a MUD file.
+ *  Returns NULL if there is no index, or if it does not match the
+ *  current size and modification time of the file.
+ */
+MUD_IDX*
+MUD_readIndex( char* filename )
+{
+    FILE* fidx;
+    MUD_IDX* pIdx;
+    char* idxname;
+    char* buf;
+    UINT32 hdr[MUD_IDX_NHDR];
+    UINT32 fileSize;
+    TIME fileTime;
+    UINT32 i, j, n;
+
+    if( !MUD_idxStat( filename, &fileSize, &fileTime ) ) return( NULL );
+
+    idxname = MUD_idxName( filename );
+    if( idxname == NULL ) return( NULL );
+    fidx = MUD_openInput( idxname );
+    free( idxname );
+    if( fidx == NULL ) return( NULL );
+
+    buf = (char*)malloc( 4*MUD_IDX_NHDR );
+    if( buf == NULL || fread( buf, 4*MUD_IDX_NHDR, 1, fidx ) != 1 )
+    {
+	_free( buf );
+	fclose( fidx );
+	return( NULL );
+    }
+    for( j = 0; j < MUD_IDX_NHDR; j++ ) bdecode_4( &buf[4*j], &hdr[j] );
+    free( buf );
+
+    if( ( hdr[0] != MUD_IDX_MAGIC ) || ( hdr[1] != MUD_IDX_VERSION ) ||
+	( hdr[2] != fileSize ) || ( hdr[3] != fileTime ) || ( hdr[4] == 0 ) )
+    {
+	fclose( fidx );
+	return( NULL );
+    }
+
+    pIdx = (MUD_IDX*)zalloc( sizeof( MUD_IDX ) );
+    n = 4*MUD_IDX_NENT*hdr[4];
+    buf = (char*)malloc( n );
+    if( pIdx == NULL || buf == NULL || fread( buf, n, 1, fidx ) != 1 )
+    {
+	_free( buf );
+	MUD_freeIndex( pIdx );
+	fclose( fidx );
+	return( NULL );
+    }
+    fclose( fidx );
+
+    pIdx->fileSize = fileSize;
+    pIdx->fileTime = fileTime;
+    pIdx->num = pIdx->alloc = hdr[4];
+    pIdx->pEntry = (MUD_IDX_ENTRY*)malloc( pIdx->num*sizeof( MUD_IDX_ENTRY ) );
+    if( pIdx->pEntry == NULL )
+    {
+	free( buf );
+	MUD_freeIndex( pIdx );
+	return( NULL );
+    }
+
+    for( i = 0; i < pIdx->num; i++ )
+    {
+	j = 4*MUD_IDX_NENT*i;
+	bdecode_4( &buf[j], &pIdx->pEntry[i].offset );
+	bdecode_4( &buf[j+4], &pIdx->pEntry[i].size );
+	bdecode_4( &buf[j+8], &pIdx->pEntry[i].secID );
+	bdecode_4( &buf[j+12], &pIdx->pEntry[i].instanceID );
+	bdecode_4( &buf[j+16], &pIdx->pEntry[i].parent );
+
+	/*
+	 *  Entries must lie inside the file, and groups must come
+	 *  before their members.
+	 */
+	if( ( pIdx->pEntry[i].size < 12 ) ||
+	    ( pIdx->pEntry[i].offset > fileSize ) ||
+	    ( pIdx->pEntry[i].size > fileSize - pIdx->pEntry[i].offset ) ||
+	    ( pIdx->pEntry[i].parent >= (INT32)i ) ||
+	    ( pIdx->pEntry[i].parent < -1 ) )
+	{
+	    free( buf );
+	    MUD_freeIndex( pIdx );
+	    return( NULL );
+	}
+    }
+    free( buf );
+
+    return( pIdx );
+}
+
+
+void
+MUD_freeIndex( MUD_IDX* pIdx )
+{
+    if( pIdx == NULL ) return;
+
+    _free( pIdx->pEntry );
+    free( pIdx );
+}
+
+
+/*
+ *  MUD_findIndex() - entry number of section (secID, instanceID)
+ *  within the group at entry parent (-1 for the top level), or -1.
+ */
+int
+MUD_findIndex( MUD_IDX* pIdx, int parent, UINT32 secID, UINT32 instanceID )
+{
+    UINT32 i;
+
+    if( pIdx == NULL ) return( -1 );
+
+    for( i = ( parent < 0 ) ? 0 : parent + 1; i < pIdx->num; i++ )
+    {
+	if( ( pIdx->pEntry[i].parent == parent ) &&
+	    ( pIdx->pEntry[i].secID == secID ) &&
+	    ( pIdx->pEntry[i].instanceID == instanceID ) )
+	    return( i );
+    }
+
+    return( -1 );
+}
+
+
+/*
+ *  MUD_readEntry() - read and decode one indexed section, with a
+ *  single read.  Groups come back without their members.
+ */
+void*
+MUD_readEntry( FILE* fin, MUD_IDX_ENTRY* pEntry )
+{
+    BUF buf;
+    MUD_SEC* pMUD;
+
+    bzero( &buf, sizeof( BUF ) );
+    buf.buf = (char*)malloc( (size_t)pEntry->size );
+    if( buf.buf == NULL ) return( NULL );
+
+    if( MUD_pread( fin, buf.buf, pEntry->size, pEntry->offset ) != pEntry->size )
+    {
+	free( buf.buf );
+	return( NULL );
+    }
+
+    pMUD = (MUD_SEC*)MUD_decode( &buf );
+    free( buf.buf );
+    if( pMUD == NULL ) return( NULL );
+
+    if( ( MUD_size( pMUD ) != pEntry->size ) ||
+	( MUD_secID( pMUD ) != pEntry->secID ) ||
+	( MUD_instanceID( pMUD ) != pEntry->instanceID ) )
+    {
+	MUD_free( pMUD );
+	return( NULL );
+    }
+
+    return( pMUD );
+}
+
+
+/*
+ *  MUD_readFileIndexed() - the equivalent of MUD_readFile() using an
+ *  index.  Adjacent sections are read together, and histogram data
+ *  sections are left as placeholders to be read with MUD_readEntry().
+ */
+void*
+MUD_readFileIndexed( FILE* fin, MUD_IDX* pIdx )
+{
+    MUD_SEC** ppMUD;
+    MUD_SEC* pMUD_head = NULL;
+    MUD_SEC* pMUD;
+    MUD_IDX_ENTRY* pEntry;
+    BUF buf;
+    char* p;
+    UINT32 i, j, k;
+    UINT32 start, end;
+    BOOL ok = TRUE;
+
+    ppMUD = (MUD_SEC**)zalloc( pIdx->num*sizeof( MUD_SEC* ) );
+    if( ppMUD == NULL ) return( NULL );
+
+    bzero( &buf, sizeof( BUF ) );
+
+    for( i = 0; ok && ( i < pIdx->num ); i = j )
+    {
+	/*
+	 *  Find the run of adjacent sections to be read now
+	 */
+	start = end = pIdx->pEntry[i].offset;
+	for( j = i; j < pIdx->num; j++ )
+	{
+	    pEntry = &pIdx->pEntry[j];
+	    if( ( pEntry->secID == MUD_SEC_GEN_HIST_DAT_ID ) ||
+		( pEntry->secID == MUD_SEC_EOF_ID ) ||
+		( pEntry->offset != end ) ) break;
+	    end += pEntry->size;
+	}
+
+	if( j > i )
+	{
+	    p = (char*)realloc( buf.buf, end - start );
+	    if( p == NULL )
+	    {
+		ok = FALSE;
+		break;
+	    }
+	    buf.buf = p;
+	    if( MUD_pread( fin, buf.buf, end - start, start ) != end - start )
+	    {
+		ok = FALSE;
+		break;
+	    }
+	}
+
+	for( k = i; k < j; k++ )
+	{
+	    pEntry = &pIdx->pEntry[k];
+	    buf.pos = pEntry->offset - start;
+	    pMUD = (MUD_SEC*)MUD_decode( &buf );
+	    if( ( pMUD == NULL ) ||
+		( MUD_size( pMUD ) != pEntry->size ) ||
+		( MUD_secID( pMUD ) != pEntry->secID ) ||
+		( MUD_instanceID( pMUD ) != pEntry->instanceID ) )
+	    {
+		if( pMUD != NULL ) MUD_free( pMUD );
+		ok = FALSE;
+		break;
+	    }
+	    ppMUD[k] = pMUD;
+	}
+
+	/*
+	 *  Placeholders for sections which are not read now
+	 */
+	if( ok && ( j == i ) )
+	{
+	    pEntry = &pIdx->pEntry[j++];
+	    if( pEntry->secID == MUD_SEC_EOF_ID ) continue;
+
+	    pMUD = MUD_new( pEntry->secID, pEntry->instanceID );
+	    if( pMUD == NULL )
+	    {
+		ok = FALSE;
+		break;
+	    }
+	    pMUD->core.size = pEntry->size;
+	    ((MUD_SEC_GEN_HIST_DAT*)pMUD)->nBytes = pEntry->size -
+		    MUD_CORE_proc( MUD_GET_SIZE, NULL, NULL ) - sizeof( UINT32 );
+	    ppMUD[j-1] = pMUD;
+	}
+    }
+
+    _free( buf.buf );
+
+    /*
+     *  Assemble the tree in file order
+     */
+    for( i = 0; i < pIdx->num; i++ )
+    {
+	if( ppMUD[i] == NULL ) continue;
+
+	pEntry = &pIdx->pEntry[i];
+	if( pEntry->parent < 0 )
+	{
+	    MUD_add( (void**)&pMUD_head, ppMUD[i] );
+	}
+	else if( ( ppMUD[pEntry->parent] != NULL ) &&
+		 ( MUD_secID( ppMUD[pEntry->parent] ) == MUD_SEC_GRP_ID ) )
+	{
+	    MUD_addMember( (MUD_SEC_GRP*)ppMUD[pEntry->parent], ppMUD[i] );
+	}
+	else
+	{
+	    MUD_free( ppMUD[i] );
+	    ok = FALSE;
+	}
+    }
+
+    free( ppMUD );
+
+    if( !ok )
+    {
+	MUD_free( pMUD_head );
+	return( NULL );
+    }
+
+    return( pMUD_head );
+}
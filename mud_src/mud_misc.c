@@ -22,6 +22,13 @@
  *   v3.0  20-Feb-1996  TW  Added gmf_time.c, renamed to mud_misc.c
  *         04-Mar-1996  TW  Removed memory allocation routines
  *   v4.0  02-Dec-2009  DA  Use mud TIME type, not system time_t
+ *         19-Oct-2026  agent  Add MUD_zalloc, MUD_nsec for MUD_getStats
+ *         19-Oct-2026  agent  Add string arenas (MUD_newStrArena etc.)
+ *         19-Oct-2026  agent  Add MUD_lock; arena in use per thread
+ *         19-Oct-2026  agent  MUD_strFree looks up a sorted table of arena
+ *                             blocks, without locking
+ *         19-Oct-2026  agent  Add MUD_runWorkers, the thread pool of
+ *                             MUD_packHists and MUD_sumHists
  */
 
 #include <stdio.h>
@@ -33,6 +40,15 @@
 
 #include "mud.h"
 
+#if defined(_WIN32) && !defined(MUD_NO_THREADS)
+#define MUD_NO_THREADS
+#endif /* _WIN32 */
+
+#ifndef MUD_NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif /* !MUD_NO_THREADS */
+
 
 /* 
  *  GMF_TIME - FORTRAN/C time interface by Michael Montour. Last
@@ -99,3 +115,475 @@ GMF_LOCALTIME( TIME *in, INT32 *out )
   out[5] = Tm->tm_sec;
 }
 
+
+
+/*
+ *  Allocate n bytes of zeroed memory (the zalloc macro), counting
+ *  them in the current handle's MUD_STATS.
+ */
+void*
+MUD_zalloc( size_t n )
+{
+    void* p;
+
+    p = malloc( n );
+    if( p == NULL ) return( NULL );
+
+    _stat_add( nAllocs, 1 );
+    _stat_add( bytesAlloc, n );
+
+    return( memset( p, 0, n ) );
+}
+
+
+/*
+ *  Monotonic time in ns, for the timing counters of MUD_STATS.
+ */
+UINT64
+MUD_nsec( void )
+{
+    struct timespec ts;
+
+#ifdef _WIN32
+    timespec_get( &ts, TIME_UTC );
+#else
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+#endif /* _WIN32 */
+
+    return( (UINT64)ts.tv_sec*1000000000 + (UINT64)ts.tv_nsec );
+}
+
+
+/*
+ *  Lock shared by all threads, around changes to the library's global
+ *  lists (live string arenas, friendly file handles), and to the job
+ *  shared by the workers of MUD_runWorkers.  Not to be held while
+ *  reading or decoding.
+ */
+#ifndef MUD_NO_THREADS
+static pthread_mutex_t mud_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif /* !MUD_NO_THREADS */
+
+void
+MUD_lock( void )
+{
+#ifndef MUD_NO_THREADS
+    pthread_mutex_lock( &mud_lock );
+#endif /* !MUD_NO_THREADS */
+}
+
+void
+MUD_unlock( void )
+{
+#ifndef MUD_NO_THREADS
+    pthread_mutex_unlock( &mud_lock );
+#endif /* !MUD_NO_THREADS */
+}
+
+
+/*
+ *  Run fn( arg ) on nThreads threads at once (< 1: one per processor),
+ *  but no more than nMax, the calling thread being one of them, and
+ *  return when all have returned.  The workers share arg, and take
+ *  their part of the job from it under MUD_lock.  If threads cannot be
+ *  started, fewer run.  Built with MUD_NO_THREADS, or on _WIN32, fn is
+ *  called just once.
+ *
+ *  Returns the number of threads that ran fn.
+ */
+int
+MUD_runWorkers( MUD_WORKER fn, void* arg, int nThreads, int nMax )
+{
+#ifndef MUD_NO_THREADS
+    pthread_t* pThreads;
+    int i, n;
+
+    if( nThreads < 1 ) nThreads = (int)sysconf( _SC_NPROCESSORS_ONLN );
+    nThreads = _max( 1, _min( nThreads, nMax ) );
+
+    /*
+     *  Start the workers, and be one of them
+     */
+    n = 0;
+    pThreads = (pthread_t*)zalloc( nThreads*sizeof( pthread_t ) );
+    if( pThreads != NULL )
+    {
+	for( n = 0; n < nThreads - 1; n++ )
+	{
+	    if( pthread_create( &pThreads[n], NULL, fn, arg ) != 0 ) break;
+	}
+    }
+    fn( arg );
+    for( i = 0; i < n; i++ ) pthread_join( pThreads[i], NULL );
+
+    _free( pThreads );
+
+    return( n + 1 );
+#else
+    fn( arg );
+
+    return( 1 );
+#endif /* !MUD_NO_THREADS */
+}
+
+
+/*
+ *  String arenas
+ *
+ *  Strings are packed into blocks of at least MUD_STR_BLOCK bytes.  An
+ *  interning arena also keeps an open-addressed hash table of the
+ *  strings of up to MUD_STR_INTERN_MAX characters it holds.  The blocks
+ *  of all live arenas are listed in a table sorted by address, so that
+ *  MUD_strFree() can tell their strings from allocated ones.
+ *
+ *  The table is changed under MUD_lock, but looked up without it: its
+ *  sequence number is odd while it is being changed, and a lookup that
+ *  saw it change is made again.  A table outgrown is kept, not freed,
+ *  as a lookup may still be reading it; each is at most half the size
+ *  of the next.
+ */
+#define MUD_STR_BLOCK	4096
+
+typedef struct _MUD_STR_BLOCK_HDR {
+    struct _MUD_STR_BLOCK_HDR* pNext;
+    char* end;			/* end of this block */
+    char* free;			/* first free byte */
+} MUD_STR_BLOCK_HDR;
+
+struct _MUD_STR_ARENA {
+    MUD_STR_BLOCK_HDR* pBlock;		/* blocks, newest first */
+    char** pIntern;			/* interned strings, or NULL */
+    int nIntern;			/* strings in pIntern */
+    int sizeIntern;			/* slots in pIntern (power of 2) */
+};
+
+/* arena used by decode_str on this thread, if any */
+MUD_THREAD_LOCAL MUD_STR_ARENA* pMUD_strArena = NULL;
+
+typedef struct {
+    char* start;			/* first string */
+    char* end;				/* end of block */
+} MUD_STR_RANGE;
+
+typedef struct _MUD_STR_RANGES {
+    struct _MUD_STR_RANGES* pOld;	/* table outgrown */
+    int num;				/* blocks listed */
+    int size;				/* room for */
+    MUD_STR_RANGE range[1];		/* blocks, by address */
+} MUD_STR_RANGES;
+
+/* blocks of the live arenas of all threads */
+static MUD_STR_RANGES* pMUD_strRanges = NULL;
+static UINT32 seqMUD_strRanges = 0;
+
+#if defined(__GNUC__) && !defined(MUD_NO_THREADS)
+#define _load( x )		__atomic_load_n( &(x), __ATOMIC_ACQUIRE )
+#define _store( x, v )		__atomic_store_n( &(x), (v), __ATOMIC_RELEASE )
+#define _fence()		__atomic_thread_fence( __ATOMIC_ACQ_REL )
+#define _get( x )		__atomic_load_n( &(x), __ATOMIC_RELAXED )
+#define _set( x, v )		__atomic_store_n( &(x), (v), __ATOMIC_RELAXED )
+#define MUD_STR_LOCK_FREE
+#else
+#define _load( x )		(x)
+#define _store( x, v )		(x) = (v)
+#define _fence()
+#define _get( x )		(x)
+#define _set( x, v )		(x) = (v)
+#endif /* __GNUC__ */
+
+
+static UINT32
+str_hash( char* s, int len )
+{
+    UINT32 h = 2166136261u;	/* FNV-1a */
+    int i;
+
+    for( i = 0; i < len; i++ ) h = ( h ^ (UINT8)s[i] )*16777619u;
+
+    return( h );
+}
+
+
+/*
+ *  Index of the last block at or below s in pRanges, or -1
+ */
+static int
+str_find( MUD_STR_RANGES* pRanges, char* s )
+{
+    int lo = 0, hi, mid;
+
+    hi = _min( _get( pRanges->num ), pRanges->size );
+    while( lo < hi )
+    {
+	mid = ( lo + hi )/2;
+	if( _get( pRanges->range[mid].start ) <= s ) lo = mid+1;
+	else hi = mid;
+    }
+
+    return( lo-1 );
+}
+
+
+/*
+ *  List (add) or unlist (!add) a block, under MUD_lock
+ */
+static BOOL
+str_list( MUD_STR_BLOCK_HDR* pBlock, BOOL add )
+{
+    MUD_STR_RANGES* pRanges = pMUD_strRanges;
+    MUD_STR_RANGES* pNew;
+    int i, j;
+
+    if( add && ( ( pRanges == NULL ) || ( pRanges->num == pRanges->size ) ) )
+    {
+	i = ( pRanges == NULL ) ? 64 : 2*pRanges->size;
+	pNew = (MUD_STR_RANGES*)zalloc( sizeof( MUD_STR_RANGES ) +
+					( i-1 )*sizeof( MUD_STR_RANGE ) );
+	if( pNew == NULL ) return( FALSE );
+	pNew->size = i;
+	if( pRanges != NULL )
+	{
+	    pNew->num = pRanges->num;
+	    bcopy( pRanges->range, pNew->range, pRanges->num*sizeof( MUD_STR_RANGE ) );
+	}
+	pNew->pOld = pRanges;
+	_store( pMUD_strRanges, pNew );
+	pRanges = pNew;
+    }
+    if( pRanges == NULL ) return( FALSE );
+
+    i = str_find( pRanges, (char*)( pBlock + 1 ) );
+
+    _store( seqMUD_strRanges, seqMUD_strRanges+1 );
+    _fence();
+    if( add )
+    {
+	for( j = pRanges->num; j > i+1; j-- )
+	{
+	    _set( pRanges->range[j].start, pRanges->range[j-1].start );
+	    _set( pRanges->range[j].end, pRanges->range[j-1].end );
+	}
+	_set( pRanges->range[i+1].start, (char*)( pBlock + 1 ) );
+	_set( pRanges->range[i+1].end, pBlock->end );
+	_set( pRanges->num, pRanges->num+1 );
+    }
+    else if( ( i >= 0 ) && ( pRanges->range[i].start == (char*)( pBlock + 1 ) ) )
+    {
+	for( j = i; j < pRanges->num-1; j++ )
+	{
+	    _set( pRanges->range[j].start, pRanges->range[j+1].start );
+	    _set( pRanges->range[j].end, pRanges->range[j+1].end );
+	}
+	_set( pRanges->num, pRanges->num-1 );
+    }
+    _store( seqMUD_strRanges, seqMUD_strRanges+1 );
+
+    return( TRUE );
+}
+
+
+static char*
+str_store( MUD_STR_ARENA* pArena, char* s, int len )
+{
+    MUD_STR_BLOCK_HDR* pBlock;
+    size_t size;
+    char* p;
+
+    pBlock = pArena->pBlock;
+    if( ( pBlock == NULL ) || ( pBlock->end - pBlock->free < len+1 ) )
+    {
+	size = _max( MUD_STR_BLOCK, len+1 );
+	pBlock = (MUD_STR_BLOCK_HDR*)malloc( sizeof( MUD_STR_BLOCK_HDR ) + size );
+	if( pBlock == NULL ) return( NULL );
+	pBlock->free = (char*)( pBlock + 1 );
+	pBlock->end = pBlock->free + size;
+	MUD_lock();
+	if( !str_list( pBlock, TRUE ) )
+	{
+	    MUD_unlock();
+	    free( pBlock );
+	    return( NULL );
+	}
+	MUD_unlock();
+	_stat_add( nAllocs, 1 );
+	_stat_add( bytesAlloc, sizeof( MUD_STR_BLOCK_HDR ) + size );
+	pBlock->pNext = pArena->pBlock;
+	pArena->pBlock = pBlock;
+    }
+
+    p = pBlock->free;
+    bcopy( s, p, len );
+    p[len] = '\0';
+    pBlock->free += len+1;
+
+    return( p );
+}
+
+
+static BOOL
+str_grow( MUD_STR_ARENA* pArena )
+{
+    char** pOld;
+    int sizeOld;
+    int i, j;
+
+    pOld = pArena->pIntern;
+    sizeOld = pArena->sizeIntern;
+
+    pArena->sizeIntern = ( sizeOld == 0 ) ? 64 : 2*sizeOld;
+    pArena->pIntern = (char**)zalloc( pArena->sizeIntern*sizeof( char* ) );
+    if( pArena->pIntern == NULL )
+    {
+	pArena->pIntern = pOld;
+	pArena->sizeIntern = sizeOld;
+	return( FALSE );
+    }
+
+    for( i = 0; i < sizeOld; i++ )
+    {
+	if( pOld[i] == NULL ) continue;
+	j = str_hash( pOld[i], strlen( pOld[i] ) ) & ( pArena->sizeIntern - 1 );
+	while( pArena->pIntern[j] != NULL ) j = ( j+1 ) & ( pArena->sizeIntern - 1 );
+	pArena->pIntern[j] = pOld[i];
+    }
+    _free( pOld );
+
+    return( TRUE );
+}
+
+
+/*
+ *  Return a new, empty arena, which interns short strings if intern
+ *  is TRUE, or NULL.
+ */
+MUD_STR_ARENA*
+MUD_newStrArena( BOOL intern )
+{
+    MUD_STR_ARENA* pArena;
+
+    pArena = (MUD_STR_ARENA*)zalloc( sizeof( MUD_STR_ARENA ) );
+    if( pArena == NULL ) return( NULL );
+
+    if( intern && !str_grow( pArena ) )
+    {
+	free( pArena );
+	return( NULL );
+    }
+
+    return( pArena );
+}
+
+
+/*
+ *  Free an arena and all its strings
+ */
+void
+MUD_freeStrArena( MUD_STR_ARENA* pArena )
+{
+    MUD_STR_BLOCK_HDR* pBlock;
+
+    if( pArena == NULL ) return;
+
+    if( pMUD_strArena == pArena ) pMUD_strArena = NULL;
+
+    MUD_lock();
+    for( pBlock = pArena->pBlock; pBlock != NULL; pBlock = pBlock->pNext )
+    {
+	str_list( pBlock, FALSE );
+    }
+    MUD_unlock();
+
+    while( pArena->pBlock != NULL )
+    {
+	pBlock = pArena->pBlock;
+	pArena->pBlock = pBlock->pNext;
+	free( pBlock );
+    }
+    _free( pArena->pIntern );
+    free( pArena );
+}
+
+
+/*
+ *  Return a copy of the first len characters of s (up to a '\0'), in
+ *  pMUD_strArena if set, or else newly allocated.
+ */
+char*
+MUD_strDecode( char* s, int len )
+{
+    MUD_STR_ARENA* pArena = pMUD_strArena;
+    char* p;
+    int n, j;
+
+    for( n = 0; ( n < len ) && ( s[n] != '\0' ); n++ ) ;
+
+    if( pArena == NULL )
+    {
+	p = (char*)zalloc( len+1 );
+	if( p != NULL ) bcopy( s, p, n );
+	return( p );
+    }
+
+    if( ( pArena->pIntern == NULL ) || ( n > MUD_STR_INTERN_MAX ) )
+    {
+	return( str_store( pArena, s, n ) );
+    }
+
+    if( ( 2*( pArena->nIntern+1 ) > pArena->sizeIntern ) && !str_grow( pArena ) )
+    {
+	return( str_store( pArena, s, n ) );
+    }
+
+    /*
+     *  Look for the string, and add it if not there
+     */
+    j = str_hash( s, n ) & ( pArena->sizeIntern - 1 );
+    while( ( p = pArena->pIntern[j] ) != NULL )
+    {
+	if( ( strncmp( p, s, n ) == 0 ) && ( p[n] == '\0' ) ) return( p );
+	j = ( j+1 ) & ( pArena->sizeIntern - 1 );
+    }
+
+    p = str_store( pArena, s, n );
+    if( p == NULL ) return( NULL );
+
+    pArena->pIntern[j] = p;
+    pArena->nIntern++;
+
+    return( p );
+}
+
+
+/*
+ *  Free a string, unless it belongs to a live arena.  Only the table of
+ *  arena blocks is looked at, and, built with GCC or clang, without
+ *  taking MUD_lock.
+ */
+void
+MUD_strFree( char* s )
+{
+    MUD_STR_RANGES* pRanges;
+    BOOL held;
+    UINT32 seq;
+    int i;
+
+#ifndef MUD_STR_LOCK_FREE
+    MUD_lock();
+#endif /* !MUD_STR_LOCK_FREE */
+    do
+    {
+	seq = _load( seqMUD_strRanges );
+	held = FALSE;
+	pRanges = _load( pMUD_strRanges );
+	if( ( seq & 1 ) || ( pRanges == NULL ) ) continue;
+
+	i = str_find( pRanges, s );
+	held = ( i >= 0 ) && ( s < _get( pRanges->range[i].end ) );
+	_fence();
+    } while( ( seq & 1 ) || ( _load( seqMUD_strRanges ) != seq ) );
+#ifndef MUD_STR_LOCK_FREE
+    MUD_unlock();
+#endif /* !MUD_STR_LOCK_FREE */
+
+    if( !held ) free( s );
+}
@@ -0,0 +1,98 @@
+/*
+ *  mud_pack.c -- pack many histograms at once
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *          19-Oct-2026  agent  Threads from MUD_runWorkers
+ *
+ *  Description:
+ *    MUD_packHists() packs (bytesPerBin 0) nHists histograms of nBins[i]
+ *    4-byte bins ppIn[i], as MUD_SEC_GEN_HIST_pack(), on a pool of
+ *    threads (MUD_runWorkers) which take the histograms one at a time.
+ *    Each ppOut[i] is allocated (as by MUD_setHistData) and pNBytes[i]
+ *    set to its packed size; a histogram that cannot be packed (no
+ *    memory) is left with ppOut[i] NULL.  The number packed is returned.
+ *
+ *    nThreads < 1 means one per processor.  Built with MUD_NO_THREADS, or
+ *    on _WIN32, the histograms are packed one after the other.  A trace
+ *    hook is called from the worker threads.
+ */
+
+#include "mud.h"
+
+typedef struct {
+    int nHists;
+    UINT32* nBins;
+    UINT32** ppIn;
+    caddr_t* ppOut;
+    UINT32* pNBytes;
+    int next;			/* next histogram to pack */
+    int nPacked;
+} PACK_JOB;
+
+static void* pack_worker _ANSI_ARGS_(( void* pArg ));
+
+
+static void*
+pack_worker( void* pArg )
+{
+    PACK_JOB* pJob = (PACK_JOB*)pArg;
+    caddr_t pOut;
+    int i, n = 0;
+
+    for( ;; )
+    {
+	MUD_lock();
+	i = pJob->next++;
+	MUD_unlock();
+	if( i >= pJob->nHists ) break;
+
+	pOut = (caddr_t)zalloc( 4*(size_t)pJob->nBins[i] + 32 );
+	pJob->ppOut[i] = pOut;
+	if( pOut == NULL ) continue;
+
+	pJob->pNBytes[i] = MUD_SEC_GEN_HIST_pack( pJob->nBins[i], 4, pJob->ppIn[i],
+						  0, pOut );
+	n++;
+    }
+
+    MUD_lock();
+    pJob->nPacked += n;
+    MUD_unlock();
+
+    return( NULL );
+}
+
+
+int
+MUD_packHists( int nHists, UINT32* nBins, UINT32** ppIn, caddr_t* ppOut,
+	       UINT32* pNBytes, int nThreads )
+{
+    PACK_JOB job;
+
+    if( nHists < 1 ) return( 0 );
+
+    job.nHists = nHists;
+    job.nBins = nBins;
+    job.ppIn = ppIn;
+    job.ppOut = ppOut;
+    job.pNBytes = pNBytes;
+    job.next = 0;
+    job.nPacked = 0;
+
+    MUD_runWorkers( pack_worker, &job, nThreads, nHists );
+
+    return( job.nPacked );
+}
@@ -0,0 +1,236 @@
+/*
+ *  mud_sum.c -- sum histograms over many runs
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *          19-Oct-2026  agent  Histograms of zigzag deltas (MUD_BIN_SIZE_DELTA)
+ *          19-Oct-2026  agent  Unpack into per-worker sums, locking once
+ *          19-Oct-2026  agent  Threads from MUD_runWorkers
+ *          19-Oct-2026  agent  Add only data that are their bins (nBytes)
+ *
+ *  Description:
+ *    MUD_sumHists() adds histograms nums[0..nHists-1] of each of nFiles
+ *    runs into pSum, a row of nBins UINT64 per histogram, which the caller
+ *    zeroes.  Only the histogram group of each run is read (found through
+ *    the member index of the file group), one run at a time per worker
+ *    thread (MUD_runWorkers), so the memory needed does not grow with
+ *    the number of runs.  Each worker unpacks the runs it reads straight
+ *    into its own rows of UINT64 sums, and adds them to pSum, under
+ *    MUD_lock, once it is done.
+ *
+ *    A run is skipped, with pOK[i] FALSE, if it cannot be read or any of
+ *    its selected histograms are missing or do not have nBins bins.  The
+ *    number of runs added is returned.
+ *
+ *    nThreads < 1 means one per processor.  Built with MUD_NO_THREADS, or
+ *    on _WIN32, runs are read one after the other.  The friendly
+ *    interface counters (MUD_getStats) and string arena are not used
+ *    while summing; a trace hook is called from the worker threads.
+ */
+
+#include "mud.h"
+
+typedef struct {
+    char** filenames;
+    int nFiles;
+    int* nums;
+    int nHists;
+    int nBins;
+    UINT64* pSum;
+    BOOL* pOK;
+    int next;			/* next run to read */
+    int nSummed;
+} SUM_JOB;
+
+static MUD_SEC_GRP* sum_readHistGrp _ANSI_ARGS_(( FILE* fin ));
+static BOOL sum_run _ANSI_ARGS_(( SUM_JOB* pJob, char* filename, UINT64* pRows ));
+static void* sum_worker _ANSI_ARGS_(( void* pArg ));
+
+
+/*
+ *  Read the histogram group of the run open as fin, with its members,
+ *  skipping the rest of the run.
+ */
+static MUD_SEC_GRP*
+sum_readHistGrp( FILE* fin )
+{
+    MUD_SEC_GRP* pFile;
+    MUD_SEC_GRP* pGrp = NULL;
+    MUD_INDEX* pIndex;
+    UINT32 grpID;
+    long pos;
+
+    pFile = (MUD_SEC_GRP*)MUD_read( fin, MUD_ONE );
+    if( pFile == NULL ) return( NULL );
+    if( MUD_secID( pFile ) != MUD_SEC_GRP_ID )
+    {
+	MUD_free( pFile );
+	return( NULL );
+    }
+
+    grpID = ( MUD_instanceID( pFile ) == MUD_FMT_TRI_TI_ID ) ?
+	    MUD_GRP_TRI_TI_HIST_ID : MUD_GRP_TRI_TD_HIST_ID;
+    pos = ftell( fin );
+
+    for( pIndex = pFile->pMemIndex; pIndex != NULL; pIndex = pIndex->pNext )
+    {
+	if( ( pIndex->secID == MUD_SEC_GRP_ID ) && ( pIndex->instanceID == grpID ) )
+	{
+	    if( fseek( fin, pos + pIndex->offset, 0 ) == 0 )
+		pGrp = (MUD_SEC_GRP*)MUD_read( fin, MUD_GRP );
+	    break;
+	}
+    }
+
+    MUD_free( pFile );
+
+    if( ( pGrp != NULL ) && ( ( MUD_secID( pGrp ) != MUD_SEC_GRP_ID ) ||
+			      ( MUD_instanceID( pGrp ) != grpID ) ) )
+    {
+	MUD_free( pGrp );
+	pGrp = NULL;
+    }
+
+    return( pGrp );
+}
+
+
+/*
+ *  Add the selected histograms of one run to pRows (nHists*nBins), if
+ *  they are all there to add.
+ */
+static BOOL
+sum_run( SUM_JOB* pJob, char* filename, UINT64* pRows )
+{
+    FILE* fin;
+    MUD_SEC_GRP* pGrp;
+    MUD_SEC_GEN_HIST_HDR** ppHdr;
+    MUD_SEC_GEN_HIST_DAT** ppDat;
+    BOOL ok;
+    int i;
+
+    fin = MUD_openInput( filename );
+    if( fin == NULL ) return( FALSE );
+    pGrp = sum_readHistGrp( fin );
+    fclose( fin );
+    if( pGrp == NULL ) return( FALSE );
+
+    ppHdr = (MUD_SEC_GEN_HIST_HDR**)zalloc( ( pJob->nHists + 1 )*sizeof( MUD_SEC_GEN_HIST_HDR* ) );
+    ppDat = (MUD_SEC_GEN_HIST_DAT**)zalloc( ( pJob->nHists + 1 )*sizeof( MUD_SEC_GEN_HIST_DAT* ) );
+    ok = ( ppHdr != NULL ) && ( ppDat != NULL );
+
+    /*
+     *  Check them all before adding any
+     */
+    for( i = 0; ok && ( i < pJob->nHists ); i++ )
+    {
+	ppHdr[i] = (MUD_SEC_GEN_HIST_HDR*)MUD_search( pGrp->pMem,
+				MUD_SEC_GEN_HIST_HDR_ID, (UINT32)pJob->nums[i], (UINT32)0 );
+	ppDat[i] = (MUD_SEC_GEN_HIST_DAT*)MUD_search( pGrp->pMem,
+				MUD_SEC_GEN_HIST_DAT_ID, (UINT32)pJob->nums[i], (UINT32)0 );
+	ok = ( ppHdr[i] != NULL ) && ( ppDat[i] != NULL ) &&
+	     ( ppDat[i]->pData != NULL ) &&
+	     ( ppHdr[i]->nBins == (UINT32)pJob->nBins ) &&
+	     ( MUD_SEC_GEN_HIST_dataBytes( pJob->nBins, ppHdr[i]->bytesPerBin,
+					   ppDat[i]->pData, ppDat[i]->nBytes ) >= 0 );
+    }
+
+    for( i = 0; ok && ( i < pJob->nHists ); i++ )
+    {
+	MUD_SEC_GEN_HIST_unpackRebin( pJob->nBins, ppHdr[i]->bytesPerBin,
+				      ppDat[i]->pData, ppDat[i]->nBytes, 1,
+				      &pRows[(size_t)i*pJob->nBins] );
+    }
+
+    _free( ppHdr );
+    _free( ppDat );
+    MUD_free( pGrp );
+
+    return( ok );
+}
+
+
+static void*
+sum_worker( void* pArg )
+{
+    SUM_JOB* pJob = (SUM_JOB*)pArg;
+    UINT64* pRows;
+    size_t j, n;
+    int i, nSummed = 0;
+
+    n = (size_t)pJob->nHists*pJob->nBins;
+    pRows = (UINT64*)zalloc( n*sizeof( UINT64 ) );
+
+    for( ;; )
+    {
+	MUD_lock();
+	i = pJob->next++;
+	MUD_unlock();
+	if( i >= pJob->nFiles ) break;
+
+	pJob->pOK[i] = ( pRows != NULL ) &&
+		       sum_run( pJob, pJob->filenames[i], pRows );
+	if( pJob->pOK[i] ) nSummed++;
+    }
+
+    /*
+     *  Simple enough for the compiler to vectorize
+     */
+    if( pRows != NULL )
+    {
+	MUD_lock();
+	for( j = 0; j < n; j++ ) pJob->pSum[j] += pRows[j];
+	pJob->nSummed += nSummed;
+	MUD_unlock();
+    }
+
+    _free( pRows );
+
+    return( NULL );
+}
+
+
+int
+MUD_sumHists( char** filenames, int nFiles, int* nums, int nHists, int nBins,
+	      UINT64* pSum, BOOL* pOK, int nThreads )
+{
+    SUM_JOB job;
+    MUD_STATS* pStats;
+    MUD_STR_ARENA* pArena;
+
+    if( ( nFiles < 0 ) || ( nHists < 0 ) || ( nBins < 0 ) ) return( 0 );
+
+    job.filenames = filenames;
+    job.nFiles = nFiles;
+    job.nums = nums;
+    job.nHists = nHists;
+    job.nBins = nBins;
+    job.pSum = pSum;
+    job.pOK = pOK;
+    job.next = 0;
+    job.nSummed = 0;
+
+    pStats = pMUD_stats;
+    pArena = pMUD_strArena;
+    pMUD_stats = NULL;
+    pMUD_strArena = NULL;
+
+    MUD_runWorkers( sum_worker, &job, nThreads, nFiles );
+
+    pMUD_stats = pStats;
+    pMUD_strArena = pArena;
+
+    return( job.nSummed );
+}
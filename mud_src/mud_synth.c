@@ -0,0 +1,562 @@
+/*
+ *  mud_synth.c -- write synthetic MUD files for testing and benchmarking
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *          19-Oct-2026  agent  bytesPerBin MUD_BIN_SIZE_DELTA
+ *
+ *  Description:
+ *    MUD_writeSynth() writes a TD (MUD_FMT_TRI_TD_ID) or TI
+ *    (MUD_FMT_TRI_TI_ID) run laid out as the friendly interface writes
+ *    them: run description, comments, scalers, independent variables
+ *    (with data arrays in TI runs) and histograms.  Everything is drawn
+ *    from a generator seeded with pSynth->seed, so the same parameters
+ *    always give the same file, on any machine.
+ *
+ *    Histogram counts are Poisson distributed about
+ *
+ *      counts*exp( -(bin - t0_bin)/tau ) + background
+ *
+ *    after t0_bin, and about the background before it (tau of 0 means
+ *    nBins/8), then packed as pSynth->bytesPerBin says (0 for packed,
+ *    MUD_BIN_SIZE_DELTA for zigzag deltas, otherwise 1, 2 or 4,
+ *    saturating).  The file is written a section at a time, with
+ *    MUD_writeGrpStart() etc., so any size up to the 4 GB limit of the
+ *    format needs memory for only one histogram.
+ *
+ *    MUD_synthDefaults() fills in a typical run of either type.
+ *
+ *    Compiled with -DMUD_SYNTH_MAIN this is also the command line tool
+ *    mud_synth; run it with no arguments for usage.
+ */
+
+#include <math.h>
+#include "mud.h"
+
+typedef struct {
+    UINT32 s[2];		/* xorshift64* state, as two words */
+} SYNTH_RNG;
+
+static void synth_seed _ANSI_ARGS_(( SYNTH_RNG* pRng, UINT32 seed ));
+static UINT32 synth_next _ANSI_ARGS_(( SYNTH_RNG* pRng ));
+static double synth_uniform _ANSI_ARGS_(( SYNTH_RNG* pRng ));
+static double synth_gauss _ANSI_ARGS_(( SYNTH_RNG* pRng ));
+static UINT32 synth_poisson _ANSI_ARGS_(( SYNTH_RNG* pRng, double mean ));
+static char* synth_str _ANSI_ARGS_(( char* fmt, UINT32 num ));
+static BOOL synth_hists _ANSI_ARGS_(( FILE* fout, MUD_SEC_GRP* pFile, MUD_SYNTH* pSynth, SYNTH_RNG* pRng ));
+
+static char* synth_titles[] = { "B", "F", "L", "R", "NBMB", "NBMF", "FM", "BM" };
+
+
+/*
+ *  64-bit xorshift* held in two 32-bit words, so that the sequence is
+ *  the same on every platform
+ */
+static void
+synth_seed( SYNTH_RNG* pRng, UINT32 seed )
+{
+    pRng->s[0] = seed ^ 0x9E3779B9;
+    pRng->s[1] = 0x6A09E667;
+    synth_next( pRng );
+}
+
+static UINT32
+synth_next( SYNTH_RNG* pRng )
+{
+    UINT64 x;
+
+    x = ( (UINT64)pRng->s[1] << 32 ) | pRng->s[0];
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    pRng->s[0] = (UINT32)x;
+    pRng->s[1] = (UINT32)( x >> 32 );
+    return( (UINT32)( ( x*0x2545F4914F6CDD1DULL ) >> 32 ) );
+}
+
+static double
+synth_uniform( SYNTH_RNG* pRng )
+{
+    return( ( synth_next( pRng ) + 0.5 )/4294967296.0 );
+}
+
+static double
+synth_gauss( SYNTH_RNG* pRng )
+{
+    double u = synth_uniform( pRng );
+    double v = synth_uniform( pRng );
+
+    return( sqrt( -2.0*log( u ) )*cos( 6.283185307179586*v ) );
+}
+
+/*
+ *  Poisson deviate: by multiplication of uniforms for small means, and
+ *  from the normal approximation for large ones
+ */
+static UINT32
+synth_poisson( SYNTH_RNG* pRng, double mean )
+{
+    double limit, prod, x;
+    UINT32 k;
+
+    if( mean <= 0.0 ) return( 0 );
+
+    if( mean < 30.0 )
+    {
+	limit = exp( -mean );
+	prod = synth_uniform( pRng );
+	for( k = 0; prod > limit; k++ ) prod *= synth_uniform( pRng );
+	return( k );
+    }
+
+    x = floor( mean + sqrt( mean )*synth_gauss( pRng ) + 0.5 );
+    if( x < 0.0 ) return( 0 );
+    if( x > 4294967295.0 ) return( 0xFFFFFFFF );
+    return( (UINT32)x );
+}
+
+static char*
+synth_str( char* fmt, UINT32 num )
+{
+    char str[64];
+
+    sprintf( str, fmt, (unsigned long)num );
+    return( strdup( str ) );
+}
+
+
+void
+MUD_synthDefaults( MUD_SYNTH* pSynth, UINT32 type )
+{
+    bzero( pSynth, sizeof( MUD_SYNTH ) );
+
+    pSynth->type = type;
+    pSynth->seed = 1;
+    pSynth->bytesPerBin = 4;
+    pSynth->nComments = 2;
+    pSynth->nScalers = 8;
+
+    switch( type )
+    {
+	case MUD_FMT_TRI_TI_ID:
+	    pSynth->nHists = 8;
+	    pSynth->nBins = 1024;
+	    pSynth->counts = 1000.0;
+	    pSynth->tau = 1.0e6;		/* flat */
+	    pSynth->background = 100.0;
+	    pSynth->nIndVars = 4;
+	    pSynth->nIndVarData = 256;
+	    break;
+	case MUD_FMT_TRI_TD_ID:
+	default:
+	    pSynth->nHists = 4;
+	    pSynth->nBins = 4096;
+	    pSynth->counts = 1.0e4;
+	    pSynth->tau = 0.0;			/* nBins/8 */
+	    pSynth->background = 10.0;
+	    pSynth->nIndVars = 6;
+	    pSynth->nIndVarData = 0;
+	    break;
+    }
+}
+
+
+/*
+ *  Write the histogram group, one histogram at a time
+ */
+static BOOL
+synth_hists( FILE* fout, MUD_SEC_GRP* pFile, MUD_SYNTH* pSynth,
+	     SYNTH_RNG* pRng )
+{
+    MUD_SEC_GRP* pGrp;
+    MUD_SEC_GEN_HIST_HDR* pHdr;
+    MUD_SEC_GEN_HIST_DAT* pDat;
+    UINT32* pData;
+    UINT32 max, t0_bin;
+    double mean, events, tau;
+    int i, j, binSize;
+    char title[32];
+    BOOL ok = TRUE;
+
+    binSize = pSynth->bytesPerBin;
+    max = ( binSize == 1 ) ? 0xFF : ( binSize == 2 ) ? 0xFFFF : 0xFFFFFFFF;
+    t0_bin = pSynth->nBins/20;
+    tau = ( pSynth->tau > 0.0 ) ? pSynth->tau : pSynth->nBins/8.0;
+
+    pData = (UINT32*)zalloc( 4*pSynth->nBins + 4 );
+    if( pData == NULL ) return( FALSE );
+
+    pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID,
+				  ( pSynth->type == MUD_FMT_TRI_TI_ID ) ?
+				  MUD_GRP_TRI_TI_HIST_ID : MUD_GRP_TRI_TD_HIST_ID );
+    ok = MUD_writeGrpStart( fout, pFile, pGrp, 2*pSynth->nHists );
+
+    for( i = 0; ok && ( i < pSynth->nHists ); i++ )
+    {
+	events = 0.0;
+	for( j = 0; j < pSynth->nBins; j++ )
+	{
+	    mean = pSynth->background;
+	    if( j >= t0_bin )
+		mean += pSynth->counts*exp( -( j - (double)t0_bin )/tau );
+	    pData[j] = synth_poisson( pRng, mean );
+	    if( pData[j] > max ) pData[j] = max;
+	    events += pData[j];
+	}
+
+	pHdr = (MUD_SEC_GEN_HIST_HDR*)MUD_new( MUD_SEC_GEN_HIST_HDR_ID, i+1 );
+	pDat = (MUD_SEC_GEN_HIST_DAT*)MUD_new( MUD_SEC_GEN_HIST_DAT_ID, i+1 );
+
+	sprintf( title, "%s%c", synth_titles[(i/2)%8], ( i%2 ) ? '-' : '+' );
+	if( i >= 16 ) sprintf( title + strlen( title ), "%d", i/16 );
+	pHdr->title = strdup( title );
+	pHdr->histType = ( pSynth->type == MUD_FMT_TRI_TI_ID ) ?
+			 MUD_SEC_TRI_TI_HIST_ID : MUD_SEC_TRI_TD_HIST_ID;
+	pHdr->nBins = pSynth->nBins;
+	pHdr->bytesPerBin = binSize;
+	pHdr->fsPerBin = 390625;
+	pHdr->t0_bin = t0_bin;
+	pHdr->t0_ps = (UINT32)( t0_bin*390.625 );
+	pHdr->goodBin1 = t0_bin + 1;
+	pHdr->goodBin2 = pSynth->nBins - 1;
+	pHdr->bkgd1 = 1;
+	pHdr->bkgd2 = ( t0_bin > 2 ) ? t0_bin - 2 : 1;
+	pHdr->nEvents = ( events > 4294967295.0 ) ? 0xFFFFFFFF : (UINT32)events;
+
+	pDat->pData = (caddr_t)zalloc( _delta_max_bytes( pSynth->nBins ) + 32 );
+	pDat->nBytes = pHdr->nBytes =
+	    MUD_SEC_GEN_HIST_pack( pSynth->nBins, 4, pData, binSize, pDat->pData );
+
+	ok = MUD_writeGrpMem( fout, pGrp, pHdr ) &&
+	     MUD_writeGrpMem( fout, pGrp, pDat );
+
+	MUD_free( pHdr );
+	MUD_free( pDat );
+    }
+
+    ok = ok && MUD_writeGrpEnd( fout, pGrp );
+
+    MUD_free( pGrp );
+    free( pData );
+    return( ok );
+}
+
+
+BOOL
+MUD_writeSynth( char* filename, MUD_SYNTH* pSynth )
+{
+    SYNTH_RNG rng;
+    FILE* fout;
+    MUD_SEC_GRP* pFile;
+    MUD_SEC_GRP* pGrp;
+    MUD_SEC_GEN_RUN_DESC* pDesc = NULL;
+    MUD_SEC_TRI_TI_RUN_DESC* pIdesc = NULL;
+    MUD_SEC_CMT* pCmt;
+    MUD_SEC_GEN_SCALER* pScal;
+    MUD_SEC_GEN_IND_VAR* pVar;
+    MUD_SEC_GEN_ARRAY* pArray;
+    TIME timeBegin;
+    UINT32 elapsedSec;
+    double x, sum, sum2, sum3, sd;
+    int i, j, num;
+    BOOL ti, ok;
+
+    if( ( pSynth->nHists < 0 ) || ( pSynth->nBins < 1 ) ||
+	( ( pSynth->bytesPerBin != 0 ) && ( pSynth->bytesPerBin != 1 ) &&
+	  ( pSynth->bytesPerBin != 2 ) && ( pSynth->bytesPerBin != 4 ) &&
+	  ( pSynth->bytesPerBin != MUD_BIN_SIZE_DELTA ) ) ||
+	( pSynth->tau < 0.0 ) || ( pSynth->nComments < 0 ) ||
+	( pSynth->nScalers < 0 ) || ( pSynth->nIndVars < 0 ) ||
+	( pSynth->nIndVarData < 0 ) )
+	return( FALSE );
+
+    ti = ( pSynth->type == MUD_FMT_TRI_TI_ID );
+    synth_seed( &rng, pSynth->seed );
+    timeBegin = 1500000000 + synth_next( &rng )%100000000;
+    elapsedSec = 600 + synth_next( &rng )%3000;
+
+    fout = MUD_openOutput( filename );
+    if( fout == NULL ) return( FALSE );
+
+    num = 1 + ( pSynth->nComments > 0 ) + ( pSynth->nScalers > 0 ) +
+	  ( pSynth->nIndVars > 0 ) + ( pSynth->nHists > 0 );
+    pFile = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, pSynth->type );
+    ok = MUD_writeGrpStart( fout, NULL, pFile, num );
+
+    /*
+     *  Run description
+     */
+    if( ti )
+    {
+	pIdesc = (MUD_SEC_TRI_TI_RUN_DESC*)MUD_new( MUD_SEC_TRI_TI_RUN_DESC_ID, 1 );
+	pIdesc->exptNumber = 1000 + synth_next( &rng )%1000;
+	pIdesc->runNumber = 40000 + pSynth->seed%10000;
+	pIdesc->timeBegin = timeBegin;
+	pIdesc->elapsedSec = elapsedSec;
+	pIdesc->timeEnd = timeBegin + pIdesc->elapsedSec;
+	pIdesc->title = synth_str( "Synthetic TI run, seed %lu", pSynth->seed );
+	pIdesc->lab = strdup( "TRIUMF" );
+	pIdesc->area = strdup( "BNQR" );
+	pIdesc->method = strdup( "TI-bNMR" );
+	pIdesc->apparatus = strdup( "synthetic" );
+	pIdesc->insert = strdup( "none" );
+	pIdesc->sample = synth_str( "Sample %lu", synth_next( &rng )%100 );
+	pIdesc->orient = strdup( "(001)" );
+	pIdesc->das = strdup( "mud_synth" );
+	pIdesc->experimenter = strdup( "nobody" );
+	pIdesc->subtitle = strdup( "subtitle" );
+	pIdesc->comment1 = strdup( "comment 1" );
+	pIdesc->comment2 = strdup( "comment 2" );
+	pIdesc->comment3 = strdup( "comment 3" );
+	ok = ok && MUD_writeGrpMem( fout, pFile, pIdesc );
+	MUD_free( pIdesc );
+    }
+    else
+    {
+	pDesc = (MUD_SEC_GEN_RUN_DESC*)MUD_new( MUD_SEC_GEN_RUN_DESC_ID, 1 );
+	pDesc->exptNumber = 1000 + synth_next( &rng )%1000;
+	pDesc->runNumber = 40000 + pSynth->seed%10000;
+	pDesc->timeBegin = timeBegin;
+	pDesc->elapsedSec = elapsedSec;
+	pDesc->timeEnd = timeBegin + pDesc->elapsedSec;
+	pDesc->title = synth_str( "Synthetic TD run, seed %lu", pSynth->seed );
+	pDesc->lab = strdup( "TRIUMF" );
+	pDesc->area = strdup( "BNMR" );
+	pDesc->method = strdup( "TD-bNMR" );
+	pDesc->apparatus = strdup( "synthetic" );
+	pDesc->insert = strdup( "none" );
+	pDesc->sample = synth_str( "Sample %lu", synth_next( &rng )%100 );
+	pDesc->orient = strdup( "(001)" );
+	pDesc->das = strdup( "mud_synth" );
+	pDesc->experimenter = strdup( "nobody" );
+	pDesc->temperature = synth_str( "%lu K", 5 + synth_next( &rng )%295 );
+	pDesc->field = synth_str( "%lu G", synth_next( &rng )%65000 );
+	ok = ok && MUD_writeGrpMem( fout, pFile, pDesc );
+	MUD_free( pDesc );
+    }
+
+    /*
+     *  Comments
+     */
+    if( pSynth->nComments > 0 )
+    {
+	pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_CMT_ID );
+	ok = ok && MUD_writeGrpStart( fout, pFile, pGrp, pSynth->nComments );
+	for( i = 0; ok && ( i < pSynth->nComments ); i++ )
+	{
+	    pCmt = (MUD_SEC_CMT*)MUD_new( MUD_SEC_CMT_ID, i+1 );
+	    pCmt->ID = i+1;
+	    pCmt->prevReplyID = i;
+	    pCmt->nextReplyID = ( i+1 < pSynth->nComments ) ? i+2 : 0;
+	    pCmt->time = timeBegin + 60*i;
+	    pCmt->author = strdup( "mud_synth" );
+	    pCmt->title = synth_str( "Comment %lu", i+1 );
+	    pCmt->comment = synth_str( "Synthetic comment, value %lu",
+				       synth_next( &rng ) );
+	    ok = MUD_writeGrpMem( fout, pGrp, pCmt );
+	    MUD_free( pCmt );
+	}
+	ok = ok && MUD_writeGrpEnd( fout, pGrp );
+	MUD_free( pGrp );
+    }
+
+    /*
+     *  Scalers
+     */
+    if( pSynth->nScalers > 0 )
+    {
+	pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID, MUD_GRP_TRI_TD_SCALER_ID );
+	ok = ok && MUD_writeGrpStart( fout, pFile, pGrp, pSynth->nScalers );
+	for( i = 0; ok && ( i < pSynth->nScalers ); i++ )
+	{
+	    pScal = (MUD_SEC_GEN_SCALER*)MUD_new( MUD_SEC_GEN_SCALER_ID, i+1 );
+	    pScal->label = synth_str( "Scaler %lu", i+1 );
+	    pScal->counts[0] = synth_next( &rng )%100000000;
+	    pScal->counts[1] = synth_next( &rng )%100000;
+	    ok = MUD_writeGrpMem( fout, pGrp, pScal );
+	    MUD_free( pScal );
+	}
+	ok = ok && MUD_writeGrpEnd( fout, pGrp );
+	MUD_free( pGrp );
+    }
+
+    /*
+     *  Independent variables, with arrays of readings in TI runs
+     */
+    if( pSynth->nIndVars > 0 )
+    {
+	BOOL arrays = ti && ( pSynth->nIndVarData > 0 );
+
+	pGrp = (MUD_SEC_GRP*)MUD_new( MUD_SEC_GRP_ID,
+				      arrays ? MUD_GRP_GEN_IND_VAR_ARR_ID : MUD_GRP_GEN_IND_VAR_ID );
+	ok = ok && MUD_writeGrpStart( fout, pFile, pGrp,
+				      ( arrays ? 2 : 1 )*pSynth->nIndVars );
+	for( i = 0; ok && ( i < pSynth->nIndVars ); i++ )
+	{
+	    pVar = (MUD_SEC_GEN_IND_VAR*)MUD_new( MUD_SEC_GEN_IND_VAR_ID, i+1 );
+	    pVar->name = synth_str( "/Synth/Var%lu", i+1 );
+	    pVar->description = synth_str( "Synthetic variable %lu", i+1 );
+	    pVar->units = strdup( "V" );
+	    x = 100.0*synth_uniform( &rng );
+	    sd = 0.1 + synth_uniform( &rng );
+
+	    pArray = NULL;
+	    if( arrays )
+	    {
+		pArray = (MUD_SEC_GEN_ARRAY*)MUD_new( MUD_SEC_GEN_ARRAY_ID, i+1 );
+		pArray->num = pSynth->nIndVarData;
+		pArray->elemSize = 8;
+		pArray->type = 2;
+		pArray->hasTime = TRUE;
+		pArray->nBytes = 8*pArray->num;
+		pArray->pData = (caddr_t)zalloc( pArray->nBytes );
+		pArray->pTime = (TIME*)zalloc( 4*pArray->num );
+
+		sum = sum2 = sum3 = 0.0;
+		pVar->low = pVar->high = x;
+		for( j = 0; j < pArray->num; j++ )
+		{
+		    double v = x + sd*synth_gauss( &rng );
+
+		    ((double*)pArray->pData)[j] = v;
+		    pArray->pTime[j] = timeBegin +
+			(TIME)( (double)j*elapsedSec/pArray->num );
+		    if( v < pVar->low ) pVar->low = v;
+		    if( v > pVar->high ) pVar->high = v;
+		    sum += v;
+		}
+		pVar->mean = sum/pArray->num;
+		for( j = 0; j < pArray->num; j++ )
+		{
+		    double d = ((double*)pArray->pData)[j] - pVar->mean;
+
+		    sum2 += d*d;
+		    sum3 += d*d*d;
+		}
+		pVar->stddev = sqrt( sum2/pArray->num );
+		pVar->skewness = ( pVar->stddev > 0.0 ) ?
+		    sum3/pArray->num/pow( pVar->stddev, 3 ) : 0.0;
+	    }
+	    else
+	    {
+		pVar->mean = x;
+		pVar->stddev = sd;
+		pVar->low = x - 3.0*sd;
+		pVar->high = x + 3.0*sd;
+		pVar->skewness = 0.1*synth_gauss( &rng );
+	    }
+
+	    ok = MUD_writeGrpMem( fout, pGrp, pVar );
+	    if( pArray != NULL ) ok = ok && MUD_writeGrpMem( fout, pGrp, pArray );
+	    MUD_free( pVar );
+	    MUD_free( pArray );
+	}
+	ok = ok && MUD_writeGrpEnd( fout, pGrp );
+	MUD_free( pGrp );
+    }
+
+    /*
+     *  Histograms
+     */
+    if( pSynth->nHists > 0 )
+    {
+	ok = ok && synth_hists( fout, pFile, pSynth, &rng );
+    }
+
+    ok = ok && MUD_writeGrpEnd( fout, pFile ) && MUD_writeEnd( fout );
+    MUD_free( pFile );
+
+    if( fclose( fout ) != 0 ) ok = FALSE;
+    if( !ok ) remove( filename );
+    return( ok );
+}
+
+
+#ifdef MUD_SYNTH_MAIN
+
+static void
+usage( char* prog )
+{
+    fprintf( stderr,
+	"usage: %s [options] file.msr\n"
+	"  -I           TI run (default TD)\n"
+	"  -s seed      random seed\n"
+	"  -h hists     number of histograms\n"
+	"  -n bins      bins per histogram\n"
+	"  -b bytes     bytes per bin: 0 (packed), 1, 2, 4 or 68 (deltas)\n"
+	"  -c counts    counts at t0 (before background)\n"
+	"  -t tau       decay time in bins (0: bins/8)\n"
+	"  -g bkgd      background counts per bin\n"
+	"  -S scalers   number of scalers\n"
+	"  -v ivars     number of independent variables\n"
+	"  -a length    independent variable array length (TI)\n"
+	"  -m comments  number of comments\n", prog );
+    exit( 1 );
+}
+
+int
+main( int argc, char* argv[] )
+{
+    MUD_SYNTH synth;
+    UINT32 type = MUD_FMT_TRI_TD_ID;
+    char* filename = NULL;
+    int i;
+
+    for( i = 1; i < argc; i++ )
+    {
+	if( strcmp( argv[i], "-I" ) == 0 ) type = MUD_FMT_TRI_TI_ID;
+    }
+    MUD_synthDefaults( &synth, type );
+
+    for( i = 1; i < argc; i++ )
+    {
+	char* opt = argv[i];
+
+	if( strcmp( opt, "-I" ) == 0 ) continue;
+	if( opt[0] != '-' )
+	{
+	    if( filename != NULL ) usage( argv[0] );
+	    filename = opt;
+	    continue;
+	}
+	if( ( strlen( opt ) != 2 ) || ( i+1 >= argc ) ) usage( argv[0] );
+
+	switch( opt[1] )
+	{
+	    case 's': synth.seed = strtoul( argv[++i], NULL, 0 ); break;
+	    case 'h': synth.nHists = atoi( argv[++i] ); break;
+	    case 'n': synth.nBins = atoi( argv[++i] ); break;
+	    case 'b': synth.bytesPerBin = atoi( argv[++i] ); break;
+	    case 'c': synth.counts = atof( argv[++i] ); break;
+	    case 't': synth.tau = atof( argv[++i] ); break;
+	    case 'g': synth.background = atof( argv[++i] ); break;
+	    case 'S': synth.nScalers = atoi( argv[++i] ); break;
+	    case 'v': synth.nIndVars = atoi( argv[++i] ); break;
+	    case 'a': synth.nIndVarData = atoi( argv[++i] ); break;
+	    case 'm': synth.nComments = atoi( argv[++i] ); break;
+	    default: usage( argv[0] );
+	}
+    }
+    if( filename == NULL ) usage( argv[0] );
+
+    if( !MUD_writeSynth( filename, &synth ) )
+    {
+	fprintf( stderr, "%s: failed to write %s\n", argv[0], filename );
+	return( 1 );
+    }
+    return( 0 );
+}
+
+#endif /* MUD_SYNTH_MAIN */
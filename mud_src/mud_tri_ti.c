@@ -20,6 +20,7 @@
  *   v1.0a  14-Apr-1994  [T. Whidden] operator -> experimenter
  *   v1.0b  22-Apr-1994  [T. Whidden] rename TI to TRI_TI
  *          25-Nov-2009  DA  Handle 8-byte time_t
+ *          19-Oct-2026  agent  Free strings with _free_str (string arenas)
  */
 
 #include <time.h>
@@ -37,20 +38,20 @@ MUD_SEC_TRI_TI_RUN_DESC_proc( MUD_OPT op, BUF* pBuf, MUD_SEC_TRI_TI_RUN_DESC* pM
     switch( op )
     {
 	case MUD_FREE:
-	    _free( pMUD->title );
-	    _free( pMUD->lab );
-	    _free( pMUD->area );
-	    _free( pMUD->method );
-	    _free( pMUD->apparatus );
-	    _free( pMUD->insert );
-	    _free( pMUD->sample );
-	    _free( pMUD->orient );
-	    _free( pMUD->das );
-	    _free( pMUD->experimenter );
-	    _free( pMUD->subtitle );
-	    _free( pMUD->comment1 );
-	    _free( pMUD->comment2 );
-	    _free( pMUD->comment3 );
+	    _free_str( pMUD->title );
+	    _free_str( pMUD->lab );
+	    _free_str( pMUD->area );
+	    _free_str( pMUD->method );
+	    _free_str( pMUD->apparatus );
+	    _free_str( pMUD->insert );
+	    _free_str( pMUD->sample );
+	    _free_str( pMUD->orient );
+	    _free_str( pMUD->das );
+	    _free_str( pMUD->experimenter );
+	    _free_str( pMUD->subtitle );
+	    _free_str( pMUD->comment1 );
+	    _free_str( pMUD->comment2 );
+	    _free_str( pMUD->comment3 );
 	    break;
 	case MUD_DECODE:
 	    decode_4( pBuf, &pMUD->exptNumber );
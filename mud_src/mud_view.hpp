@@ -0,0 +1,679 @@
+#ifndef _MUD_VIEW_HPP_
+#define _MUD_VIEW_HPP_
+/*
+ *  mud_view.hpp -- typed read-only views of encoded MUD sections (C++17)
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *
+ *  Description:
+ *    Header only; needs nothing from libmud but the IDs in mud.h.
+ *
+ *    A view reads the fields of a section straight from the bytes of a
+ *    MUD file (e.g. read whole, or mapped), when asked for, without
+ *    decoding the section into a struct, allocating or copying.  The
+ *    bytes must outlive the views and the string_views they return.
+ *
+ *        mud::GroupView file = mud::fileView( buf, len );
+ *        auto desc = file.find<MUD_SEC_GEN_RUN_DESC_ID>();
+ *        std::string_view title = desc.title();
+ *
+ *        for( mud::Section sec : file.group( MUD_GRP_TRI_TD_HIST_ID ) )
+ *            if( auto hdr = sec.as<MUD_SEC_GEN_HIST_HDR_ID>() )
+ *                n += hdr.nBins();
+ *
+ *    Fields are at fixed offsets from the start of the section, given by
+ *    the constexpr members of each SectionView<ID>; strings follow the
+ *    fixed fields, each as a 2-byte length and its characters, and the
+ *    k-th is found by stepping over the k before it.  Integers are
+ *    little-endian and reals are VAX F or D floating, as written by
+ *    mud_encode.c, and are converted as it does.
+ *
+ *    A group is followed by its index (MUD_INDEX: offset, secID,
+ *    instanceID of each member) and then by its members, at the offsets
+ *    from the end of the group header (core.size).  Iterating over a
+ *    group gives a Section for each member, in index order.
+ *
+ *    Nothing throws: a view of bytes too short for its section is not
+ *    valid (false), and fields or strings past the end of a section read
+ *    as 0 or empty.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <iterator>
+#include "mud.h"
+
+namespace mud {
+
+namespace detail {
+
+inline std::uint16_t
+le16( const unsigned char* p )
+{
+    return( (std::uint16_t)( p[0] | ( p[1] << 8 ) ) );
+}
+
+inline std::uint32_t
+le32( const unsigned char* p )
+{
+    return( (std::uint32_t)p[0] | ( (std::uint32_t)p[1] << 8 ) |
+	    ( (std::uint32_t)p[2] << 16 ) | ( (std::uint32_t)p[3] << 24 ) );
+}
+
+/*
+ *  VAX F floating to IEEE single, as bdecode_float()
+ */
+inline float
+vaxFloat( const unsigned char* p )
+{
+    std::uint32_t v = le32( p );
+    std::uint32_t sign = ( v >> 15 ) & 1;
+    std::uint32_t exp = ( v >> 7 ) & 0xff;
+    std::uint32_t mant = ( ( v & 0x7f ) << 16 ) | ( v >> 16 );
+    std::uint32_t ieee;
+    float f;
+
+    if( ( exp == 0 ) && ( mant == 0 ) )
+	ieee = 0;					/* Min Vax */
+    else if( ( exp == 0xff ) && ( mant == 0x7fffff ) )
+	ieee = 0xffu << 23;				/* Max Vax */
+    else
+	ieee = ( ( ( exp - 0x81 + 0x7f ) & 0xff ) << 23 ) | mant;
+
+    ieee |= sign << 31;
+    std::memcpy( &f, &ieee, sizeof( f ) );
+    return( f );
+}
+
+/*
+ *  VAX D floating to IEEE double, as bdecode_double()
+ */
+inline double
+vaxDouble( const unsigned char* p )
+{
+    std::uint32_t v0 = le32( p );
+    std::uint32_t v1 = le32( p + 4 );
+    std::uint64_t sign = ( v0 >> 15 ) & 1;
+    std::uint64_t exp = ( v0 >> 7 ) & 0xff;
+    std::uint64_t mant = ( (std::uint64_t)( v0 & 0x7f ) << 48 ) |
+			 ( (std::uint64_t)( v0 >> 16 ) << 32 ) |
+			 ( ( v1 & 0xffff ) << 16 ) | ( v1 >> 16 );
+    std::uint64_t ieee;
+    double d;
+
+    if( ( exp == 0 ) && ( mant == 0 ) )
+	ieee = 0;					/* Min Vax */
+    else if( ( exp == 0xff ) && ( mant == 0x7fffffffffffffull ) )
+	ieee = (std::uint64_t)0x7ff << 52;		/* Max Vax */
+    else
+	ieee = ( ( exp - 0x81 + 0x3ff ) << 52 ) | ( mant >> 3 );
+
+    ieee |= sign << 63;
+    std::memcpy( &d, &ieee, sizeof( d ) );
+    return( d );
+}
+
+} // namespace detail
+
+
+template <std::uint32_t SecID> class SectionView;
+
+
+/*
+ *  Any section: its core, and checked reads of its bytes
+ */
+class Section
+{
+public:
+    static constexpr std::size_t coreSize = 12;
+
+    constexpr Section() noexcept : p_( nullptr ), avail_( 0 ) {}
+
+    /*
+     *  Section starting at p, with avail bytes to the end of the buffer
+     */
+    Section( const void* p, std::size_t avail ) noexcept
+	: p_( (const unsigned char*)p ), avail_( avail )
+    {
+	if( ( p_ == nullptr ) || ( avail_ < coreSize ) ||
+	    ( detail::le32( p_ ) < coreSize ) || ( detail::le32( p_ ) > avail_ ) )
+	{
+	    p_ = nullptr;
+	    avail_ = 0;
+	}
+    }
+
+    bool valid() const noexcept { return( p_ != nullptr ); }
+    explicit operator bool() const noexcept { return( valid() ); }
+
+    std::uint32_t size() const noexcept { return( u32( 0 ) ); }
+    std::uint32_t secID() const noexcept { return( u32( 4 ) ); }
+    std::uint32_t instanceID() const noexcept { return( u32( 8 ) ); }
+
+    const unsigned char* data() const noexcept { return( p_ ); }
+
+    /*
+     *  Typed view of this section; not valid if the secID differs
+     */
+    template <std::uint32_t ID>
+    SectionView<ID> as() const noexcept
+    {
+	if( !valid() || ( secID() != ID ) ) return( SectionView<ID>() );
+	return( SectionView<ID>( p_, avail_ ) );
+    }
+
+protected:
+    std::size_t limit() const noexcept
+    {
+	return( valid() ? detail::le32( p_ ) : 0 );
+    }
+
+    std::uint32_t u32( std::size_t off ) const noexcept
+    {
+	return( ( off + 4 <= limit() ) ? detail::le32( p_ + off ) : 0 );
+    }
+
+    double real64( std::size_t off ) const noexcept
+    {
+	return( ( off + 8 <= limit() ) ? detail::vaxDouble( p_ + off ) : 0.0 );
+    }
+
+    /*
+     *  Offset of the k-th string from off, or limit() if there is none
+     */
+    std::size_t strOffset( std::size_t off, int k ) const noexcept
+    {
+	for( ; ( k > 0 ) && ( off + 2 <= limit() ); k-- )
+	    off += 2 + detail::le16( p_ + off );
+	return( ( ( k == 0 ) && ( off + 2 <= limit() ) ) ? off : limit() );
+    }
+
+    std::string_view str( std::size_t off, int k ) const noexcept
+    {
+	std::size_t len;
+
+	off = strOffset( off, k );
+	if( off + 2 > limit() ) return( std::string_view() );
+	len = detail::le16( p_ + off );
+	if( off + 2 + len > limit() ) return( std::string_view() );
+	return( std::string_view( (const char*)p_ + off + 2, len ) );
+    }
+
+    const unsigned char* p_;
+    std::size_t avail_;
+};
+
+
+/*
+ *  Unknown section IDs: the core only
+ */
+template <std::uint32_t SecID>
+class SectionView : public Section
+{
+public:
+    static constexpr std::uint32_t id = SecID;
+    using Section::Section;
+};
+
+
+/*
+ *  MUD_SEC_FIXED
+ */
+template <>
+class SectionView<MUD_SEC_FIXED_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_FIXED_ID;
+    static constexpr std::size_t offFileSize = 12;
+    static constexpr std::size_t offFormatID = 16;
+    using Section::Section;
+
+    std::uint32_t fileSize() const noexcept { return( u32( offFileSize ) ); }
+    std::uint32_t formatID() const noexcept { return( u32( offFormatID ) ); }
+};
+
+
+/*
+ *  MUD_SEC_GRP: the members, through the index
+ */
+struct IndexEntry
+{
+    std::uint32_t offset;
+    std::uint32_t secID;
+    std::uint32_t instanceID;
+};
+
+template <>
+class SectionView<MUD_SEC_GRP_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GRP_ID;
+    static constexpr std::size_t offNum = 12;
+    static constexpr std::size_t offMemSize = 16;
+    static constexpr std::size_t offIndex = 20;
+    static constexpr std::size_t indexSize = 12;
+    using Section::Section;
+
+    std::uint32_t num() const noexcept { return( u32( offNum ) ); }
+    std::uint32_t memSize() const noexcept { return( u32( offMemSize ) ); }
+
+    /*
+     *  Index entries in the header; fewer than num() if it is cut short
+     */
+    std::uint32_t numIndex() const noexcept
+    {
+	std::size_t n = ( limit() > offIndex ) ? ( limit() - offIndex )/indexSize : 0;
+	return( ( n < num() ) ? (std::uint32_t)n : num() );
+    }
+
+    IndexEntry index( std::uint32_t i ) const noexcept
+    {
+	std::size_t off = offIndex + i*indexSize;
+	return( IndexEntry{ u32( off ), u32( off + 4 ), u32( off + 8 ) } );
+    }
+
+    /*
+     *  i-th member, without reading the others
+     */
+    Section member( std::uint32_t i ) const noexcept
+    {
+	std::size_t off;
+
+	if( i >= numIndex() ) return( Section() );
+	off = limit() + index( i ).offset;
+	if( off >= avail_ ) return( Section() );
+	return( Section( p_ + off, avail_ - off ) );
+    }
+
+    /*
+     *  First member with secID ID and instanceID (any, if 0), from the
+     *  index only
+     */
+    template <std::uint32_t ID>
+    SectionView<ID> find( std::uint32_t instanceID = 0 ) const noexcept
+    {
+	std::uint32_t i, n = numIndex();
+
+	for( i = 0; i < n; i++ )
+	{
+	    IndexEntry e = index( i );
+	    if( ( e.secID == ID ) &&
+		( ( instanceID == 0 ) || ( e.instanceID == instanceID ) ) )
+		return( member( i ).as<ID>() );
+	}
+	return( SectionView<ID>() );
+    }
+
+    /*
+     *  Member group with instanceID (e.g. MUD_GRP_TRI_TD_HIST_ID)
+     */
+    SectionView group( std::uint32_t instanceID ) const noexcept
+    {
+	return( find<MUD_SEC_GRP_ID>( instanceID ) );
+    }
+
+    class iterator
+    {
+    public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = Section;
+	using difference_type = std::ptrdiff_t;
+	using pointer = const Section*;
+	using reference = Section;
+
+	iterator( const SectionView* pGrp, std::uint32_t i ) noexcept
+	    : pGrp_( pGrp ), i_( i ) {}
+
+	Section operator*() const noexcept { return( pGrp_->member( i_ ) ); }
+	iterator& operator++() noexcept { i_++; return( *this ); }
+	iterator operator++( int ) noexcept { iterator it = *this; i_++; return( it ); }
+	bool operator==( const iterator& o ) const noexcept { return( i_ == o.i_ ); }
+	bool operator!=( const iterator& o ) const noexcept { return( i_ != o.i_ ); }
+
+    private:
+	const SectionView* pGrp_;
+	std::uint32_t i_;
+    };
+
+    iterator begin() const noexcept { return( iterator( this, 0 ) ); }
+    iterator end() const noexcept { return( iterator( this, numIndex() ) ); }
+};
+
+typedef SectionView<MUD_SEC_GRP_ID> GroupView;
+
+
+/*
+ *  The file group of a whole MUD file in buf (its instanceID is the
+ *  format, e.g. MUD_FMT_TRI_TD_ID)
+ */
+inline GroupView
+fileView( const void* buf, std::size_t len ) noexcept
+{
+    return( Section( buf, len ).as<MUD_SEC_GRP_ID>() );
+}
+
+
+/*
+ *  MUD_SEC_GEN_RUN_DESC
+ */
+template <>
+class SectionView<MUD_SEC_GEN_RUN_DESC_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GEN_RUN_DESC_ID;
+    static constexpr std::size_t offExptNumber = 12;
+    static constexpr std::size_t offRunNumber = 16;
+    static constexpr std::size_t offTimeBegin = 20;
+    static constexpr std::size_t offTimeEnd = 24;
+    static constexpr std::size_t offElapsedSec = 28;
+    static constexpr std::size_t offStrings = 32;
+    using Section::Section;
+
+    std::uint32_t exptNumber() const noexcept { return( u32( offExptNumber ) ); }
+    std::uint32_t runNumber() const noexcept { return( u32( offRunNumber ) ); }
+    std::uint32_t timeBegin() const noexcept { return( u32( offTimeBegin ) ); }
+    std::uint32_t timeEnd() const noexcept { return( u32( offTimeEnd ) ); }
+    std::uint32_t elapsedSec() const noexcept { return( u32( offElapsedSec ) ); }
+
+    std::string_view title() const noexcept { return( str( offStrings, 0 ) ); }
+    std::string_view lab() const noexcept { return( str( offStrings, 1 ) ); }
+    std::string_view area() const noexcept { return( str( offStrings, 2 ) ); }
+    std::string_view method() const noexcept { return( str( offStrings, 3 ) ); }
+    std::string_view apparatus() const noexcept { return( str( offStrings, 4 ) ); }
+    std::string_view insert() const noexcept { return( str( offStrings, 5 ) ); }
+    std::string_view sample() const noexcept { return( str( offStrings, 6 ) ); }
+    std::string_view orient() const noexcept { return( str( offStrings, 7 ) ); }
+    std::string_view das() const noexcept { return( str( offStrings, 8 ) ); }
+    std::string_view experimenter() const noexcept { return( str( offStrings, 9 ) ); }
+    std::string_view temperature() const noexcept { return( str( offStrings, 10 ) ); }
+    std::string_view field() const noexcept { return( str( offStrings, 11 ) ); }
+};
+
+
+/*
+ *  MUD_SEC_TRI_TI_RUN_DESC
+ */
+template <>
+class SectionView<MUD_SEC_TRI_TI_RUN_DESC_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_TRI_TI_RUN_DESC_ID;
+    static constexpr std::size_t offExptNumber = 12;
+    static constexpr std::size_t offRunNumber = 16;
+    static constexpr std::size_t offTimeBegin = 20;
+    static constexpr std::size_t offTimeEnd = 24;
+    static constexpr std::size_t offElapsedSec = 28;
+    static constexpr std::size_t offStrings = 32;
+    using Section::Section;
+
+    std::uint32_t exptNumber() const noexcept { return( u32( offExptNumber ) ); }
+    std::uint32_t runNumber() const noexcept { return( u32( offRunNumber ) ); }
+    std::uint32_t timeBegin() const noexcept { return( u32( offTimeBegin ) ); }
+    std::uint32_t timeEnd() const noexcept { return( u32( offTimeEnd ) ); }
+    std::uint32_t elapsedSec() const noexcept { return( u32( offElapsedSec ) ); }
+
+    std::string_view title() const noexcept { return( str( offStrings, 0 ) ); }
+    std::string_view lab() const noexcept { return( str( offStrings, 1 ) ); }
+    std::string_view area() const noexcept { return( str( offStrings, 2 ) ); }
+    std::string_view method() const noexcept { return( str( offStrings, 3 ) ); }
+    std::string_view apparatus() const noexcept { return( str( offStrings, 4 ) ); }
+    std::string_view insert() const noexcept { return( str( offStrings, 5 ) ); }
+    std::string_view sample() const noexcept { return( str( offStrings, 6 ) ); }
+    std::string_view orient() const noexcept { return( str( offStrings, 7 ) ); }
+    std::string_view das() const noexcept { return( str( offStrings, 8 ) ); }
+    std::string_view experimenter() const noexcept { return( str( offStrings, 9 ) ); }
+    std::string_view subtitle() const noexcept { return( str( offStrings, 10 ) ); }
+    std::string_view comment1() const noexcept { return( str( offStrings, 11 ) ); }
+    std::string_view comment2() const noexcept { return( str( offStrings, 12 ) ); }
+    std::string_view comment3() const noexcept { return( str( offStrings, 13 ) ); }
+};
+
+
+/*
+ *  MUD_SEC_GEN_HIST_HDR
+ */
+template <>
+class SectionView<MUD_SEC_GEN_HIST_HDR_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GEN_HIST_HDR_ID;
+    static constexpr std::size_t offHistType = 12;
+    static constexpr std::size_t offNBytes = 16;
+    static constexpr std::size_t offNBins = 20;
+    static constexpr std::size_t offBytesPerBin = 24;
+    static constexpr std::size_t offFsPerBin = 28;
+    static constexpr std::size_t offT0_ps = 32;
+    static constexpr std::size_t offT0_bin = 36;
+    static constexpr std::size_t offGoodBin1 = 40;
+    static constexpr std::size_t offGoodBin2 = 44;
+    static constexpr std::size_t offBkgd1 = 48;
+    static constexpr std::size_t offBkgd2 = 52;
+    static constexpr std::size_t offNEvents = 56;
+    static constexpr std::size_t offStrings = 60;
+    using Section::Section;
+
+    std::uint32_t histType() const noexcept { return( u32( offHistType ) ); }
+    std::uint32_t nBytes() const noexcept { return( u32( offNBytes ) ); }
+    std::uint32_t nBins() const noexcept { return( u32( offNBins ) ); }
+    std::uint32_t bytesPerBin() const noexcept { return( u32( offBytesPerBin ) ); }
+    std::uint32_t fsPerBin() const noexcept { return( u32( offFsPerBin ) ); }
+    std::uint32_t t0_ps() const noexcept { return( u32( offT0_ps ) ); }
+    std::uint32_t t0_bin() const noexcept { return( u32( offT0_bin ) ); }
+    std::uint32_t goodBin1() const noexcept { return( u32( offGoodBin1 ) ); }
+    std::uint32_t goodBin2() const noexcept { return( u32( offGoodBin2 ) ); }
+    std::uint32_t bkgd1() const noexcept { return( u32( offBkgd1 ) ); }
+    std::uint32_t bkgd2() const noexcept { return( u32( offBkgd2 ) ); }
+    std::uint32_t nEvents() const noexcept { return( u32( offNEvents ) ); }
+
+    std::string_view title() const noexcept { return( str( offStrings, 0 ) ); }
+};
+
+
+/*
+ *  MUD_SEC_GEN_HIST_DAT: the bins as encoded.  With 1, 2 or 4 bytes per
+ *  bin (from the header) they can be read in place; packed data (0) and
+ *  deltas (MUD_BIN_SIZE_DELTA) must be unpacked with
+ *  MUD_SEC_GEN_HIST_unpack().
+ */
+template <>
+class SectionView<MUD_SEC_GEN_HIST_DAT_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GEN_HIST_DAT_ID;
+    static constexpr std::size_t offNBytes = 12;
+    static constexpr std::size_t offData = 16;
+    using Section::Section;
+
+    std::uint32_t nBytes() const noexcept
+    {
+	std::uint32_t n = u32( offNBytes );
+	return( ( offData + n <= limit() ) ? n : 0 );
+    }
+
+    const unsigned char* pData() const noexcept
+    {
+	return( valid() ? p_ + offData : nullptr );
+    }
+
+    std::uint32_t bin( std::uint32_t i, std::uint32_t bytesPerBin ) const noexcept
+    {
+	std::size_t off = (std::size_t)i*bytesPerBin;
+
+	if( off + bytesPerBin > nBytes() ) return( 0 );
+	switch( bytesPerBin )
+	{
+	    case 1: return( pData()[off] );
+	    case 2: return( detail::le16( pData() + off ) );
+	    case 4: return( detail::le32( pData() + off ) );
+	}
+	return( 0 );
+    }
+};
+
+
+/*
+ *  MUD_SEC_GEN_SCALER
+ */
+template <>
+class SectionView<MUD_SEC_GEN_SCALER_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GEN_SCALER_ID;
+    static constexpr std::size_t offCounts = 12;
+    static constexpr std::size_t offStrings = 20;
+    using Section::Section;
+
+    std::uint32_t counts( int i ) const noexcept
+    {
+	return( ( ( i == 0 ) || ( i == 1 ) ) ? u32( offCounts + 4*i ) : 0 );
+    }
+
+    std::string_view label() const noexcept { return( str( offStrings, 0 ) ); }
+};
+
+
+/*
+ *  MUD_SEC_GEN_IND_VAR
+ */
+template <>
+class SectionView<MUD_SEC_GEN_IND_VAR_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GEN_IND_VAR_ID;
+    static constexpr std::size_t offLow = 12;
+    static constexpr std::size_t offHigh = 20;
+    static constexpr std::size_t offMean = 28;
+    static constexpr std::size_t offStddev = 36;
+    static constexpr std::size_t offSkewness = 44;
+    static constexpr std::size_t offStrings = 52;
+    using Section::Section;
+
+    double low() const noexcept { return( real64( offLow ) ); }
+    double high() const noexcept { return( real64( offHigh ) ); }
+    double mean() const noexcept { return( real64( offMean ) ); }
+    double stddev() const noexcept { return( real64( offStddev ) ); }
+    double skewness() const noexcept { return( real64( offSkewness ) ); }
+
+    std::string_view name() const noexcept { return( str( offStrings, 0 ) ); }
+    std::string_view description() const noexcept { return( str( offStrings, 1 ) ); }
+    std::string_view units() const noexcept { return( str( offStrings, 2 ) ); }
+};
+
+
+/*
+ *  MUD_SEC_GEN_ARRAY: num elements of elemSize bytes, integers (type 1),
+ *  VAX reals (type 2) or characters (type 3), then the time of each if
+ *  hasTime.
+ */
+template <>
+class SectionView<MUD_SEC_GEN_ARRAY_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_GEN_ARRAY_ID;
+    static constexpr std::size_t offNum = 12;
+    static constexpr std::size_t offElemSize = 16;
+    static constexpr std::size_t offType = 20;
+    static constexpr std::size_t offHasTime = 24;
+    static constexpr std::size_t offNBytes = 28;
+    static constexpr std::size_t offData = 32;
+    using Section::Section;
+
+    std::uint32_t num() const noexcept { return( u32( offNum ) ); }
+    std::uint32_t elemSize() const noexcept { return( u32( offElemSize ) ); }
+    std::uint32_t type() const noexcept { return( u32( offType ) ); }
+    std::uint32_t hasTime() const noexcept { return( u32( offHasTime ) ); }
+
+    std::uint32_t nBytes() const noexcept
+    {
+	std::uint32_t n = u32( offNBytes );
+	return( ( offData + n <= limit() ) ? n : 0 );
+    }
+
+    const unsigned char* pData() const noexcept
+    {
+	return( valid() ? p_ + offData : nullptr );
+    }
+
+    std::string_view text() const noexcept
+    {
+	return( std::string_view( (const char*)pData(), nBytes() ) );
+    }
+
+    std::uint32_t integer( std::uint32_t i ) const noexcept
+    {
+	std::size_t off = (std::size_t)i*elemSize();
+
+	if( ( type() != 1 ) || ( off + elemSize() > nBytes() ) ) return( 0 );
+	switch( elemSize() )
+	{
+	    case 1: return( pData()[off] );
+	    case 2: return( detail::le16( pData() + off ) );
+	    case 4: return( detail::le32( pData() + off ) );
+	}
+	return( 0 );
+    }
+
+    double real( std::uint32_t i ) const noexcept
+    {
+	std::size_t off = (std::size_t)i*elemSize();
+
+	if( ( type() != 2 ) || ( off + elemSize() > nBytes() ) ) return( 0.0 );
+	switch( elemSize() )
+	{
+	    case 4: return( detail::vaxFloat( pData() + off ) );
+	    case 8: return( detail::vaxDouble( pData() + off ) );
+	}
+	return( 0.0 );
+    }
+
+    std::uint32_t time( std::uint32_t i ) const noexcept
+    {
+	if( !hasTime() || ( i >= num() ) ) return( 0 );
+	return( u32( offData + nBytes() + 4*(std::size_t)i ) );
+    }
+};
+
+
+/*
+ *  MUD_SEC_CMT
+ */
+template <>
+class SectionView<MUD_SEC_CMT_ID> : public Section
+{
+public:
+    static constexpr std::uint32_t id = MUD_SEC_CMT_ID;
+    static constexpr std::size_t offID = 12;
+    static constexpr std::size_t offPrevReplyID = 16;
+    static constexpr std::size_t offNextReplyID = 20;
+    static constexpr std::size_t offTime = 24;
+    static constexpr std::size_t offStrings = 28;
+    using Section::Section;
+
+    std::uint32_t ID() const noexcept { return( u32( offID ) ); }
+    std::uint32_t prevReplyID() const noexcept { return( u32( offPrevReplyID ) ); }
+    std::uint32_t nextReplyID() const noexcept { return( u32( offNextReplyID ) ); }
+    std::uint32_t time() const noexcept { return( u32( offTime ) ); }
+
+    std::string_view author() const noexcept { return( str( offStrings, 0 ) ); }
+    std::string_view title() const noexcept { return( str( offStrings, 1 ) ); }
+    std::string_view comment() const noexcept { return( str( offStrings, 2 ) ); }
+};
+
+} // namespace mud
+
+#endif /* _MUD_VIEW_HPP_ */
@@ -0,0 +1,488 @@
+/*
+ *  mud_view_test.cpp -- test of mud_view.hpp against the friendly API
+ *
+ *   Copyright (C) 2026 TRIUMF (Vancouver, Canada)
+ *
+ *   Released under the GNU LGPL - see http://www.gnu.org/licenses
+ *
+ *   This program is free software; you can distribute it and/or modify it under
+ *   the terms of the Lesser GNU General Public License as published by the Free
+ *   Software Foundation; either version 2 of the License, or any later version.
+ *   Accordingly, this program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *   or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser GNU General Public License
+ *   for more details.
+ *
+ *  Revision history:
+ *   v1.0   19-Oct-2026  agent  Initial version
+ *
+ *  Description:
+ *    Writes synthetic runs (MUD_writeSynth) of both formats and of each
+ *    bin size into a directory, then reads each both ways: whole into
+ *    memory through mud::fileView, and with MUD_openRead.  Every field,
+ *    string and bin the views give must equal what the friendly API
+ *    gives.  Then each run cut short at every length must give views
+ *    which stay inside the bytes they were given (read from a buffer of
+ *    just that size, so that a sanitizer catches any read past it).
+ *
+ *    The meson test target runs it; alternatively:
+ *
+ *      mud_view_test [directory]
+ *
+ *    Exits 0 if all checks pass.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mud_view.hpp"
+
+static int nFailed = 0;
+
+#define CHECK( cond ) \
+    do { \
+	if( !( cond ) && ( nFailed++ < 20 ) ) \
+	    std::fprintf( stderr, "%s:%d: failed: %s (%s)\n", __FILE__, \
+			  __LINE__, #cond, test_name.c_str() ); \
+    } while( 0 )
+
+static std::string test_name;
+
+
+static bool
+read_whole( const std::string& filename, std::vector<unsigned char>& buf )
+{
+    FILE* fin;
+    long size;
+
+    fin = std::fopen( filename.c_str(), "rb" );
+    if( fin == NULL ) return( false );
+    std::fseek( fin, 0, SEEK_END );
+    size = std::ftell( fin );
+    std::rewind( fin );
+    buf.resize( (size_t)size );
+    if( std::fread( buf.data(), 1, buf.size(), fin ) != buf.size() ) size = -1;
+    std::fclose( fin );
+    return( size >= 0 );
+}
+
+/*
+ *  Same value, bit for bit (so that NaN equals NaN)
+ */
+static bool
+same_real( double a, double b )
+{
+    return( std::memcmp( &a, &b, sizeof( double ) ) == 0 );
+}
+
+
+static void
+check_desc( int fd, mud::GroupView file )
+{
+    char str[256];
+    UINT32 u;
+
+    if( file.instanceID() == MUD_FMT_TRI_TI_ID )
+    {
+	auto desc = file.find<MUD_SEC_TRI_TI_RUN_DESC_ID>();
+
+	CHECK( desc );
+	MUD_getRunNumber( fd, &u );
+	CHECK( desc.runNumber() == u );
+	MUD_getElapsedSec( fd, &u );
+	CHECK( desc.elapsedSec() == u );
+	MUD_getTitle( fd, str, sizeof( str ) );
+	CHECK( desc.title() == str );
+	MUD_getSubtitle( fd, str, sizeof( str ) );
+	CHECK( desc.subtitle() == str );
+	MUD_getComment3( fd, str, sizeof( str ) );
+	CHECK( desc.comment3() == str );
+    }
+    else
+    {
+	auto desc = file.find<MUD_SEC_GEN_RUN_DESC_ID>();
+
+	CHECK( desc );
+	MUD_getRunNumber( fd, &u );
+	CHECK( desc.runNumber() == u );
+	MUD_getElapsedSec( fd, &u );
+	CHECK( desc.elapsedSec() == u );
+	MUD_getTitle( fd, str, sizeof( str ) );
+	CHECK( desc.title() == str );
+	MUD_getSample( fd, str, sizeof( str ) );
+	CHECK( desc.sample() == str );
+	MUD_getField( fd, str, sizeof( str ) );
+	CHECK( desc.field() == str );
+    }
+}
+
+/*
+ *  Bins read in place for 1, 2 or 4 bytes per bin, otherwise unpacked
+ *  from the view's data, against MUD_getHistData (if the header agrees)
+ */
+static void
+check_bins( int fd, int num, mud::SectionView<MUD_SEC_GEN_HIST_HDR_ID> hdr,
+	    mud::SectionView<MUD_SEC_GEN_HIST_DAT_ID> dat )
+{
+    UINT32 nBins, bytesPerBin, i, bin;
+
+    MUD_getHistNumBins( fd, num, &nBins );
+    MUD_getHistBytesPerBin( fd, num, &bytesPerBin );
+    if( ( hdr.nBins() != nBins ) || ( hdr.bytesPerBin() != bytesPerBin ) ) return;
+
+    std::vector<UINT32> expected( nBins + 1 );
+    std::vector<unsigned char> raw( 4*(size_t)nBins + 4 );
+    std::vector<UINT32> unpacked( nBins + 1 );
+
+    CHECK( MUD_getHistData( fd, num, raw.data() ) );
+    for( i = 0; i < nBins; i++ )
+    {
+	switch( bytesPerBin )
+	{
+	    case 1: expected[i] = raw[i]; break;
+	    case 2: { UINT16 s; std::memcpy( &s, &raw[2*i], 2 ); expected[i] = s; } break;
+	    default: std::memcpy( &expected[i], &raw[4*i], 4 ); break;
+	}
+    }
+
+    if( ( bytesPerBin == 1 ) || ( bytesPerBin == 2 ) || ( bytesPerBin == 4 ) )
+    {
+	CHECK( dat.nBytes() == nBins*bytesPerBin );
+	for( i = 0; i < nBins; i++ )
+	{
+	    bin = dat.bin( i, bytesPerBin );
+	    CHECK( bin == expected[i] );
+	    if( bin != expected[i] ) break;
+	}
+	CHECK( dat.bin( nBins, bytesPerBin ) == 0 );
+    }
+    else
+    {
+	std::vector<unsigned char> packed( dat.pData(), dat.pData() + dat.nBytes() );
+
+	CHECK( MUD_SEC_GEN_HIST_unpackChecked( (int)nBins, (int)bytesPerBin,
+					       packed.data(), dat.nBytes(), 4,
+					       unpacked.data() ) >= 0 );
+	CHECK( std::memcmp( unpacked.data(), expected.data(), 4*(size_t)nBins ) == 0 );
+    }
+}
+
+
+static void
+check_hists( int fd, mud::GroupView file )
+{
+    char str[256];
+    UINT32 type, num, u;
+    int k = 0;
+
+    CHECK( MUD_getHists( fd, &type, &num ) );
+    mud::GroupView grp = file.group( type );
+    CHECK( grp );
+
+    for( mud::Section sec : grp )
+    {
+	auto hdr = sec.as<MUD_SEC_GEN_HIST_HDR_ID>();
+
+	if( !hdr ) continue;
+	k++;
+	CHECK( hdr.instanceID() == (UINT32)k );
+	MUD_getHistNumBins( fd, k, &u );
+	CHECK( hdr.nBins() == u );
+	MUD_getHistBytesPerBin( fd, k, &u );
+	CHECK( hdr.bytesPerBin() == u );
+	MUD_getHistNumBytes( fd, k, &u );
+	CHECK( hdr.nBytes() == u );
+	MUD_getHistT0_Bin( fd, k, &u );
+	CHECK( hdr.t0_bin() == u );
+	MUD_getHistGoodBin2( fd, k, &u );
+	CHECK( hdr.goodBin2() == u );
+	MUD_getHistBkgd1( fd, k, &u );
+	CHECK( hdr.bkgd1() == u );
+	MUD_getHistNumEvents( fd, k, &u );
+	CHECK( hdr.nEvents() == u );
+	MUD_getHistTitle( fd, k, str, sizeof( str ) );
+	CHECK( hdr.title() == str );
+
+	auto dat = grp.find<MUD_SEC_GEN_HIST_DAT_ID>( hdr.instanceID() );
+	CHECK( dat );
+	CHECK( dat.nBytes() == hdr.nBytes() );
+	check_bins( fd, k, hdr, dat );
+    }
+    CHECK( k == (int)num );
+}
+
+
+static void
+check_scalers( int fd, mud::GroupView file )
+{
+    char str[256];
+    UINT32 type, num, counts[2];
+    int k = 0;
+
+    if( !MUD_getScalers( fd, &type, &num ) ) return;
+    mud::GroupView grp = file.group( type );
+    CHECK( grp );
+
+    for( mud::Section sec : grp )
+    {
+	auto scaler = sec.as<MUD_SEC_GEN_SCALER_ID>();
+
+	CHECK( scaler );
+	k++;
+	MUD_getScalerCounts( fd, k, counts );
+	CHECK( scaler.counts( 0 ) == counts[0] );
+	CHECK( scaler.counts( 1 ) == counts[1] );
+	CHECK( scaler.counts( 2 ) == 0 );
+	MUD_getScalerLabel( fd, k, str, sizeof( str ) );
+	CHECK( scaler.label() == str );
+    }
+    CHECK( k == (int)num );
+}
+
+
+static void
+check_ind_vars( int fd, mud::GroupView file )
+{
+    char str[256];
+    UINT32 type, num, u, nData, elemSize, dataType, i;
+    double d;
+    int k = 0;
+
+    if( !MUD_getIndVars( fd, &type, &num ) ) return;
+    mud::GroupView grp = file.group( type );
+    CHECK( grp );
+
+    for( mud::Section sec : grp )
+    {
+	if( auto var = sec.as<MUD_SEC_GEN_IND_VAR_ID>() )
+	{
+	    k++;
+	    MUD_getIndVarLow( fd, k, &d );
+	    CHECK( same_real( var.low(), d ) );
+	    MUD_getIndVarHigh( fd, k, &d );
+	    CHECK( same_real( var.high(), d ) );
+	    MUD_getIndVarMean( fd, k, &d );
+	    CHECK( same_real( var.mean(), d ) );
+	    MUD_getIndVarStddev( fd, k, &d );
+	    CHECK( same_real( var.stddev(), d ) );
+	    MUD_getIndVarName( fd, k, str, sizeof( str ) );
+	    CHECK( var.name() == str );
+	    MUD_getIndVarUnits( fd, k, str, sizeof( str ) );
+	    CHECK( var.units() == str );
+	}
+	else if( auto array = sec.as<MUD_SEC_GEN_ARRAY_ID>() )
+	{
+	    MUD_getIndVarNumData( fd, k, &nData );
+	    MUD_getIndVarElemSize( fd, k, &elemSize );
+	    MUD_getIndVarDataType( fd, k, &dataType );
+	    MUD_getIndVarHasTime( fd, k, &u );
+	    CHECK( array.num() == nData );
+	    CHECK( array.elemSize() == elemSize );
+	    CHECK( array.type() == dataType );
+	    CHECK( array.hasTime() == u );
+
+	    std::vector<unsigned char> data( (size_t)nData*elemSize + 8 );
+	    MUD_getIndVarData( fd, k, data.data() );
+	    for( i = 0; i < nData; i++ )
+	    {
+		if( ( dataType == 2 ) && ( elemSize == 8 ) )
+		{
+		    std::memcpy( &d, &data[8*i], 8 );
+		    CHECK( same_real( array.real( i ), d ) );
+		}
+		else if( ( dataType == 2 ) && ( elemSize == 4 ) )
+		{
+		    float f;
+		    std::memcpy( &f, &data[4*i], 4 );
+		    CHECK( same_real( array.real( i ), f ) );
+		}
+		else if( ( dataType == 1 ) && ( elemSize == 4 ) )
+		{
+		    std::memcpy( &u, &data[4*i], 4 );
+		    CHECK( array.integer( i ) == u );
+		}
+	    }
+	    CHECK( array.real( nData ) == 0.0 );
+	    CHECK( array.integer( nData ) == 0 );
+	}
+	else
+	{
+	    CHECK( !"ind. var. member of unknown type" );
+	}
+    }
+    CHECK( k == (int)num );
+}
+
+
+static void
+check_comments( int fd, mud::GroupView file )
+{
+    char str[1024];
+    UINT32 type, num, u;
+    int k = 0;
+
+    if( !MUD_getComments( fd, &type, &num ) ) return;
+    mud::GroupView grp = file.group( type );
+    CHECK( grp );
+
+    for( mud::Section sec : grp )
+    {
+	auto comment = sec.as<MUD_SEC_CMT_ID>();
+
+	CHECK( comment );
+	k++;
+	MUD_getCommentTime( fd, k, &u );
+	CHECK( comment.time() == u );
+	MUD_getCommentAuthor( fd, k, str, sizeof( str ) );
+	CHECK( comment.author() == str );
+	MUD_getCommentTitle( fd, k, str, sizeof( str ) );
+	CHECK( comment.title() == str );
+	MUD_getCommentBody( fd, k, str, sizeof( str ) );
+	CHECK( comment.comment() == str );
+    }
+    CHECK( k == (int)num );
+}
+
+/*
+ *  Every section reachable through a view of the first len bytes of a
+ *  run, and every field of it, read from a buffer of just len bytes
+ */
+static bool
+inside( const unsigned char* buf, size_t len, mud::Section sec )
+{
+    return( !sec || ( ( sec.data() >= buf ) &&
+		      ( sec.data() + sec.size() <= buf + len ) ) );
+}
+
+static void
+walk( const unsigned char* buf, size_t len, mud::GroupView grp, int depth )
+{
+    std::string_view s;
+    UINT32 u;
+
+    CHECK( inside( buf, len, grp ) );
+    if( !grp || ( depth > 2 ) ) return;
+
+    for( mud::Section sec : grp )
+    {
+	CHECK( inside( buf, len, sec ) );
+	if( auto sub = sec.as<MUD_SEC_GRP_ID>() ) walk( buf, len, sub, depth + 1 );
+	else if( auto desc = sec.as<MUD_SEC_GEN_RUN_DESC_ID>() )
+	    s = desc.field(), u = desc.runNumber();
+	else if( auto desc = sec.as<MUD_SEC_TRI_TI_RUN_DESC_ID>() )
+	    s = desc.comment3(), u = desc.runNumber();
+	else if( auto hdr = sec.as<MUD_SEC_GEN_HIST_HDR_ID>() )
+	    s = hdr.title(), u = hdr.nEvents();
+	else if( auto dat = sec.as<MUD_SEC_GEN_HIST_DAT_ID>() )
+	{
+	    CHECK( dat.pData() + dat.nBytes() <= buf + len );
+	    u = dat.bin( dat.nBytes()/4, 4 );
+	}
+	else if( auto scaler = sec.as<MUD_SEC_GEN_SCALER_ID>() )
+	    s = scaler.label(), u = scaler.counts( 1 );
+	else if( auto var = sec.as<MUD_SEC_GEN_IND_VAR_ID>() )
+	    s = var.units(), u = (UINT32)var.skewness();
+	else if( auto array = sec.as<MUD_SEC_GEN_ARRAY_ID>() )
+	{
+	    CHECK( array.pData() + array.nBytes() <= buf + len );
+	    u = array.integer( array.num() - 1 ) + array.time( array.num() - 1 );
+	}
+	else if( auto comment = sec.as<MUD_SEC_CMT_ID>() )
+	    s = comment.comment(), u = comment.time();
+	CHECK( s.empty() || ( ( (const unsigned char*)s.data() >= buf ) &&
+			      ( (const unsigned char*)s.data() + s.size() <= buf + len ) ) );
+	(void)u;
+    }
+}
+
+
+static void
+check_run( const std::string& filename )
+{
+    std::vector<unsigned char> buf;
+    UINT32 type;
+    size_t len, step;
+    int fd;
+
+    CHECK( read_whole( filename, buf ) );
+    fd = MUD_openRead( (char*)filename.c_str(), &type );
+    CHECK( fd >= 0 );
+    if( fd < 0 ) return;
+
+    mud::GroupView file = mud::fileView( buf.data(), buf.size() );
+    CHECK( file );
+    CHECK( file.instanceID() == type );
+    CHECK( file.size() + file.memSize() <= buf.size() );
+
+    check_desc( fd, file );
+    check_hists( fd, file );
+    check_scalers( fd, file );
+    check_ind_vars( fd, file );
+    check_comments( fd, file );
+    MUD_closeRead( fd );
+
+    /*
+     *  Cut short: every length through the headers, then a few hundred
+     *  through the rest
+     */
+    step = buf.size()/500 + 1;
+    for( len = 0; len <= buf.size(); len += ( len < 4096 ) ? 1 : step )
+    {
+	std::vector<unsigned char> cut( buf.begin(), buf.begin() + len );
+	mud::GroupView part = mud::fileView( cut.data(), len );
+
+	CHECK( !part || ( len >= mud::Section::coreSize ) );
+	walk( cut.data(), len, part, 0 );
+    }
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+    static const int binSizes[] = { 1, 2, 4, 0, MUD_BIN_SIZE_DELTA };
+    static const UINT32 types[] = { MUD_FMT_TRI_TD_ID, MUD_FMT_TRI_TI_ID };
+    std::string dir = ( argc > 1 ) ? argv[1] : ".";
+    std::string filename;
+    MUD_SYNTH synth;
+    int i, j;
+
+    for( i = 0; i < 2; i++ )
+    {
+	for( j = 0; j < 5; j++ )
+	{
+	    MUD_synthDefaults( &synth, types[i] );
+	    synth.seed = 10*i + j + 1;
+	    synth.nBins = 1000 + j;
+	    synth.bytesPerBin = binSizes[j];
+	    synth.nComments = 3;
+
+	    filename = dir + "/mud_view_test_" + std::to_string( 10*i + j ) + ".msr";
+	    test_name = filename;
+	    if( !MUD_writeSynth( (char*)filename.c_str(), &synth ) )
+	    {
+		std::fprintf( stderr, "cannot write %s\n", filename.c_str() );
+		return( 1 );
+	    }
+	    check_run( filename );
+	    std::remove( filename.c_str() );
+	}
+    }
+
+    /*
+     *  Not a MUD file
+     */
+    test_name = "junk";
+    {
+	static const unsigned char junk[] = { 0xff, 0xff, 0xff, 0x7f, 1, 0, 0, 0 };
+	CHECK( !mud::fileView( junk, sizeof( junk ) ) );
+	CHECK( !mud::fileView( NULL, 100 ) );
+	CHECK( !mud::Section().as<MUD_SEC_GRP_ID>().member( 0 ) );
+    }
+
+    if( nFailed > 0 ) std::fprintf( stderr, "%d checks failed\n", nFailed );
+    else std::printf( "mud_view_test: all checks passed\n" );
+    return( ( nFailed > 0 ) ? 1 : 0 );
+}
@@ -1,5 +1,15 @@
 from . import containers
 from .mdata import mdata
+from . import mcolumnar
+from . import mcache
+from . import mshared
+from . import msynth
+from . import msum
+from . import masym
+from . import mload
+from .mload import load_many, load_shared
+from . import masync
+from .masync import aload, aiter_dir
 from .global_variables import __version__, __src__, __author__
 
-__all__ = ['mdata', 'containers', 'mud_friendly']
\ No newline at end of file
+__all__ = ['mdata', 'containers', 'mcolumnar', 'mcache', 'mshared', 'msynth', 'msum', 'masym', 'mload', 'load_many', 'load_shared', 'masync', 'aload', 'aiter_dir', 'mud_friendly']
\ No newline at end of file
@@ -5,7 +5,7 @@
 from .mcontainer import mcontainer
 from .mdict import mdict
 from .mcomment import mcomment
-from .mhist import mhist
+from .mhist import mhist, mhist_lazy
 from .mscaler import mscaler
 from .mlist import mlist
 from .mvar import mvar
@@ -0,0 +1,51 @@
+# Asymmetry of paired histograms
+# agent
+# Oct 2026
+
+import mudpy.mud_friendly_wrapper as mud
+import os
+
+__doc__="""
+    Asymmetry (F-B)/(F+B) of a pair of histograms, with its error, computed
+    in C (MUD_asymHists in mud_asym.c) as the histograms are unpacked.
+
+    Each histogram has the mean counts of its background window, bkgd1 to
+    bkgd2 of its header, subtracted first. Histograms are given by title
+    ("F+", "B+") or by the attribute names of mdata.hist ("Fp", "Bp"), or
+    by id number.
+
+    Functions:
+        asym(filename, f, b):   asymmetry and error of a run
+"""
+
+# =========================================================================== #
+def _hist_id(titles, hist):
+    """
+        Return id number of histogram hist (title, mdict name, or number).
+    """
+
+    if not isinstance(hist, str):
+        if 1 <= hist <= len(titles):
+            return int(hist)
+        raise KeyError('No histogram number %d' % hist)
+
+    for name in (hist, hist.replace('n', '-').replace('p', '+')):
+        if name in titles:
+            return titles.index(name)+1
+    raise KeyError('No histogram titled %s' % hist)
+
+# =========================================================================== #
+def asym(filename, f='F+', b='B+'):
+    """
+        Return (asym, error), float64 arrays of the background-subtracted
+        asymmetry of histograms f and b of run filename, and its error.
+    """
+
+    fh = mud.open_read(os.fspath(filename))
+    try:
+        n = mud.get_hists(fh)[1]
+        titles = [mud.get_hist_title(fh, i) for i in range(1, n+1)]
+        return mud.get_hist_asym(fh, _hist_id(titles, f),
+                                 _hist_id(titles, b))
+    finally:
+        mud.close_read(fh)
@@ -0,0 +1,225 @@
+# Read runs from asyncio
+# agent
+# Oct 2026
+
+from mudpy.mdata import mdata
+from mudpy.mload import MAX_WORKERS
+from concurrent.futures import ThreadPoolExecutor
+import asyncio, collections, glob, os, weakref
+
+__doc__="""
+    Read runs from asyncio code without blocking the event loop.
+
+    Runs are read on a bounded pool of threads, shared by all event loops
+    (runs are decoded without holding the GIL, see mudpy.mload). The bytes
+    of the files being read at once, per event loop, are capped at
+    max_bytes: a read waits for earlier ones to finish rather than go over
+    the cap (a file larger than the cap is read alone), and waiting reads
+    start in the order they were asked for.
+
+    Cancelling a read that has not started drops it. A read that has
+    started cannot be stopped: its thread runs to the end and its bytes
+    are counted until then, but the result is dropped.
+
+    A lazy read counts the whole size of its file too, until mdata
+    returns, although the histogram data (most of a file) are only read
+    later, outside the cap, as they are accessed.
+
+    Functions:
+        aload(path, lazy):                      read run, as a coroutine
+        aiter_dir(directory, pattern, ...):     read runs in a directory, as
+                                                an async iterator
+        configure(workers, max_bytes):          set the pool size and cap
+"""
+
+# settings, set by configure
+_workers = min(os.cpu_count() or 1, MAX_WORKERS)
+_max_bytes = 2**30
+
+_executor = None
+_budgets = weakref.WeakKeyDictionary()    # by event loop
+
+# =========================================================================== #
+class _budget(object):
+    """
+        Bytes being read in one event loop, and reads waiting for them.
+    """
+
+    def __init__(self):
+        self.used = 0
+        self.waiting = collections.deque()  # (n_bytes, future), in order
+
+    async def acquire(self, n_bytes):
+        """
+            Wait until n_bytes may be read, and count them. Returns the
+            bytes counted, to release.
+        """
+
+        n_bytes = min(n_bytes, _max_bytes)
+        if not self.waiting and self.used + n_bytes <= _max_bytes:
+            self.used += n_bytes
+            return n_bytes
+
+        future = asyncio.get_running_loop().create_future()
+        self.waiting.append((n_bytes, future))
+        try:
+            await future
+        except asyncio.CancelledError:
+
+            # cancelled while waiting, or just after being let through
+            if future.cancelled():
+                try:
+                    self.waiting.remove((n_bytes, future))
+                except ValueError:
+                    pass
+                self._wake()
+            else:
+                self.release(n_bytes)
+            raise
+
+        return n_bytes
+
+    def release(self, n_bytes):
+        """
+            Stop counting n_bytes, and let through the reads that now fit.
+        """
+        self.used -= n_bytes
+        self._wake()
+
+    def _wake(self):
+        while self.waiting:
+            n_bytes, future = self.waiting[0]
+            if future.cancelled():
+                self.waiting.popleft()
+                continue
+            if self.used + n_bytes > _max_bytes:
+                break
+            self.waiting.popleft()
+            self.used += n_bytes
+            future.set_result(None)
+
+    def release_soon(self, loop, n_bytes):
+        """
+            release, from any thread. Dropped if the loop is closed.
+        """
+        try:
+            loop.call_soon_threadsafe(self.release, n_bytes)
+        except RuntimeError:
+            pass
+
+# =========================================================================== #
+def configure(workers=None, max_bytes=None):
+    """
+        Set the number of threads reading runs (at most mload.MAX_WORKERS)
+        and the cap on the bytes of the files being read at once. None
+        leaves a setting as it is. Reads already started are not affected.
+    """
+
+    global _workers, _max_bytes, _executor
+
+    if max_bytes is not None:
+        if max_bytes < 1:
+            raise ValueError('max_bytes must be positive')
+        _max_bytes = int(max_bytes)
+
+    if workers is not None:
+        if workers < 1:
+            raise ValueError('workers must be positive')
+        _workers = min(int(workers), MAX_WORKERS)
+        if _executor is not None:
+            _executor.shutdown(wait=False)
+            _executor = None
+
+# =========================================================================== #
+def _get_executor():
+    global _executor
+    if _executor is None:
+        _executor = ThreadPoolExecutor(max_workers=_workers,
+                                       thread_name_prefix='mudpy')
+    return _executor
+
+# =========================================================================== #
+async def aload(path, lazy=False):
+    """
+        Read run and return mdata, without blocking the event loop.
+
+        path:   MUD file
+        lazy:   if True, read histogram data only when first accessed
+                (see mdata). The whole file is still counted against the
+                cap while the run is read.
+    """
+
+    path = os.fspath(path)
+    loop = asyncio.get_running_loop()
+
+    budget = _budgets.get(loop)
+    if budget is None:
+        budget = _budgets[loop] = _budget()
+
+    try:
+        size = os.path.getsize(path)
+    except OSError:
+        size = 0
+
+    n_bytes = await budget.acquire(size)
+    try:
+        future = _get_executor().submit(mdata, path, lazy)
+    except BaseException:
+        budget.release(n_bytes)
+        raise
+
+    # count the bytes until the thread is done, even if cancelled
+    future.add_done_callback(lambda f: budget.release_soon(loop, n_bytes))
+
+    return await asyncio.wrap_future(future)
+
+# =========================================================================== #
+async def aiter_dir(directory, pattern='*.msr', lazy=False, ahead=None,
+                    return_exceptions=False):
+    """
+        Read the runs in directory matching pattern, in order of file name,
+        and yield (path, mdata) for each.
+
+        directory:          directory to read
+        pattern:            glob pattern of the files to read
+        lazy:               if True, read histogram data only when first
+                            accessed (see mdata)
+        ahead:              number of runs read ahead of the one yielded
+                            (None: the number of threads). Runs read but not
+                            yet yielded are held in memory.
+        return_exceptions:  if True, yield (path, exception) for runs that
+                            could not be read, rather than raise
+
+        Runs still being read are cancelled when the iterator is closed.
+    """
+
+    paths = iter(sorted(glob.glob(os.path.join(os.fspath(directory),
+                                                pattern))))
+    ahead = max(1, ahead or _workers)
+    pending = collections.deque()
+
+    def start():
+        path = next(paths, None)
+        if path is not None:
+            pending.append((path, asyncio.ensure_future(aload(path, lazy))))
+
+    try:
+        for i in range(ahead):
+            start()
+
+        while pending:
+            path, task = pending.popleft()
+            start()
+            try:
+                run = await task
+            except asyncio.CancelledError:
+                raise
+            except Exception as err:
+                if not return_exceptions:
+                    raise
+                run = err
+            yield (path, run)
+
+    finally:
+        for path, task in pending:
+            task.cancel()
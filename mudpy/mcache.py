@@ -0,0 +1,189 @@
+# On-disk cache of decoded runs
+# agent
+# Oct 2026
+
+from mudpy import mcolumnar
+import mudpy.mud_friendly_wrapper as mud
+import hashlib
+import os
+import threading
+
+__doc__="""
+    Opt-in cache of decoded runs for mdata.
+
+    When enabled, mdata(filename) first looks in the cache directory for a
+    decoded copy of the run, stored in the columnar format of
+    mudpy.mcolumnar and keyed by the path, size, modification time and a
+    hash of the first and last KEY_BLOCK bytes of the MUD file, and the
+    columnar format version. On a hit the run is memory-mapped from the
+    cache instead of being decoded; on a miss the run is decoded as usual
+    and a copy is added to the cache.
+
+    The cache is bounded by max_bytes: least-recently used runs are removed
+    once the cache grows past it. Runs read from the cache have read-only
+    uint32 histogram data.
+
+    Functions:
+        enable(directory, max_bytes):   start using cache in directory
+        disable():                      stop using cache
+        clear():                        remove all cached runs
+"""
+
+SUFFIX = '.mudc'
+
+# bytes read from each end of a MUD file for its key
+KEY_BLOCK = 2**16
+
+# cache settings, set by enable
+_directory = None
+_max_bytes = 0
+
+# =========================================================================== #
+def enable(directory, max_bytes=2**30):
+    """
+        Cache decoded runs in directory, using at most max_bytes of disk.
+    """
+
+    global _directory, _max_bytes
+
+    os.makedirs(directory, exist_ok=True)
+    _directory = os.path.abspath(directory)
+    _max_bytes = int(max_bytes)
+
+# =========================================================================== #
+def disable():
+    """
+        Stop using the cache. Cached runs are kept.
+    """
+
+    global _directory
+    _directory = None
+
+# =========================================================================== #
+def clear():
+    """
+        Remove all runs from the cache.
+    """
+
+    for path, _ in _entries():
+        try:
+            os.remove(path)
+        except OSError:
+            pass
+
+# =========================================================================== #
+def get_key(filename):
+    """
+        Return the cache key for a MUD file, or None if the cache is not
+        enabled.
+    """
+
+    if _directory is None:
+        return None
+
+    filename = os.path.abspath(filename)
+    try:
+        with open(filename, 'rb') as fid:
+            stat = os.fstat(fid.fileno())
+            key = hashlib.blake2b(digest_size=20)
+            key.update(('%s\0%d\0%d\0%d\0' % (filename, stat.st_size,
+                                              stat.st_mtime_ns,
+                                              mcolumnar.VERSION)).encode())
+
+            # first and last blocks, which hold the run description and 
+            # the end of the last histogram
+            key.update(fid.read(KEY_BLOCK))
+            if stat.st_size > 2*KEY_BLOCK:
+                fid.seek(-KEY_BLOCK, os.SEEK_END)
+            key.update(fid.read(KEY_BLOCK))
+    except OSError:
+        return None
+
+    return key.hexdigest()
+
+# =========================================================================== #
+def read(data, key):
+    """
+        Set the attributes of mdata object data from the cache.
+        Return True on success, False if the run is not cached.
+    """
+
+    path = os.path.join(_directory, key + SUFFIX)
+
+    try:
+        mcolumnar.read(data, path)
+    except (OSError, ValueError, KeyError, RuntimeError):
+
+        # missing or damaged
+        try:
+            os.remove(path)
+        except OSError:
+            pass
+        return False
+
+    # mark as recently used
+    try:
+        os.utime(path)
+    except OSError:
+        pass
+
+    return True
+
+# =========================================================================== #
+def write(file_handle, key):
+    """
+        Add the run open as file_handle to the cache. Failures are ignored.
+    """
+
+    path = os.path.join(_directory, key + SUFFIX)
+    temp = '%s.%d.%d.tmp' % (path, os.getpid(), threading.get_ident())
+
+    try:
+        mud.export_columnar(file_handle, temp)
+        os.replace(temp, path)
+    except (OSError, RuntimeError):
+        try:
+            os.remove(temp)
+        except OSError:
+            pass
+        return
+
+    _evict()
+
+# =========================================================================== #
+def _entries():
+    """
+        Return list of (path, stat) of cached runs, oldest first.
+    """
+
+    if _directory is None:
+        return []
+
+    entries = []
+    for entry in os.scandir(_directory):
+        if entry.name.endswith(SUFFIX):
+            try:
+                entries.append((entry.path, entry.stat()))
+            except OSError:
+                pass
+
+    entries.sort(key=lambda e: e[1].st_mtime_ns)
+    return entries
+
+# =========================================================================== #
+def _evict():
+    """
+        Remove least-recently used runs until the cache fits in max_bytes.
+    """
+
+    entries = _entries()
+    total = sum(stat.st_size for _, stat in entries)
+
+    for path, stat in entries:
+        if total <= _max_bytes:
+            break
+        try:
+            os.remove(path)
+        except OSError:
+            continue
+        total -= stat.st_size
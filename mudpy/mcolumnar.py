@@ -0,0 +1,281 @@
+# Read runs exported in the columnar format
+# agent
+# Oct 2026
+
+from mudpy.containers import mcomment, mhist, mdict, mscaler, mvar
+import numpy as np
+import json
+
+__doc__="""
+    Columnar run files, written by mdata.export (write) or
+    mud_friendly_wrapper.export_columnar.
+
+    The file holds a JSON header describing the run followed by 64-byte
+    aligned little-endian columns: uint32 histogram data and float64
+    independent variable statistics. load maps the file with np.memmap, so
+    histogram data are read directly from the page cache with no unpacking.
+
+    File layout:
+
+        bytes 0-15      "MUDC", version, header length, data offset
+                        (little-endian uint32)
+        bytes 16-       JSON header
+        data offset     columns, at the offsets given in the header
+                        (relative to the data offset)
+
+    Functions:
+        load(filename):         return mdata object with memmapped data
+        read(data, filename):   set attributes of mdata object from file
+        read_buffer(data, buffer):  set attributes of mdata object from a
+                                    columnar run in memory
+        read_header(filename):  return header dictionary
+        write(data, filename):  write mdata object to file
+"""
+
+MAGIC = b'MUDC'
+VERSION = 1
+PREAMBLE = np.dtype([('magic', 'S4'), ('version', '<u4'),
+                     ('header_length', '<u4'), ('data_offset', '<u4')])
+ALIGN = 64
+
+# attributes of items, other than data columns, in the order written
+IVAR_COLUMNS = ('low', 'high', 'mean', 'std', 'skew')
+ITEM_ATTRIBUTES = {
+    'hist':     ('title', 'htype', 'n_bytes', 'n_bins', 'n_events',
+                 'fs_per_bin', 't0_ps', 't0_bin', 'good_bin1', 'good_bin2',
+                 'background1', 'background2', 's_per_bin'),
+    'sclr':     ('title', 'counts_total_recent'),
+    'ivar':     ('title', 'description', 'units'),
+    'comments': ('time', 'title', 'author', 'body'),
+    }
+
+# =========================================================================== #
+def _read_preamble(buffer):
+    """
+        Check the file preamble and return (header length, data offset).
+    """
+
+    if len(buffer) < PREAMBLE.itemsize:
+        raise RuntimeError('Not a columnar run file')
+
+    pre = np.frombuffer(buffer, dtype=PREAMBLE, count=1)[0]
+
+    if pre['magic'] != MAGIC:
+        raise RuntimeError('Not a columnar run file')
+    if pre['version'] != VERSION:
+        raise RuntimeError('Unsupported columnar run file version %d' % \
+                            pre['version'])
+
+    return (int(pre['header_length']), int(pre['data_offset']))
+
+# =========================================================================== #
+def read_header(filename):
+    """
+        Return the header of a columnar run file as a dictionary.
+    """
+
+    with open(filename, 'rb') as fid:
+        length, _ = _read_preamble(fid.read(PREAMBLE.itemsize))
+        return json.loads(fid.read(length).decode('latin1'))
+
+# =========================================================================== #
+def load(filename):
+    """
+        Return mdata object for a columnar run file. Histogram data are
+        read-only views of the memory-mapped file.
+    """
+
+    from mudpy.mdata import mdata
+
+    data = mdata.__new__(mdata)
+    read(data, filename)
+    return data
+
+# =========================================================================== #
+def read(data, filename):
+    """
+        Set the attributes of mdata object data from a columnar run file, 
+        as mdata does from a MUD file.
+    """
+
+    read_buffer(data, np.memmap(filename, dtype=np.uint8, mode='r'))
+
+# =========================================================================== #
+def read_buffer(data, buffer):
+    """
+        Set the attributes of mdata object data from a columnar run held in 
+        buffer (uint8 array), as read does. Histogram data are views of 
+        buffer.
+    """
+
+    length, offset = _read_preamble(buffer)
+    header = json.loads(bytes(buffer[PREAMBLE.itemsize:\
+                                     PREAMBLE.itemsize+length]).decode('latin1'))
+
+    def column(col):
+        start = offset + col['offset']
+        dtype = np.dtype(col['dtype'])
+        return buffer[start:start + dtype.itemsize*col['length']].view(dtype)
+
+    # run description
+    for attr in data.description_attribute_functions.keys():
+        if attr in header:
+            setattr(data, attr, header[attr])
+
+    # histograms
+    if 'hist' in header:
+        data.hist = mdict()
+        for item in header['hist']:
+            obj = mhist()
+            for attr, value in item.items():
+                if attr == 'data':
+                    value = column(value)
+                elif value is None:
+                    value = np.nan
+
+                # single precision, as from get_hist_sec_per_bin
+                elif attr == 's_per_bin':
+                    value = float(np.float32(value))
+                setattr(obj, attr, value)
+            data.hist[obj.title] = obj
+
+    # scalers
+    if 'sclr' in header:
+        data.sclr = mdict()
+        for item in header['sclr']:
+            obj = mscaler()
+            for attr, value in item.items():
+                if attr == 'counts_total_recent':
+                    value = np.array(value, dtype=int)
+                setattr(obj, attr, value)
+            data.sclr[obj.title] = obj
+
+    # independent variables
+    if 'ivar' in header:
+        stats = {k:column(v) for k, v in header['ivar_columns'].items()}
+        data.ivar = mdict()
+        for i, item in enumerate(header['ivar']):
+            obj = mvar()
+            for attr, value in item.items():
+                setattr(obj, attr, value)
+            for attr, value in stats.items():
+                setattr(obj, attr, float(value[i]))
+            data.ivar[obj.title] = obj
+
+    # comments
+    if 'comments' in header:
+        data.comments = mdict()
+        for item in header['comments']:
+            obj = mcomment()
+            for attr, value in item.items():
+                setattr(obj, attr, value)
+            data.comments[obj.title] = obj
+
+    data._set_dates()
+
+# =========================================================================== #
+def _align(offset):
+    return -(-offset // ALIGN) * ALIGN
+
+# =========================================================================== #
+def _json_value(value):
+    """
+        Value as written to the header: numpy scalars as python ones, and
+        NaN as null.
+    """
+
+    if isinstance(value, np.ndarray):
+        return [_json_value(v) for v in value.tolist()]
+    if isinstance(value, (list, tuple)):
+        return [_json_value(v) for v in value]
+    if isinstance(value, np.generic):
+        value = value.item()
+    if isinstance(value, float) and not np.isfinite(value):
+        return None
+    return value
+
+# =========================================================================== #
+def write(data, filename):
+    """
+        Write mdata object data to filename as a columnar run file, from its
+        attributes as they are now, as read does. Histogram data must fit
+        in uint32.
+    """
+
+    header = {'format': MAGIC.decode(), 'version': VERSION}
+
+    # run description
+    for attr in data.description_attribute_functions.keys():
+        value = getattr(data, attr, None)
+        if value is not None:
+            header[attr] = _json_value(value)
+
+    try:
+        method = [m for m in data.mud_method.values()
+                  if m['descr'] == header['description']][0]
+        header['type'] = method['file']
+    except (KeyError, IndexError):
+        pass
+
+    def items(name):
+        group = getattr(data, name, None)
+        if group is None:
+            return None
+        out = []
+        for i, obj in enumerate(group.values()):
+            item = {'id_number': i+1}
+            for attr in ITEM_ATTRIBUTES[name]:
+                try:
+                    item[attr] = _json_value(getattr(obj, attr))
+                except AttributeError:
+                    pass
+            out.append(item)
+        return out
+
+    # histograms, as uint32 columns
+    columns = []
+    offset = 0
+    hists = items('hist')
+    if hists is not None:
+        for item, obj in zip(hists, data.hist.values()):
+            bins = np.asarray(obj.data)
+            if bins.size and (bins.min() < 0 or bins.max() > 0xFFFFFFFF):
+                raise ValueError('Histogram %s does not fit in uint32' % \
+                                 item.get('title'))
+            bins = np.ascontiguousarray(bins, dtype='<u4').ravel()
+            item['n_bins'] = len(bins)
+            item['data'] = {'dtype': '<u4', 'offset': offset,
+                            'length': len(bins)}
+            columns.append((offset, bins))
+            offset = _align(offset + bins.nbytes)
+        header['hist'] = hists
+
+    for name in ('sclr', 'ivar', 'comments'):
+        group = items(name)
+        if group is not None:
+            header[name] = group
+
+    # independent variable statistics, one float64 column each
+    if 'ivar' in header:
+        header['ivar_columns'] = {}
+        n = len(header['ivar'])
+        for attr in IVAR_COLUMNS:
+            stat = np.array([getattr(obj, attr, np.nan)
+                             for obj in data.ivar.values()], dtype='<f8')
+            header['ivar_columns'][attr] = {'dtype': '<f8', 'offset': offset,
+                                            'length': n}
+            columns.append((offset, stat))
+            offset += _align(8*n)
+
+    # preamble, header and columns
+    text = (json.dumps(header) + '\n').encode('latin1')
+    start = _align(PREAMBLE.itemsize + len(text))
+    preamble = np.array([(MAGIC, VERSION, len(text), start)], dtype=PREAMBLE)
+
+    with open(filename, 'wb') as fid:
+        fid.write(preamble.tobytes())
+        fid.write(text)
+        for column_offset, values in columns:
+            fid.seek(start + column_offset)
+            fid.write(values.tobytes())
+        fid.truncate(max(fid.tell(), start))
@@ -6,14 +6,16 @@ class mcontainer(object):
 
         _get_val(): return the value needed to do the various operators.
                     Define in child classes
+        _fields:    names of the data fields, if not those of __slots__
     """
 
     def __repr__(self):
-        if list(self.__slots__):
-            m = max(map(len, self.__slots__)) + 1
+        fields = getattr(self, '_fields', self.__slots__)
+        if list(fields):
+            m = max(map(len, fields)) + 1
             s = ''
             s += '\n'.join([k.rjust(m) + ': ' + repr(getattr(self, k))
-                              for k in sorted(self.__slots__)])
+                              for k in sorted(fields)])
             return s
         else:
             return self.__class__.__name__ + "()"
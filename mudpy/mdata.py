@@ -3,7 +3,8 @@
 # Nov 2019
 
 import mudpy.mud_friendly_wrapper as mud
-from mudpy.containers import mcomment, mhist, mdict, mscaler, mvar
+from mudpy import mcache, mcolumnar, mshared
+from mudpy.containers import mcomment, mhist, mhist_lazy, mdict, mscaler, mvar
 import time
 
 __doc__="""
@@ -11,7 +12,20 @@ __doc__="""
     the MUD data files and to provide user-friendly access to MUD data. The MUD
     data file is read and closed on object construction.
 
-    Signature: mdata(filename)
+    Signature: mdata(filename, lazy=False)
+
+    With lazy=True, histogram data are left in the file, which is memory
+    mapped, and each is read on first access to its mhist.data. With a
+    sidecar index (mud.write_index) they are not even read on opening.
+    Replacing the file is safe, as the one read stays mapped, but it must
+    not be changed in place or truncated before the data are read.
+
+    Decoded runs can be cached on disk between sessions, see mudpy.mcache,
+    and in shared memory between processes, see mudpy.mshared.
+
+    mdata objects can be pickled. With protocol 5 the histogram data are
+    PickleBuffers, which can be passed out-of-band, see mhist and
+    mudpy.mload.load_shared.
 
     Features -----------------------------------------------------------------
 
@@ -71,6 +85,16 @@ class mdata(object):
             __init__
             __getattr__
             __repr__
+            _read_file
+            _read_mdict
+            _set_dates
+            _set_lazy_hist
+            _write_mdict
+
+        Public functions
+            export
+            set_description
+            write
     """
 
     # link object attributes with mud_friendly function (attribute: mud.attr)
@@ -163,16 +187,20 @@ class mdata(object):
                   }
 
     # ======================================================================= #
-    def __init__(self, filename=''):
+    def __init__(self, filename='', lazy=False, release=False):
         """
             Constructor. Reads file or sets file up for writing.
 
             filename: string, path to file to read. If blank, make empty object.
+            lazy:     if True, read histogram data only when first accessed
+            release:  if True, and not lazy nor cached, free the packed data 
+                      of each histogram in the library once unpacked, to 
+                      lower peak memory while reading
         """
 
         # read
         if filename:
-            self._read_file(filename)
+            self._read_file(filename, lazy=lazy, release=release)
 
         # set up for writing
         else:
@@ -238,11 +266,24 @@ class mdata(object):
             return self.__class__.__name__ + "()"
 
     # ======================================================================= #
-    def _read_file(self, filename):
+    def _read_file(self, filename, lazy=False, release=False):
         """
-            Read file into memory.
+            Read file into memory, except for histogram data if lazy, 
+            releasing packed histogram data once unpacked if release.
         """
 
+        # Attach to decoded copy in shared memory -----------------------------
+        shared_key = mshared.get_key(filename)
+        if shared_key is not None and mshared.read(self, shared_key):
+            self._filename = filename
+            return
+
+        # Read decoded copy from cache -----------------------------------------
+        key = mcache.get_key(filename)
+        if key is not None and mcache.read(self, key):
+            self._filename = filename
+            return
+
         # Open file ----------------------------------------------------------
         try:
             fh = mud.open_read(filename)
@@ -250,6 +291,13 @@ class mdata(object):
             raise RuntimeError("Open file %s failed. " % filename) from None
 
         try:
+            # Decode into shared memory, once for all processes, and attach
+            if shared_key is not None:
+                mshared.write(fh, shared_key)
+                if mshared.read(self, shared_key):
+                    self._filename = filename
+                    return
+
             # Read run description
             for attr, func_name in self.description_attribute_functions.items():
                 try:
@@ -258,14 +306,24 @@ class mdata(object):
                 except RuntimeError:
                     pass
 
-            # Read histograms
+            # Read histograms, freeing each one's packed data once unpacked 
+            # if asked, unless it is to be cached
+            attr_dict = self.histogram_attribute_functions
+            if lazy:
+                attr_dict = {k:v for k, v in attr_dict.items() if k != 'data'}
+            elif release and key is None:
+                mud.set_release_hists(fh, True)
+
             self._read_mdict(fh=fh,
                              get_n=mud.get_hists,
-                             attr_dict=self.histogram_attribute_functions,
+                             attr_dict=attr_dict,
                              attr_name='hist',
                              obj_class=mhist
                              )
 
+            if lazy:
+                self._set_lazy_hist(fh)
+
             # Read scalers
             self._read_mdict(fh=fh,
                              get_n=mud.get_scalers,
@@ -290,11 +348,47 @@ class mdata(object):
                              obj_class=mcomment
                              )
 
+            # Add decoded copy to cache
+            if key is not None:
+                mcache.write(fh, key)
+
         # Close file ----------------------------------------------------------
         finally:
             mud.close_read(fh)
 
-        # set the date
+        self._filename = filename
+        self._set_dates()
+
+    # ======================================================================= #
+    def _set_lazy_hist(self, fh):
+        """
+            Set histogram data to be unpacked from a memory map of the file 
+            on first access, or read them now if they cannot be mapped.
+
+            fh:         file header
+        """
+
+        mapping = None
+        for h in self.__dict__.get('hist', {}).values():
+
+            location = mud.get_hist_data_location(fh, h.id_number)
+            if location is None:
+                h.data = mud.get_hist_data(fh, h.id_number)
+                continue
+
+            if mapping is None:
+                mapping = mud.get_file_mapping(fh)
+
+            h.data = mhist_lazy(mud.unpack_hist_data, mapping, *location,
+                                h.n_bins,
+                                mud.get_hist_bytes_per_bin(fh, h.id_number))
+
+    # ======================================================================= #
+    def _set_dates(self):
+        """
+            Set human-readable dates and year from the epoch times.
+        """
+
         try:
             self.start_date = time.ctime(self.start_time)
             self.year = time.gmtime(self.start_time).tm_year
@@ -338,7 +432,8 @@ class mdata(object):
                 getattr(self, attr_name)[obj.title] = obj
 
     # ======================================================================= #
-    def _write_mdict(self, fh, set_n, attr_dict, attr_name, typeid):
+    def _write_mdict(self, fh, set_n, attr_dict, attr_name, typeid,
+                     bytes_per_bin=None):
         """
             Read all of a type of objects from MUD file and set its attributes,
             place in mdict.
@@ -348,6 +443,7 @@ class mdata(object):
             attr_dict:  dictionary which links attribute name and mudpy function
             attr_name:  main attribute name. Ex: hist, scaler, or ivar
             typeid:     int value specifying the type of data to write
+            bytes_per_bin:  if not None, bytes per bin of histograms
         """
 
         # get mdict object
@@ -375,6 +471,8 @@ class mdata(object):
             # set initial
             if attr_name == 'hist':
                 set_fn['htype'](fh, i+1, getattr(obj, 'htype'))
+                if bytes_per_bin is not None:
+                    mud.set_hist_bytes_per_bin(fh, i+1, bytes_per_bin)
 
             # iterate over attributes
             for k in attr_dict.keys():
@@ -387,6 +485,16 @@ class mdata(object):
                 except AttributeError:
                     pass
 
+    # ======================================================================= #
+    def export(self, filename):
+        """
+            Write the run, as it is now, to filename in the columnar format 
+            of mudpy.mcolumnar, for fast repeated reading with 
+            mcolumnar.load.
+        """
+
+        mcolumnar.write(self, filename)
+
     # ======================================================================= #
     def set_description(self, mode):
         """
@@ -401,11 +509,30 @@ class mdata(object):
             raise RuntimeError('Mode must be one of "TD" or "TI"')
 
     # ======================================================================= #
-    def write(self, filename):
+    def write(self, filename, stream=False, pack_threads=None,
+              bytes_per_bin=None):
         """
             Write object to MUD file.
+            
+            stream:         if True, write each histogram to the file as it 
+                            is packed, rather than packing the whole run in 
+                            memory first (see 
+                            mud_friendly_wrapper.open_write_stream)
+            pack_threads:   if not None, pack the histograms all at once on 
+                            this many threads (-1: one per processor) when 
+                            the file is closed (see 
+                            mud_friendly_wrapper.set_pack_threads). Not 
+                            with stream.
+            bytes_per_bin:  if not None, store the histograms with this many 
+                            bytes per bin: 0 (packed, as by default), 1 or 
+                            2 (bins truncated), 4, or 
+                            mud_friendly_wrapper.BIN_SIZE_DELTA (zigzag 
+                            deltas of the bins, smaller for decay curves)
         """
 
+        if stream and pack_threads is not None:
+            raise ValueError('pack_threads cannot be used with stream')
+
         # check that all needed attributes are set
         for attr in self.default_attributes:
             if hasattr(self, attr):
@@ -427,7 +554,26 @@ class mdata(object):
                                 'of "TD" or "TI"') from None
 
         # get file header
-        fh = mud.open_write(filename, method['file'])
+        if stream:
+            fh = mud.open_write_stream(filename, method['file'])
+        else:
+            fh = mud.open_write(filename, method['file'])
+            if pack_threads is not None:
+                mud.set_pack_threads(fh, pack_threads)
+
+        # histograms go last when streaming: they start the file
+        groups = ['hist', 'sclr', 'ivar', 'comments']
+        if stream:
+            groups = groups[1:] + groups[:1]
+
+        set_n = {'hist': mud.set_hists,
+                 'sclr': mud.set_scalers,
+                 'ivar': mud.set_ivars,
+                 'comments': mud.set_comments}
+        attr_dict = {'hist': self.histogram_attribute_functions,
+                     'sclr': self.scaler_attribute_functions,
+                     'ivar': self.variable_attribute_functions,
+                     'comments': self.comment_attribute_functions}
 
         # Write file body -----------------------------------------------------
         try:
@@ -445,37 +591,15 @@ class mdata(object):
                         func = getattr(mud, "set_"+func_name)
                         func(fh, val)
 
-            # histograms
-            self._write_mdict(fh=fh,
-                             set_n=mud.set_hists,
-                             attr_dict=self.histogram_attribute_functions,
-                             attr_name='hist',
-                             typeid=method['hist']
-                             )
-
-            # scalers
-            self._write_mdict(fh=fh,
-                             set_n=mud.set_scalers,
-                             attr_dict=self.scaler_attribute_functions,
-                             attr_name='sclr',
-                             typeid=method['sclr']
-                             )
-
-            # independent variables
-            self._write_mdict(fh=fh,
-                             set_n=mud.set_ivars,
-                             attr_dict=self.variable_attribute_functions,
-                             attr_name='ivar',
-                             typeid=method['ivar']
-                             )
-
-            # comments
-            self._write_mdict(fh=fh,
-                             set_n=mud.set_comments,
-                             attr_dict=self.comment_attribute_functions,
-                             attr_name='comments',
-                             typeid=method['comments']
-                             )
+            # histograms, scalers, independent variables, comments
+            for attr_name in groups:
+                self._write_mdict(fh=fh,
+                                 set_n=set_n[attr_name],
+                                 attr_dict=attr_dict[attr_name],
+                                 attr_name=attr_name,
+                                 typeid=method[attr_name],
+                                 bytes_per_bin=bytes_per_bin,
+                                 )
 
         # Close file with no write --------------------------------------------
         except Exception as err:
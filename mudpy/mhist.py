@@ -1,5 +1,6 @@
 from .mcontainer import mcontainer
 import numpy as np
+import pickle
 
 class mhist(mcontainer):
     """
@@ -21,9 +22,22 @@ class mhist(mcontainer):
             good_bin2
             background1
             background2
+
+        data may be given as an mhist_lazy, which is called to get the 
+        array on first access (see mdata(filename, lazy=True)).
+
+        With pickle protocol 5, data (read first if lazy) are pickled as a
+        PickleBuffer, which can be passed out-of-band (buffer_callback), and
+        are not copied when unpickled.
     """
 
-    __slots__ = ('id_number', 'htype', 'title', 'data', 'n_bytes', 'n_bins',
+    # data fields, in __init__ order
+    _fields = ('id_number', 'htype', 'title', 'data', 'n_bytes', 'n_bins',
+               'n_events', 'fs_per_bin', 's_per_bin', 't0_ps', 't0_bin',
+               'good_bin1', 'good_bin2', 'background1', 'background2')
+
+    # data is kept in _data, and read through on first access if lazy
+    __slots__ = ('id_number', 'htype', 'title', '_data', 'n_bytes', 'n_bins',
                  'n_events', 'fs_per_bin', 's_per_bin', 't0_ps', 't0_bin',
                  'good_bin1', 'good_bin2', 'background1', 'background2')
 
@@ -62,6 +76,31 @@ class mhist(mcontainer):
 
     def _get_val(self):                 return self.data
 
+    @property
+    def data(self):
+        data = self._data
+        if type(data) is mhist_lazy:
+            data = self._data = data.func(*data.args)
+        return data
+
+    @data.setter
+    def data(self, data):               self._data = data
+
+    @data.deleter
+    def data(self):                     del self._data
+
+    # pickling
+    def __reduce_ex__(self, protocol):
+        values = [getattr(self, k) for k in self._fields]
+        data = values[3]
+        if protocol >= 5 and isinstance(data, np.ndarray) and \
+                not data.dtype.hasobject:
+            data = np.ascontiguousarray(data)
+            values[3] = None
+            return (_unpickle, (type(self), values, pickle.PickleBuffer(data),
+                                data.dtype.str, data.shape))
+        return (_unpickle, (type(self), values))
+
     # list operators
     def __contains__(self, val):        return val in self.data
     def __iter__(self):                 return self.data.__iter__()
@@ -89,7 +128,7 @@ class mhist(mcontainer):
     def __ixor__(self, other):      self.data.__ixor__(self._get_oval(other)); return self
 
     # dict-like
-    def keys(self):                 return self.__slots__
+    def keys(self):                 return self._fields
 
     # copied from np.ndarray
     def all(self, *args, **kwargs):             return self.data.all(*args, **kwargs)
@@ -161,3 +200,25 @@ class mhist(mcontainer):
     def transpose(self, *args, **kwargs):       return self.data.transpose(*args, **kwargs)
     def var(self, *args, **kwargs):             return self.data.var(*args, **kwargs)
     def view(self, *args, **kwargs):            return self.data.view(*args, **kwargs)
+
+class mhist_lazy(object):
+    """
+        Histogram data not yet read: func(*args) returns the array.
+    """
+
+    __slots__ = ('func', 'args')
+
+    def __init__(self, func, *args):
+        self.func = func
+        self.args = args
+
+    def __repr__(self):
+        return 'mhist_lazy()'
+
+def _unpickle(cls, values, buffer=None, dtype=None, shape=None):
+    """
+        Make histogram from pickled values, and data from buffer if given.
+    """
+    if buffer is not None:
+        values[3] = np.frombuffer(buffer, dtype=dtype).reshape(shape)
+    return cls(*values)
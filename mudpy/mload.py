@@ -0,0 +1,296 @@
+# Read many runs at once
+# agent
+# Oct 2026
+
+import mudpy.mud_friendly_wrapper as mud
+from mudpy.mdata import mdata
+from mudpy.containers import mlist, mhist_lazy
+from mudpy.mhist import mhist
+from concurrent.futures import ThreadPoolExecutor, ProcessPoolExecutor
+from multiprocessing import shared_memory, resource_tracker
+import glob, itertools, mmap, os, secrets
+import numpy as np
+
+try:
+    import _posixshmem
+except ImportError:
+    _posixshmem = None
+
+__doc__="""
+    Read a list of runs into mdata objects on a pool of threads, or of
+    processes.
+
+    load_many: runs are decoded in C (MUD_openRead) without holding the
+    GIL, so the decoding of as many runs as there are threads overlaps;
+    only the building of the Python objects of each run is done one thread
+    at a time. Each thread uses its own file handle, of which the friendly
+    interface has MUD_MAX_FILES (64).
+
+    load_shared: each run is read by a worker process, which unpacks the
+    histograms straight into shared memory blocks (uint32, as with lazy
+    reading) and sends back the rest of the run. The parent maps the
+    blocks, without copying, and unlinks them at once, so that they are
+    freed with the arrays. Blocks of runs not mapped, because the parent
+    was interrupted or a worker died, are unlinked before load_shared
+    returns or raises. Only on POSIX systems; elsewhere the histograms are
+    pickled back.
+
+    Functions:
+        load_many(paths, workers, lazy):    read runs into an mlist of mdata
+        load_shared(paths, processes):      read runs in worker processes
+
+    Exceptions:
+        LoadError:  raised by load_many or load_shared if any run could not
+                    be read
+"""
+
+# most threads reading at once, leaving file handles for other uses
+MAX_WORKERS = 48
+
+# where POSIX shared memory blocks are listed, if anywhere
+SHM_DIR = '/dev/shm'
+
+# blocks made by this worker process
+_blocks_made = itertools.count()
+
+# =========================================================================== #
+class LoadError(RuntimeError):
+    """
+        Runs that could not be read by load_many.
+
+        errors: list of (path, exception) of each run that failed, in input
+                order
+        runs:   mlist of the runs read, in input order, with None in place
+                of those that failed
+    """
+
+    def __init__(self, errors, runs):
+        self.errors = errors
+        self.runs = runs
+        lines = ['%s: %s' % (path, err) for path, err in errors]
+        super().__init__('Could not read %d of %d runs\n    %s' % \
+                         (len(errors), len(runs), '\n    '.join(lines)))
+
+# =========================================================================== #
+def load_many(paths, workers=None, lazy=False):
+    """
+        Read runs and return mlist of mdata, in the order of paths.
+
+        paths:      list of MUD files
+        workers:    number of runs to read at once (None: one per processor,
+                    at most MAX_WORKERS)
+        lazy:       if True, read histogram data only when first accessed
+                    (see mdata)
+
+        Raises LoadError, with the error of each run that failed and the
+        runs that were read, if any run could not be read.
+    """
+
+    paths = [os.fspath(p) for p in paths]
+
+    if workers is None:
+        workers = os.cpu_count() or 1
+    workers = max(1, min(workers, MAX_WORKERS, len(paths)))
+
+    def read(path):
+        try:
+            return (mdata(path, lazy=lazy), None)
+        except Exception as err:
+            return (None, err)
+
+    if workers == 1:
+        results = [read(p) for p in paths]
+    else:
+        with ThreadPoolExecutor(max_workers=workers) as pool:
+            results = list(pool.map(read, paths))
+
+    runs = mlist([run for run, _ in results])
+    errors = [(p, err) for p, (_, err) in zip(paths, results) if err is not None]
+
+    if errors:
+        raise LoadError(errors, runs)
+
+    return runs
+
+# =========================================================================== #
+def load_shared(paths, processes=None):
+    """
+        Read runs in worker processes and return mlist of mdata, in the
+        order of paths, with histogram data (uint32) in shared memory.
+
+        paths:      list of MUD files
+        processes:  number of worker processes (None: one per processor)
+
+        Raises LoadError, with the error of each run that failed and the
+        runs that were read, if any run could not be read.
+    """
+
+    paths = [os.fspath(p) for p in paths]
+
+    runs = mlist([None]*len(paths))
+    errors = []
+    if not paths:
+        return runs
+
+    processes = max(1, min(processes or os.cpu_count() or 1, len(paths)))
+
+    # names of the blocks of this call, to find those left behind
+    prefix = 'mudl%s_' % secrets.token_hex(4)
+
+    with ProcessPoolExecutor(max_workers=processes) as pool:
+        futures = [pool.submit(_read_shared, p, prefix) for p in paths]
+
+        try:
+            # map the blocks of every run read, even after a failure, so
+            # that none is left behind
+            for i, (p, future) in enumerate(zip(paths, futures)):
+                try:
+                    runs[i] = _map_shared(future.result())
+                except Exception as err:
+                    errors.append((p, err))
+                futures[i] = None
+
+        # if interrupted, unlink the blocks of the runs not mapped, and
+        # those of runs a worker died reading
+        finally:
+            pool.shutdown(cancel_futures=True)
+            for future in futures:
+                if future is not None and not future.cancelled() and \
+                        future.exception() is None:
+                    _unlink_shared(future.result())
+            for path in glob.glob(os.path.join(SHM_DIR, prefix + '*')):
+                _unlink('/' + os.path.basename(path))
+
+    if errors:
+        raise LoadError(errors, runs)
+
+    return runs
+
+# =========================================================================== #
+class _shared_block(object):
+    """
+        Histogram data left in shared memory block name by a worker.
+    """
+
+    __slots__ = ('name', 'n_bins')
+
+    def __init__(self, name, n_bins):
+        self.name = name
+        self.n_bins = n_bins
+
+# =========================================================================== #
+def _new_block(n_bytes, name):
+    """
+        Create shared memory block name, not tracked by this process, which
+        would remove it on exit.
+    """
+
+    try:
+        return shared_memory.SharedMemory(name, create=True, size=n_bytes,
+                                          track=False)
+    except TypeError:
+        shm = shared_memory.SharedMemory(name, create=True, size=n_bytes)
+        resource_tracker.unregister(shm._name, 'shared_memory')
+        return shm
+
+# =========================================================================== #
+def _unlink(name):
+    """
+        Unlink shared memory block name, if still there.
+    """
+
+    try:
+        _posixshmem.shm_unlink(name)
+    except OSError:
+        pass
+
+# =========================================================================== #
+def _read_shared(path, prefix):
+    """
+        Worker: read run, with the histogram data unpacked into shared
+        memory blocks named from prefix, and return it.
+    """
+
+    if _posixshmem is None:
+        return mdata(path)
+
+    run = mdata(path, lazy=True)
+    blocks = []
+
+    try:
+        for h in run.__dict__.get('hist', {}).values():
+
+            # unread data, and how to read them
+            lazy = h._data
+            n_bins = h.n_bins
+            if n_bins == 0:
+                h.data = np.zeros(0, dtype=np.uint32)
+                continue
+
+            shm = _new_block(4*n_bins, '%s%d_%d' % (prefix, os.getpid(),
+                                                    next(_blocks_made)))
+            blocks.append(shm)
+            out = np.ndarray(n_bins, dtype=np.uint32, buffer=shm.buf)
+            if type(lazy) is mhist_lazy and lazy.func is mud.unpack_hist_data:
+                lazy.func(*lazy.args, out=out)
+            else:
+                out[:] = h.data
+            del out
+
+            h.data = _shared_block(shm.name, n_bins)
+    except:
+        for shm in blocks:
+            shm.close()
+            shm.unlink()
+        raise
+
+    for shm in blocks:
+        shm.close()
+
+    return run
+
+# =========================================================================== #
+def _shared_blocks(run):
+    """
+        Histograms of run from _read_shared with data in shared memory.
+    """
+
+    return [h for h in run.__dict__.get('hist', {}).values()
+            if type(h._data) is _shared_block]
+
+# =========================================================================== #
+def _unlink_shared(run):
+    """
+        Unlink the shared memory blocks of run from _read_shared, unmapped.
+    """
+
+    for h in _shared_blocks(run):
+        _unlink('/' + h._data.name)
+
+# =========================================================================== #
+def _map_shared(run):
+    """
+        Replace the shared memory blocks of run from _read_shared by arrays
+        mapping them, and unlink the blocks, all of them even if one cannot
+        be mapped.
+    """
+
+    hists = _shared_blocks(run)
+    names = ['/' + h._data.name for h in hists]
+
+    try:
+        for h, name in zip(hists, names):
+            block = h._data
+            fd = _posixshmem.shm_open(name, os.O_RDWR, mode=0o600)
+            try:
+                mapping = mmap.mmap(fd, 4*block.n_bins)
+            finally:
+                os.close(fd)
+
+            h.data = np.frombuffer(mapping, dtype=np.uint32,
+                                   count=block.n_bins)
+    finally:
+        for name in names:
+            _unlink(name)
+
+    return run
@@ -0,0 +1,291 @@
+# Cache of decoded runs in shared memory
+# agent
+# Oct 2026
+
+from mudpy import mcolumnar
+import mudpy.mud_friendly_wrapper as mud
+import hashlib
+import mmap
+import os
+import tempfile
+import numpy as np
+
+try:
+    import _posixshmem, fcntl
+except ImportError:
+    _posixshmem = None
+
+__doc__="""
+    Opt-in cache of decoded runs in shared memory, for mdata, shared by all
+    processes on the machine.
+
+    When enabled, mdata(filename) first looks for a shared memory segment
+    holding the run, keyed by the path, size and modification time of the
+    MUD file. On a hit the segment is mapped, read-only, and the run is
+    read from it without decoding; on a miss the run is decoded once into
+    a new segment, which this and later processes then map. Segments hold
+    the run in the columnar format of mudpy.mcolumnar (a JSON header and
+    uint32 histogram data), and are never changed once written.
+
+    Each process mapping a segment holds a shared lock (flock) on it until
+    the histogram arrays read from it are freed; the lock is dropped by
+    the system if the process exits. The cache is bounded by max_bytes:
+    least-recently used segments are removed once it grows past it, but
+    only if no process holds them. A segment is written under an exclusive
+    lock and its magic number is written last, so that a run being written,
+    or left half-written by a process that died, is not read (it is decoded
+    instead, and a half-written segment is removed).
+
+    Segments are created readable by all users, so that runs are shared
+    between them, but can only be removed by the user who created them.
+    Only on Linux, where segments are listed in /dev/shm.
+
+    Trust: any user can create a segment of any name, holding any run, so
+    a segment is read only if it was created by the user reading it, or
+    by the owner of the MUD file (whose uid is part of the name), who
+    could change the file anyway. Segments created by anyone else are
+    removed, if allowed, and the run is decoded from the file instead.
+
+    Functions:
+        enable(max_bytes):      start using cache
+        disable():              stop using cache
+        clear():                remove all cached runs not in use
+"""
+
+PREFIX = 'mudpy-'
+SHM_DIR = '/dev/shm'
+
+# cache settings, set by enable
+_enabled = False
+_max_bytes = 0
+
+# =========================================================================== #
+def enable(max_bytes=2**30):
+    """
+        Cache decoded runs in shared memory, using at most max_bytes of it.
+    """
+
+    global _enabled, _max_bytes
+
+    if _posixshmem is None or not os.path.isdir(SHM_DIR):
+        raise RuntimeError('Shared memory cache needs POSIX shared memory '+\
+                           'listed in %s' % SHM_DIR)
+
+    _enabled = True
+    _max_bytes = int(max_bytes)
+
+# =========================================================================== #
+def disable():
+    """
+        Stop using the cache. Cached runs are kept, and runs read from it
+        stay valid.
+    """
+
+    global _enabled
+    _enabled = False
+
+# =========================================================================== #
+def clear():
+    """
+        Remove all runs from the cache which are not in use.
+    """
+
+    for name, _ in _entries():
+        _remove(name)
+
+# =========================================================================== #
+def get_key(filename):
+    """
+        Return the segment name for a MUD file, or None if the cache is not
+        enabled.
+    """
+
+    if not _enabled:
+        return None
+
+    filename = os.path.abspath(filename)
+    try:
+        stat = os.stat(filename)
+    except OSError:
+        return None
+
+    key = hashlib.blake2b(digest_size=20)
+    key.update(('%s\0%d\0%d\0%d' % (filename, stat.st_size, stat.st_mtime_ns,
+                                    mcolumnar.VERSION)).encode())
+    return '%s%d-%s' % (PREFIX, stat.st_uid, key.hexdigest())
+
+# =========================================================================== #
+def read(data, key):
+    """
+        Set the attributes of mdata object data from the cache.
+        Return True on success, False if the run is not cached, is being
+        written, or is not trusted (see module doc).
+    """
+
+    try:
+        fd = _posixshmem.shm_open('/' + key, os.O_RDONLY, mode=0o444)
+    except OSError:
+        return False
+
+    try:
+        if os.fstat(fd).st_uid not in (os.getuid(), _get_owner(key)):
+            _remove(key)
+            return False
+
+        try:
+            fcntl.flock(fd, fcntl.LOCK_SH | fcntl.LOCK_NB)
+        except OSError:
+            return False    # being written
+
+        size = os.fstat(fd).st_size
+        if os.pread(fd, len(mcolumnar.MAGIC), 0) != mcolumnar.MAGIC:
+
+            # left half-written
+            if size > 0:
+                fcntl.flock(fd, fcntl.LOCK_UN)
+                _remove(key)
+            return False
+
+        # mark as recently used, if ours
+        try:
+            os.utime(fd)
+        except OSError:
+            pass
+
+        return _attach(data, fd, size)
+    finally:
+        os.close(fd)
+
+# =========================================================================== #
+def write(file_handle, key):
+    """
+        Add the run open as file_handle to the cache. Failures are ignored.
+    """
+
+    try:
+        fd = _posixshmem.shm_open('/' + key, os.O_RDWR | os.O_CREAT | os.O_EXCL,
+                                  mode=0o644)
+    except OSError:
+        return      # cached, or being written by another process
+
+    temp = None
+    try:
+        # lock before sizing, so that a segment with a size but no magic
+        # number, which is not locked, was left by a process that died
+        fcntl.flock(fd, fcntl.LOCK_EX)
+        os.fchmod(fd, 0o644)
+
+        tfd, temp = tempfile.mkstemp(suffix='.mudc')
+        os.close(tfd)
+        mud.export_columnar(file_handle, temp)
+
+        size = os.path.getsize(temp)
+        if size > _max_bytes:
+            _posixshmem.shm_unlink('/' + key)
+            return
+        _evict(_max_bytes - size)
+
+        # reserve the memory now, rather than fail on writing to it
+        os.posix_fallocate(fd, 0, size)
+
+        with open(temp, 'rb') as fid, mmap.mmap(fd, size) as mapping:
+            magic = fid.read(len(mcolumnar.MAGIC))
+            with memoryview(mapping) as view:
+                fid.readinto(view[len(magic):])
+            mapping[:len(magic)] = magic
+
+    except (OSError, RuntimeError):
+        _posixshmem.shm_unlink('/' + key)
+
+    finally:
+        os.close(fd)
+        if temp is not None:
+            try:
+                os.remove(temp)
+            except OSError:
+                pass
+
+# =========================================================================== #
+def _get_owner(key):
+    """
+        Return the uid of the owner of the MUD file of segment key, or None.
+    """
+
+    try:
+        return int(key[len(PREFIX):].split('-', 1)[0])
+    except ValueError:
+        return None
+
+# =========================================================================== #
+def _attach(data, fd, size):
+    """
+        Map the segment open as fd, locked, and read data from it. The
+        mapping holds the lock until it is freed.
+    """
+
+    try:
+        mapping = mmap.mmap(fd, size, access=mmap.ACCESS_READ)
+        mcolumnar.read_buffer(data, np.frombuffer(mapping, dtype=np.uint8))
+    except (OSError, ValueError, KeyError, RuntimeError):
+        return False
+
+    return True
+
+# =========================================================================== #
+def _entries():
+    """
+        Return list of (name, stat) of cached runs, oldest first.
+    """
+
+    entries = []
+    try:
+        scan = list(os.scandir(SHM_DIR))
+    except OSError:
+        return entries
+
+    for entry in scan:
+        if entry.name.startswith(PREFIX):
+            try:
+                entries.append((entry.name, entry.stat()))
+            except OSError:
+                pass
+
+    entries.sort(key=lambda e: e[1].st_mtime_ns)
+    return entries
+
+# =========================================================================== #
+def _remove(name):
+    """
+        Remove segment name if no process holds it. Return True if removed.
+    """
+
+    try:
+        fd = _posixshmem.shm_open('/' + name, os.O_RDONLY, mode=0o444)
+    except OSError:
+        return False
+
+    try:
+        fcntl.flock(fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+        _posixshmem.shm_unlink('/' + name)
+    except OSError:
+        return False
+    finally:
+        os.close(fd)
+
+    return True
+
+# =========================================================================== #
+def _evict(max_bytes):
+    """
+        Remove least-recently used runs not in use until the cache fits in
+        max_bytes.
+    """
+
+    entries = _entries()
+    total = sum(stat.st_size for _, stat in entries)
+
+    for name, stat in entries:
+        if total <= max_bytes:
+            break
+        if _remove(name):
+            total -= stat.st_size
@@ -0,0 +1,72 @@
+# Sum histograms over many runs
+# agent
+# Oct 2026
+
+import mudpy.mud_friendly_wrapper as mud
+import os
+
+__doc__="""
+    Sum histograms over a list of runs without reading each run into an
+    mdata.
+
+    The runs are read in C by MUD_sumHists in mud_sum.c, on a pool of
+    threads. Each thread reads only the histogram group of one run at a
+    time and adds it into a single uint64 sum, so the memory needed is that
+    of the sum and of one run per thread, whatever the number of runs.
+
+    Functions:
+        sum_hists(filenames, hists, threads):   sum histograms of runs
+"""
+
+# =========================================================================== #
+def sum_hists(filenames, hists=None, threads=None):
+    """
+        Sum histograms over runs and return dict of uint64 arrays, keyed by
+        histogram title.
+
+        filenames:  list of MUD files, all with the same histograms
+        hists:      list of histogram titles or id numbers (1-based) to sum,
+                    None for all, all with the same number of bins. Titles
+                    and number of bins are those of the first run.
+        threads:    number of runs to read at once (None: one per processor)
+
+        Raises RuntimeError if any run could not be read, or lacks one of
+        hists, or has a different number of bins.
+    """
+
+    filenames = [os.fspath(f) for f in filenames]
+    if not filenames:
+        raise ValueError('No runs to sum')
+
+    # histogram ids, titles, and number of bins from the first run
+    fh = mud.open_read(filenames[0])
+    try:
+        n = mud.get_hists(fh)[1]
+        titles = [mud.get_hist_title(fh, i) for i in range(1, n+1)]
+
+        if hists is None:
+            ids = list(range(1, n+1))
+        else:
+            ids = []
+            for h in hists:
+                if isinstance(h, str):
+                    if h not in titles:
+                        raise KeyError('No histogram titled %s' % h)
+                    ids.append(titles.index(h)+1)
+                elif 1 <= h <= n:
+                    ids.append(int(h))
+                else:
+                    raise KeyError('No histogram number %d' % h)
+
+        n_bins = mud.get_hist_n_bins(fh, ids[0]) if ids else 0
+    finally:
+        mud.close_read(fh)
+
+    # sum
+    total, ok = mud.sum_hists(filenames, ids, n_bins, threads or 0)
+
+    if not ok.all():
+        bad = [f for f, k in zip(filenames, ok) if not k]
+        raise RuntimeError('Could not sum histograms of %s' % ', '.join(bad))
+
+    return {titles[i-1]: total[j] for j, i in enumerate(ids)}
@@ -0,0 +1,75 @@
+# Generate synthetic runs
+# agent
+# Oct 2026
+
+import mudpy.mud_friendly_wrapper as mud
+
+__doc__="""
+    Deterministic synthetic MUD files, for tests and benchmarks.
+
+    Runs are written by MUD_writeSynth in mud_synth.c (also available as
+    the command line tool mud_synth). Histograms follow an exponential decay
+    on a flat background with Poisson noise, and scalers, independent
+    variables and comments are filled with plausible values. All of it is
+    drawn from a generator seeded with seed, so the same arguments always
+    give a byte-identical file.
+
+    Files are written a section at a time, so runs of any size up to the
+    4 GB limit of the MUD format can be generated without holding the run
+    in memory.
+
+    Functions:
+        generate(filename, mode, seed, ...):    write synthetic run
+"""
+
+# keyword arguments of generate and the MUD_SYNTH fields they set
+_options = {'n_hist':           'nHists',
+            'n_bins':           'nBins',
+            'bytes_per_bin':    'bytesPerBin',
+            'counts':           'counts',
+            'tau':              'tau',
+            'background':       'background',
+            'n_scalers':        'nScalers',
+            'n_ivars':          'nIndVars',
+            'n_ivar_data':      'nIndVarData',
+            'n_comments':       'nComments',
+            }
+
+# =========================================================================== #
+def generate(filename, mode='TD', seed=1, n_hist=None, n_bins=None,
+             bytes_per_bin=None, counts=None, tau=None, background=None,
+             n_scalers=None, n_ivars=None, n_ivar_data=None, n_comments=None):
+    """
+        Write a synthetic run to filename and return filename.
+
+        mode:           'TD' or 'TI'
+        seed:           random seed
+        n_hist:         number of histograms
+        n_bins:         bins per histogram
+        bytes_per_bin:  0 (packed), 1, 2, 4, or BIN_SIZE_DELTA (zigzag 
+                        deltas, see mud_friendly_wrapper)
+        counts:         mean counts at t0, less background
+        tau:            decay time in bins (0: n_bins/8)
+        background:     mean background counts per bin
+        n_scalers:      number of scalers
+        n_ivars:        number of independent variables
+        n_ivar_data:    length of independent variable arrays (TI only)
+        n_comments:     number of comments
+
+        Arguments left as None take the defaults of a typical run of type
+        mode.
+    """
+
+    if mode == 'TD':
+        file_type = mud.FMT_TRI_TD_ID
+    elif mode == 'TI':
+        file_type = mud.FMT_TRI_TI_ID
+    else:
+        raise ValueError("mode must be 'TD' or 'TI'")
+
+    args = locals()
+    options = {field: args[key] for key, field in _options.items()
+               if args[key] is not None}
+
+    mud.write_synthetic(filename, file_type, seed, options)
+    return filename
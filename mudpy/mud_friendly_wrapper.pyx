@@ -11,9 +11,11 @@ Function list:
     FILE IO
         open_read
         close_read
+        write_index
             
         open_write
         open_readwrite
+        open_write_stream
         close_write
         close_writefile
         
@@ -90,7 +92,14 @@ Function list:
         get_hist_title
         get_hist_sec_per_bin
         get_hist_data
+        get_hist_data_rebinned
+        get_hist_asym
+        get_hist_data_location
+        get_file_mapping
+        unpack_hist_data
         get_hist_data_pointer
+        release_hist
+        set_release_hists
         
         set_hists
         set_hist_type
@@ -150,6 +159,18 @@ Function list:
         set_ivar_data_type
         set_ivar_data
         set_ivar_time_data
+        
+    EXPORT
+        export_columnar
+        
+    SYNTHETIC RUNS
+        write_synthetic
+        
+    HISTOGRAM SUMS
+        sum_hists
+        
+    PERFORMANCE COUNTERS
+        get_stats
                 
 Derek Fujimoto 
 July 2017
@@ -158,17 +179,28 @@ July 2017
 import numpy as np
 cimport numpy as np
 from cpython cimport array
+from libc.stdint cimport uint64_t
 import array
+import mmap
+import sys
 
 ### ======================================================================= ###
 # CONSTANTS
 ### ======================================================================= ###
 character_encoding = "latin1"
+
+# files opened with open_read, by handle: [mmap or None, releasing 
+# histograms], for get_file_mapping
+_mapped = {}
 DEF TITLE_CHAR_SIZE = 256
 DEF COMMENT_CHAR_SIZE = 8192
 
 cdef extern from 'mud.h':
     
+    int MUD_SEC_GEN_HIST_unpackChecked(int num, int inBinSize, void* inHist, 
+                                       unsigned int nBytes, int outBinSize, 
+                                       void* outHist) nogil
+    
     # Lab identifiers
     cdef int MUD_LAB_ALL_ID
     cdef int MUD_LAB_TRI_ID
@@ -211,6 +243,9 @@ cdef extern from 'mud.h':
     cdef int MUD_SEC_TRI_TI_RUN_DESC_ID
     cdef int MUD_SEC_TRI_TI_HIST_ID
     cdef int MUD_GRP_TRI_TI_HIST_ID
+    
+    # bytes per bin of histograms stored as zigzag deltas
+    cdef int MUD_BIN_SIZE_DELTA
 
 # RAL format identifiers
 #~     cdef int MUD_SEC_RAL_RUN_DESC_ID
@@ -260,6 +295,9 @@ SEC_TRI_TI_RUN_DESC_ID = MUD_SEC_TRI_TI_RUN_DESC_ID
 SEC_TRI_TI_HIST_ID = MUD_SEC_TRI_TI_HIST_ID
 GRP_TRI_TI_HIST_ID = MUD_GRP_TRI_TI_HIST_ID
 
+# bytes per bin of histograms stored as zigzag deltas (set_hist_bytes_per_bin)
+BIN_SIZE_DELTA = MUD_BIN_SIZE_DELTA
+
 # RAL format identifiers
 #~ SEC_RAL_RUN_DESC_ID = MUD_SEC_RAL_RUN_DESC_ID
 #~ SEC_RAL_HIST_ID = MUD_SEC_RAL_HIST_ID
@@ -269,20 +307,42 @@ GRP_TRI_TI_HIST_ID = MUD_GRP_TRI_TI_HIST_ID
 # READ FILE IO
 ### ======================================================================= ###
 cdef extern from "mud_friendly.c":
-    int MUD_openRead(char* file_name, unsigned int* pType)
-    void MUD_closeRead(int file_handle)
+    int MUD_openRead(char* file_name, unsigned int* pType) nogil
+    void MUD_closeRead(int file_handle) nogil
+    unsigned int MUD_writeIndex(char* file_name)
     
 cpdef open_read(str file_name):
-    """Open file for reading. Returns file handle."""
+    """
+        Open file for reading. Returns file handle. 
+        
+        The file is decoded without holding the GIL, so that files can be 
+        read on several threads at once.
+    """
     cdef unsigned int file_type = 0
-    cdef int fh = MUD_openRead(file_name.encode(character_encoding), &file_type)
+    cdef bytes name = file_name.encode(character_encoding)
+    cdef char* c_name = name
+    cdef int fh
+    with nogil:
+        fh = MUD_openRead(c_name, &file_type)
     
     if fh < 0:  raise RuntimeError('MUD_openRead failed.')
+    _mapped[fh] = [None, False]
     return <int>fh
 
 cpdef close_read(int file_handle):
     """Closes open file without writing anything."""
-    MUD_closeRead(file_handle)
+    _mapped.pop(file_handle, None)
+    with nogil:
+        MUD_closeRead(file_handle)
+
+cpdef write_index(str file_name):
+    """
+        Write the sidecar section index (file_name + '.idx') used by 
+        open_read to find sections directly and read histogram data only 
+        when asked for. The index is ignored once the file is modified.
+    """
+    if not MUD_writeIndex(file_name.encode(character_encoding)):
+        raise RuntimeError('MUD_writeIndex failed.')
     
 ### ======================================================================= ###
 # WRITE FILE IO
@@ -290,8 +350,10 @@ cpdef close_read(int file_handle):
 cdef extern from "mud_friendly.c":
     int MUD_openWrite(char* file_name, unsigned int pType)
     int MUD_openReadWrite(char* file_name, unsigned int* pType)
-    void MUD_closeWrite(int file_handle)
+    int MUD_openWriteStream(char* file_name, unsigned int pType)
+    int MUD_closeWrite(int file_handle) nogil
     void MUD_closeWriteFile(int file_handle, char* file_name)
+    int MUD_setPackThreads(int file_handle, int nThreads)
     
 cpdef open_write(str file_name, unsigned int file_type):
     """
@@ -319,12 +381,49 @@ cpdef open_readwrite(str file_name):
     if fh < 0:  raise RuntimeError('MUD_openWrite failed.')
     return <int>fh
     
+cpdef open_write_stream(str file_name, unsigned int file_type):
+    """
+        Open file for writing a new MUD file as it is built. Histogram data 
+        are written to the file as they are set, after their headers, and 
+        released. The file is laid out as close_write would write the run.
+        
+        Set up the run description, comments, scalers and independent 
+        variables before the histograms (set_hists), and set each 
+        histogram's data only once, in order of histogram number. Anything 
+        else may be changed until close_write, but not in size (strings 
+        must keep their length).
+        
+        file_name:      string, file name 
+        file_type:      int, as for open_write
+        Returns file handle.
+    """
+    cdef int fh = MUD_openWriteStream(file_name.encode(character_encoding),
+                                      file_type)
+    if fh < 0:  raise RuntimeError('MUD_openWriteStream failed.')
+    return <int>fh
+    
+cpdef set_pack_threads(int file_handle, int n_threads):
+    """
+        Pack histograms (bytes per bin 0) when the file is closed, all at 
+        once on n_threads threads (-1: one per processor), rather than as 
+        their data are set. 0 packs them as they are set again. Not for 
+        files opened with open_write_stream.
+    """
+    if not MUD_setPackThreads(file_handle, n_threads):
+        raise RuntimeError('MUD_setPackThreads failed.')
+
 cpdef close_write(int file_handle):
     """Writes changes to file and closes."""
-    MUD_closeWrite(file_handle)
+    cdef int ok
+    _mapped.pop(file_handle, None)
+    with nogil:
+        ok = MUD_closeWrite(file_handle)
+    if not ok:
+        raise RuntimeError('MUD_closeWrite failed.')
     
 cpdef close_writefile(int file_handle, str file_name):
     """Writes changes to a new file and close both"""
+    _mapped.pop(file_handle, None)
     MUD_closeWriteFile(file_handle, file_name.encode(character_encoding))
     
 
@@ -763,7 +862,15 @@ cdef extern from "mud_friendly.c":
 
     int MUD_getHistSecondsPerBin( int fh, int num, double* pSecondsPerBin )
 
-    int MUD_getHistData( int fh, int num, void* pData )
+    int MUD_getHistData( int fh, int num, void* pData ) nogil
+    int MUD_getHistDataRebinned( int fh, int num, int factor, uint64_t* pData )
+    int MUD_getHistAsym( int fh, int numF, int numB, double* pAsym, double* pErr )
+    int MUD_releaseHist( int fh, int num )
+    int MUD_setReleaseHists( int fh, int release )
+    int MUD_getHistDataOffset( int fh, int num, unsigned int* pOffset )
+    int MUD_getHistDataLocation( int fh, int num, unsigned int* pOffset, 
+                                 unsigned int* pNumBytes )
+    int MUD_getFileNo( int fh )
     int MUD_getHistpData( int fh, int num, void** ppData )
         
 cpdef get_hists(int file_handle):
@@ -872,14 +979,168 @@ cpdef get_hist_sec_per_bin(int file_handle, int id_number):
         raise RuntimeError('MUD_getHistSecondsPerBin failed.')
     return <float>value    
 
-cpdef get_hist_data(int file_handle, int id_number):
-    """Returns numpy array of ints: values contained in each histogram bin."""
+def _unpacked_dtype(bytes_per_bin):
+    """numpy dtype of histogram bins of bytes_per_bin, when unpacked"""
+    return {1: np.uint8, 2: np.uint16}.get(bytes_per_bin, np.uint32)
+
+cpdef get_hist_data(int file_handle, int id_number, mapped=False):
+    """
+        Returns numpy array of ints: values contained in each histogram bin.
+        
+        If mapped, histograms of files opened with open_read and stored 
+        unpacked with 4 bytes per bin are not read: a read-only uint32 view 
+        of get_file_mapping is returned, which keeps the mapping open after 
+        close_read. The view shows any later change to the file in place, 
+        and truncating the file makes reading it fail with SIGBUS.
+    """
+    cdef unsigned int offset
     nbins = get_hist_n_bins(file_handle, id_number)
-    cdef array.array a = array.array('i',[0]*nbins)
-    if not MUD_getHistData(file_handle, id_number,&a.data.as_ints[0]):
+    
+    entry = _mapped.get(file_handle, None)
+    if mapped and entry is not None and nbins > 0 and \
+            MUD_getHistDataOffset(file_handle, id_number, &offset):
+        view = np.frombuffer(get_file_mapping(file_handle), dtype='<u4', 
+                             count=nbins, offset=offset)
+        if entry[1]:
+            MUD_releaseHist(file_handle, id_number)
+        return view
+    
+    # bins of 1 or 2 bytes are unpacked as they are, others to 4 bytes
+    dtype = _unpacked_dtype(get_hist_bytes_per_bin(file_handle, id_number))
+    cdef np.ndarray a = np.zeros(max(nbins, 1), dtype=dtype)
+    cdef void* pdata = <void*>a.data
+    cdef int ok
+    with nogil:
+        ok = MUD_getHistData(file_handle, id_number, pdata)
+    if not ok:
         raise RuntimeError('MUD_getHistData failed.')
-    cdef int[:] ca = a
-    return np.array(ca,dtype=int)
+    return a[:nbins].astype(int)
+
+cpdef get_hist_data_rebinned(int file_handle, int id_number, int factor):
+    """
+        Returns numpy array of ints: sums of each factor adjacent bins, 
+        computed while unpacking. The last element holds the leftover bins 
+        if factor does not divide the number of bins.
+    """
+    if factor < 1:
+        raise ValueError('factor must be at least 1')
+    nbins = get_hist_n_bins(file_handle, id_number)
+    cdef np.ndarray[np.int64_t, ndim=1, mode='c'] a = \
+        np.empty((nbins+factor-1)//factor, dtype=np.int64)
+    if not MUD_getHistDataRebinned(file_handle, id_number, factor, 
+                                   <uint64_t*>a.data):
+        raise RuntimeError('MUD_getHistDataRebinned failed.')
+    return a
+
+cpdef get_hist_asym(int file_handle, int id_f, int id_b):
+    """
+        Returns (asym, error), numpy float64 arrays of the asymmetry 
+        (F-B)/(F+B) of histograms id_f and id_b, each less the mean counts 
+        in its bkgd1 to bkgd2 window, and its error.
+    """
+    nbins = get_hist_n_bins(file_handle, id_f)
+    cdef np.ndarray[np.float64_t, ndim=1, mode='c'] asym = np.empty(nbins)
+    cdef np.ndarray[np.float64_t, ndim=1, mode='c'] error = np.empty(nbins)
+    if not MUD_getHistAsym(file_handle, id_f, id_b, <double*>asym.data, 
+                           <double*>error.data):
+        raise RuntimeError('MUD_getHistAsym failed.')
+    return (asym, error)
+
+cpdef release_hist(int file_handle, int id_number):
+    """
+        Free the data of histogram id_number, of a file opened with 
+        open_read and not changed. It is read from the file again when 
+        next needed.
+    """
+    if not MUD_releaseHist(file_handle, id_number):
+        raise RuntimeError('MUD_releaseHist failed.')
+
+cpdef set_release_hists(int file_handle, release):
+    """
+        If release, the data of each histogram is freed (see release_hist) 
+        after get_hist_data, get_hist_data_rebinned or get_hist_asym, so 
+        that a file read one histogram at a time holds at most one in 
+        memory.
+    """
+    if not MUD_setReleaseHists(file_handle, 1 if release else 0):
+        raise RuntimeError('MUD_setReleaseHists failed.')
+    entry = _mapped.get(file_handle, None)
+    if entry is not None:
+        entry[1] = bool(release)
+
+cpdef get_file_mapping(int file_handle):
+    """
+        Returns a read-only memory map of the file opened with open_read as 
+        file_handle, for the offsets of get_hist_data_location. It is the 
+        file that was read, even if another has since replaced it, and 
+        stays open after close_read.
+    """
+    entry = _mapped.get(file_handle, None)
+    cdef int fileno = MUD_getFileNo(file_handle)
+    if entry is None or fileno < 0:
+        raise RuntimeError('MUD_getFileNo failed.')
+    if entry[0] is None:
+        entry[0] = mmap.mmap(fileno, 0, access=mmap.ACCESS_READ)
+    return entry[0]
+
+cpdef get_hist_data_location(int file_handle, int id_number):
+    """
+        Returns (offset, n_bytes) of the stored data of histogram id_number 
+        in the file, for unpack_hist_data, or None if the file was not 
+        opened with open_read or has been changed.
+    """
+    cdef unsigned int offset, n_bytes
+    if not MUD_getHistDataLocation(file_handle, id_number, &offset, &n_bytes):
+        return None
+    return (offset, n_bytes)
+
+cpdef unpack_hist_data(buffer, unsigned int offset, unsigned int n_bytes, 
+                       int n_bins, int bytes_per_bin, out=None):
+    """
+        Returns numpy array of uint32: histogram bins unpacked from the 
+        n_bytes at offset of buffer (e.g. a mmap of the file, see 
+        get_hist_data_location). Unpacked 4-byte bins on a little-endian 
+        host are returned as a read-only view of buffer.
+        
+        out: uint32 array of n_bins to unpack into (e.g. in shared memory), 
+             which is returned, instead of a new array or view
+        
+        Raises ValueError, with out unchanged, if the n_bytes are not 
+        n_bins bins of bytes_per_bin: no byte outside them is read.
+    """
+    cdef const unsigned char[:] buf = buffer
+    cdef np.uint32_t[::1] dest
+    cdef void* pin
+    cdef void* pout
+    cdef int n
+    
+    if <size_t>offset + n_bytes > <size_t>buf.shape[0]:
+        raise ValueError('Histogram data past end of buffer')
+    if bytes_per_bin not in (0, 1, 2, 4, MUD_BIN_SIZE_DELTA) or \
+            (bytes_per_bin == 4 and n_bytes < 4*n_bins):
+        raise ValueError('Histogram data do not match bins')
+    
+    if out is None:
+        if bytes_per_bin == 4 and sys.byteorder == 'little':
+            return np.frombuffer(buffer, dtype='<u4', count=n_bins, 
+                                 offset=offset)
+        out = np.zeros(n_bins, dtype=np.uint32)
+    
+    dest = out
+    if dest.shape[0] != n_bins:
+        raise ValueError('out does not have n_bins elements')
+    
+    if n_bins > 0 and n_bytes > 0:
+        pin = <void*>&buf[offset]
+        pout = <void*>&dest[0]
+        with nogil:
+            n = MUD_SEC_GEN_HIST_unpackChecked(n_bins, bytes_per_bin, pin, 
+                                               n_bytes, 4, pout)
+        if n < 0:
+            raise ValueError('Histogram data do not match bins')
+    elif n_bins > 0:
+        dest[:] = 0
+    return out
 
 cpdef get_hist_data_pointer(int file_handle, int id_number):
     raise RuntimeError("Pointers not available in python. Please use get_hist_data.")
@@ -1002,12 +1263,13 @@ cpdef set_hist_sec_per_bin(int file_handle, id_number, double value):
         raise RuntimeError('MUD_setHistSecondsPerBin failed.')
     return
 
-cpdef set_hist_data(int file_handle, int id_number, long[:] data_array):
+cpdef set_hist_data(int file_handle, int id_number, data_array):
     """
         Set data: numpy array of ints for values contained in each histogram bin.
     
         Note that you pass an array of 32 bit integers to the routine 
-        MUD_setHistData. This routine will pack the array, if necessary, 
+        MUD_setHistData (8 or 16 bit for 1 or 2 bytesPerBin, converted 
+        here). This routine will pack the array, if necessary, 
         depending on the previous definition of bytesPerBin. Note that a value 
         of 0 (zero) in bytesPerBin indicates a packed array.
 
@@ -1016,10 +1278,15 @@ cpdef set_hist_data(int file_handle, int id_number, long[:] data_array):
         pack the array (if necessary).     
     """
     
-    # set dtype and contiguous
-    cdef np.uint32_t[::1] buff = np.ascontiguousarray(data_array, dtype=np.uint32)
+    # set dtype and contiguous; data may be read-only (get_hist_data views)
+    data_array = np.asarray(data_array)
+    if data_array.dtype.kind not in 'iu':
+        raise TypeError('Histogram data must be an array of integers')
+    dtype = _unpacked_dtype(get_hist_bytes_per_bin(file_handle, id_number))
+    cdef const np.uint8_t[::1] buff = np.ascontiguousarray(data_array, 
+                                                dtype=dtype).view(np.uint8)
     
-    if not MUD_setHistData(file_handle, id_number, &buff[0]):
+    if not MUD_setHistData(file_handle, id_number, <void*>&buff[0]):
         raise RuntimeError('MUD_setHistData failed.')
     return 
 
@@ -1418,3 +1685,177 @@ cpdef set_ivar_time_data(int file_handle, int id_number, long[:] data_array):
     if not MUD_setIndVarTimeData(file_handle, id_number, &buff[0]):
         raise RuntimeError('MUD_getIndVarTimeData failed.')
     return 
+
+### ======================================================================= ###
+# EXPORT
+### ======================================================================= ###
+cdef extern from "mud_friendly.c":
+    int MUD_exportColumnar(int fh, char* file_name)
+
+cpdef export_columnar(int file_handle, str file_name):
+    """
+        Write the open run to file_name in the columnar format read by 
+        mudpy.mcolumnar: a JSON header followed by 64-byte aligned 
+        little-endian uint32 histogram and float64 ivar columns.
+    """
+    if not MUD_exportColumnar(file_handle, file_name.encode(character_encoding)):
+        raise RuntimeError('MUD_exportColumnar failed.')
+    return
+
+### ======================================================================= ###
+# SYNTHETIC RUNS
+### ======================================================================= ###
+cdef extern from "mud.h":
+    ctypedef struct MUD_SYNTH:
+        unsigned int type
+        unsigned int seed
+        int nHists
+        int nBins
+        int bytesPerBin
+        double counts
+        double tau
+        double background
+        int nScalers
+        int nIndVars
+        int nIndVarData
+        int nComments
+
+    void MUD_synthDefaults(MUD_SYNTH* pSynth, unsigned int type)
+    int MUD_writeSynth(char* filename, MUD_SYNTH* pSynth)
+
+cpdef write_synthetic(str file_name, unsigned int file_type, unsigned int seed, 
+                      dict options=None):
+    """
+        Write a synthetic run of type FMT_TRI_TD_ID or FMT_TRI_TI_ID to 
+        file_name. The same seed and options always give the same file. 
+        
+        options: dict overriding the defaults of MUD_synthDefaults, keyed by 
+            the fields of MUD_SYNTH (nHists, nBins, bytesPerBin, counts, tau, 
+            background, nScalers, nIndVars, nIndVarData, nComments)
+    """
+    cdef MUD_SYNTH synth
+    
+    MUD_synthDefaults(&synth, file_type)
+    synth.seed = seed
+    
+    if options is not None:
+        for key, value in options.items():
+            if key == 'nHists':         synth.nHists = value
+            elif key == 'nBins':        synth.nBins = value
+            elif key == 'bytesPerBin':  synth.bytesPerBin = value
+            elif key == 'counts':       synth.counts = value
+            elif key == 'tau':          synth.tau = value
+            elif key == 'background':   synth.background = value
+            elif key == 'nScalers':     synth.nScalers = value
+            elif key == 'nIndVars':     synth.nIndVars = value
+            elif key == 'nIndVarData':  synth.nIndVarData = value
+            elif key == 'nComments':    synth.nComments = value
+            else:
+                raise KeyError('Unknown synthetic run option %s' % key)
+    
+    if not MUD_writeSynth(file_name.encode(character_encoding), &synth):
+        raise RuntimeError('MUD_writeSynth failed.')
+    return
+
+### ======================================================================= ###
+# HISTOGRAM SUMS
+### ======================================================================= ###
+cdef extern from "mud.h":
+    int MUD_sumHists(char** filenames, int nFiles, int* nums, int nHists, 
+                     int nBins, uint64_t* pSum, unsigned int* pOK, 
+                     int nThreads) nogil
+
+cpdef sum_hists(list file_names, list id_numbers, int n_bins, int n_threads=0):
+    """
+        Sum histograms id_numbers, each of n_bins bins, over the runs 
+        file_names, reading n_threads runs at a time (0: one per processor). 
+        Only one run per thread is held in memory, and the GIL is 
+        released while summing.
+        
+        Returns (sum, ok): sum is a uint64 array of shape 
+        (len(id_numbers), n_bins), and ok a bool array, False for runs 
+        which could not be read or lack a matching histogram, and are not 
+        included in sum.
+    """
+    cdef int n_files = len(file_names)
+    cdef int n_hists = len(id_numbers)
+    cdef np.ndarray[np.uint64_t, ndim=2, mode='c'] total
+    cdef np.ndarray[np.uint32_t, ndim=1, mode='c'] ok
+    cdef np.ndarray[np.int32_t, ndim=1, mode='c'] nums
+    cdef np.ndarray[np.uintp_t, ndim=1, mode='c'] names
+    cdef char** c_names
+    cdef int* c_nums
+    cdef uint64_t* c_total
+    cdef unsigned int* c_ok
+    cdef int i
+    
+    total = np.zeros((n_hists, n_bins), dtype=np.uint64)
+    ok = np.zeros(n_files, dtype=np.uint32)
+    nums = np.array(id_numbers, dtype=np.int32)
+    
+    encoded = [name.encode(character_encoding) for name in file_names]
+    names = np.zeros(n_files, dtype=np.uintp)
+    for i in range(n_files):
+        names[i] = <np.uintp_t><char*>encoded[i]
+    
+    c_names = <char**>names.data
+    c_nums = <int*>nums.data
+    c_total = <uint64_t*>total.data
+    c_ok = <unsigned int*>ok.data
+    with nogil:
+        MUD_sumHists(c_names, n_files, c_nums, n_hists, n_bins, c_total, c_ok, 
+                     n_threads)
+    
+    return (total, ok.astype(bool))
+
+### ======================================================================= ###
+# PERFORMANCE COUNTERS
+### ======================================================================= ###
+cdef extern from "mud.h":
+    ctypedef struct MUD_STATS:
+        unsigned long long bytesRead
+        unsigned long long nReads
+        unsigned long long nSeeks
+        unsigned long long nDecoded
+        unsigned long long nAllocs
+        unsigned long long bytesAlloc
+        unsigned long long nSearches
+        unsigned long long nVisited
+        unsigned long long nsUnpack
+        unsigned long long nsFloat
+
+cdef extern from "mud_friendly.c":
+    int MUD_getStats(int fh, MUD_STATS* pStats)
+
+cpdef get_stats(int file_handle):
+    """
+        Returns dict of counters accumulated by file_handle since it was 
+        opened:
+        
+            bytes_read:     bytes read from the file
+            n_reads:        read calls (fread, pread)
+            n_seeks:        fseek calls while reading
+            n_decoded:      sections decoded
+            n_allocs:       allocations
+            bytes_alloc:    bytes allocated
+            n_searches:     MUD_search calls
+            n_visited:      sections compared by MUD_search
+            ns_unpack:      ns spent unpacking histograms and arrays
+            ns_float:       ns spent converting floating point arrays
+    """
+    cdef MUD_STATS stats
+    
+    if not MUD_getStats(file_handle, &stats):
+        raise RuntimeError('MUD_getStats failed.')
+    
+    return {'bytes_read':   stats.bytesRead,
+            'n_reads':      stats.nReads,
+            'n_seeks':      stats.nSeeks,
+            'n_decoded':    stats.nDecoded,
+            'n_allocs':     stats.nAllocs,
+            'bytes_alloc':  stats.bytesAlloc,
+            'n_searches':   stats.nSearches,
+            'n_visited':    stats.nVisited,
+            'ns_unpack':    stats.nsUnpack,
+            'ns_float':     stats.nsFloat,
+            }
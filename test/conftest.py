@@ -0,0 +1,49 @@
+# Fixtures shared by the tests on synthetic runs, no network needed
+# agent
+# Oct 2026
+
+from mudpy import mdata, msynth
+from numpy.testing import assert_equal
+import numpy as np
+import pytest
+
+# histogram attributes compared by same_run, other than data
+HIST_ATTRIBUTES = ('htype', 'title', 'n_bins', 'n_events', 'fs_per_bin',
+                   's_per_bin', 't0_ps', 't0_bin', 'good_bin1', 'good_bin2',
+                   'background1', 'background2')
+
+@pytest.fixture
+def synth(tmp_path):
+    """
+        Factory of synthetic runs in tmp_path: synth(name, mode, seed, ...)
+        writes one with msynth.generate, four histograms unless n_hist is
+        given, and returns its path.
+    """
+
+    def make(name='run.msr', mode='TD', seed=1, **kwargs):
+        kwargs.setdefault('n_hist', 4)
+        return msynth.generate(str(tmp_path / name), mode, seed, **kwargs)
+
+    return make
+
+@pytest.fixture
+def same_run():
+    """
+        Check that two mdata objects hold the same run: same description,
+        histograms, scalers, independent variables and comments, whatever
+        the dtype of the histogram data.
+    """
+
+    def check(a, b):
+        assert repr(a) == repr(b)
+        assert list(a.hist.keys()) == list(b.hist.keys())
+        for k in a.hist:
+            assert_equal(np.asarray(a.hist[k].data, dtype=np.int64),
+                         np.asarray(b.hist[k].data, dtype=np.int64))
+            for attr in HIST_ATTRIBUTES:
+                assert_equal(getattr(a.hist[k], attr),
+                             getattr(b.hist[k], attr), err_msg=attr)
+        for name in ('sclr', 'ivar', 'comments'):
+            assert repr(getattr(a, name, None)) == repr(getattr(b, name, None))
+
+    return check
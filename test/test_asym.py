@@ -0,0 +1,101 @@
+# Test the asymmetry of paired histograms against NumPy
+# agent
+# Oct 2026
+
+from mudpy import mdata, masym
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import pytest
+
+DELTA = mud.BIN_SIZE_DELTA
+N_BINS = 3000
+
+def reference(F, B, windows):
+    """Asymmetry and error of histograms F and B as in mud_asym.c"""
+
+    F = np.asarray(F, dtype=float)
+    B = np.asarray(B, dtype=float)
+
+    bkgd = []
+    for h, (b1, b2) in zip((F, B), windows):
+        window = h[b1:b2+1]
+        if len(window):
+            bkgd.append((window.mean(), window.mean()/len(window)))
+        else:
+            bkgd.append((0.0, 0.0))
+    (bF, vF), (bB, vB) = bkgd
+
+    with np.errstate(divide='ignore', invalid='ignore'):
+        f = F - bF
+        b = B - bB
+        s = f + b
+        return ((f - b)/s,
+                2*np.sqrt(b**2*(F + vF) + f**2*(B + vB))/s**2)
+
+def set_windows(filename, windows):
+    """Set the background windows of the first two histograms in place"""
+
+    fh = mud.open_readwrite(filename)
+    try:
+        for i, (b1, b2) in enumerate(windows):
+            mud.set_hist_background1(fh, i+1, b1)
+            mud.set_hist_background2(fh, i+1, b2)
+    except Exception:
+        mud.close_read(fh)
+        raise
+    mud.close_write(fh)
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 1, 2, 4, DELTA])
+@pytest.mark.parametrize('windows', [
+        ((100, 499), (200, 299)),       # ordinary
+        ((10, 9), (0, N_BINS-1)),       # empty, and the whole histogram
+        ((N_BINS, N_BINS+10), (5, 5)),  # past the end, and one bin
+        ((N_BINS-50, N_BINS+50), (N_BINS+1, 0)),  # running past the end
+        ])
+def test_asym(synth, tmp_path, bytes_per_bin, windows):
+
+    # few enough counts for 1-byte bins
+    filename = synth(n_bins=N_BINS, counts=100, bytes_per_bin=bytes_per_bin)
+    ref = mdata(synth('ref.msr', n_bins=N_BINS, counts=100, bytes_per_bin=4))
+    set_windows(filename, windows)
+
+    fh = mud.open_read(filename)
+    try:
+        assert mud.get_hist_bytes_per_bin(fh, 1) == bytes_per_bin
+        asym, error = mud.get_hist_asym(fh, 1, 2)
+    finally:
+        mud.close_read(fh)
+
+    F, B = [h.data for h in list(ref.hist.values())[:2]]
+    expected = reference(F, B, windows)
+    assert_allclose(asym, expected[0], rtol=1e-12, equal_nan=True)
+    assert_allclose(error, expected[1], rtol=1e-12, equal_nan=True)
+
+    titles = [h.title for h in ref.hist.values()]
+    a, da = masym.asym(filename, titles[0], titles[1])
+    assert_equal(a, asym)
+    assert_equal(da, error)
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 4, DELTA])
+def test_n_bins(synth, tmp_path, bytes_per_bin):
+    """F and B with different numbers of bins"""
+
+    run = mdata(synth(n_bins=N_BINS))
+    h = list(run.hist.values())[1]
+    h.data = h.data[:N_BINS-1]
+    h.n_bins = N_BINS-1
+    filename = str(tmp_path / 'asym.msr')
+    run.write(filename, bytes_per_bin=bytes_per_bin)
+
+    fh = mud.open_read(filename)
+    try:
+        assert mud.get_hist_n_bins(fh, 2) == N_BINS-1
+        with pytest.raises(RuntimeError):
+            mud.get_hist_asym(fh, 1, 2)
+        with pytest.raises(RuntimeError):
+            mud.get_hist_asym(fh, 2, 1)
+        with pytest.raises(RuntimeError):
+            mud.get_hist_asym(fh, 1, 99)
+    finally:
+        mud.close_read(fh)
@@ -0,0 +1,144 @@
+# Test reading runs from asyncio
+# agent
+# Oct 2026
+
+from mudpy import mdata, masync, aload, aiter_dir
+import asyncio, os, threading, time, pytest
+
+@pytest.fixture
+def runs(synth):
+    """Synthetic runs of the same size, and their size"""
+    files = [synth('run%02d.msr' % i, seed=i+1, n_bins=1024, bytes_per_bin=4)
+             for i in range(8)]
+    return files, os.path.getsize(files[0])
+
+@pytest.fixture
+def reads(monkeypatch):
+    """
+        Record of the runs read by masync, in order of starting, with the
+        most read at once. Reads of paths in blocked wait for release.
+    """
+
+    class record(object):
+        started = []
+        most = 0
+        now = 0
+        blocked = set()
+        release = threading.Event()
+        lock = threading.Lock()
+
+    def read(path, lazy):
+        with record.lock:
+            record.started.append(path)
+            record.now += 1
+            record.most = max(record.most, record.now)
+        try:
+            if path in record.blocked:
+                record.release.wait(10)
+            time.sleep(0.005)
+            return mdata(path, lazy)
+        finally:
+            with record.lock:
+                record.now -= 1
+
+    workers, max_bytes = masync._workers, masync._max_bytes
+    monkeypatch.setattr(masync, 'mdata', read)
+    yield record
+
+    # let reads left waiting finish before the next test
+    record.release.set()
+    deadline = time.monotonic() + 10
+    while record.now and time.monotonic() < deadline:
+        time.sleep(0.01)
+    masync.configure(workers=workers, max_bytes=max_bytes)
+
+def budget():
+    return masync._budgets[asyncio.get_running_loop()]
+
+@pytest.mark.parametrize('cap', [1, 2, 3])
+def test_cap(runs, reads, cap):
+
+    files, size = runs
+    masync.configure(workers=4, max_bytes=cap*size)
+
+    async def main():
+        loaded = await asyncio.gather(*[aload(f) for f in files])
+        await asyncio.sleep(0.05)
+        assert budget().used == 0 and not budget().waiting
+        return loaded
+
+    loaded = asyncio.run(main())
+    assert reads.started == files
+    assert reads.most == cap
+    assert [run.run for run in loaded] == [mdata(f).run for f in files]
+
+def test_cancel(runs, reads):
+
+    files, size = runs
+    masync.configure(workers=4, max_bytes=size)
+    reads.blocked.add(files[0])
+
+    async def main():
+        first = asyncio.ensure_future(aload(files[0]))
+        waiting = [asyncio.ensure_future(aload(f)) for f in files[1:3]]
+        await asyncio.sleep(0.01)
+        assert len(budget().waiting) == 2
+
+        # the first waiting read is dropped, the next one still reads
+        waiting[0].cancel()
+        await asyncio.sleep(0)
+        reads.release.set()
+        run = await waiting[1]
+        with pytest.raises(asyncio.CancelledError):
+            await waiting[0]
+        await first
+
+        await asyncio.sleep(0.05)
+        assert budget().used == 0 and not budget().waiting
+        return run
+
+    run = asyncio.run(main())
+    assert reads.started == [files[0], files[2]]
+    assert run.run == mdata(files[2]).run
+
+def test_aiter_dir(runs, reads, tmp_path):
+
+    files, size = runs
+    masync.configure(workers=2, max_bytes=size)
+    reads.blocked.update(files[1:])
+
+    async def main():
+        it = aiter_dir(str(tmp_path), ahead=3)
+        path, run = await it.__anext__()
+        assert path == files[0]
+        await it.aclose()
+
+        # the read started runs to the end, the others are dropped
+        reads.release.set()
+        await asyncio.sleep(0.1)
+        assert budget().used == 0 and not budget().waiting
+
+    asyncio.run(main())
+    assert reads.started == files[:2]
+
+def test_return_exceptions(runs, reads, tmp_path):
+
+    files, size = runs
+    junk = str(tmp_path / 'run03a.msr')
+    with open(junk, 'wb') as fid:
+        fid.write(bytes(16))        # a first section of no size
+
+    async def read(**kwargs):
+        return [(path, run) async for path, run in
+                aiter_dir(str(tmp_path), ahead=4, **kwargs)]
+
+    read_all = asyncio.run(read(return_exceptions=True))
+    assert [path for path, _ in read_all] == sorted(files + [junk])
+    for path, run in read_all:
+        if path == junk:
+            assert isinstance(run, Exception)
+        else:
+            assert run.run == mdata(path).run
+
+    with pytest.raises(Exception):
+        asyncio.run(read())
@@ -0,0 +1,58 @@
+# Test the on-disk cache of decoded runs
+# agent
+# Oct 2026
+
+from mudpy import mdata, mcache
+import numpy as np
+import os, pytest
+
+@pytest.fixture
+def cache(tmp_path):
+    """Cache directory, enabled for the test"""
+    directory = str(tmp_path / 'cache')
+    mcache.enable(directory, max_bytes=10**9)
+    yield directory
+    mcache.disable()
+
+def test_cache(synth, same_run, cache):
+
+    runs = [synth('run%d.msr' % i, seed=i+1) for i in range(4)]
+    mcache.disable()
+    expected = [mdata(filename) for filename in runs]
+    mcache.enable(cache, max_bytes=10**9)
+
+    # decoded and added, then read from the cache
+    for filename, ref in zip(runs, expected):
+        same_run(mdata(filename), ref)
+    assert len(os.listdir(cache)) == len(runs)
+
+    for filename, ref in zip(runs, expected):
+        run = mdata(filename)
+        same_run(run, ref)
+        assert all(isinstance(h.data.base, np.memmap)
+                   for h in run.hist.values())
+
+    # a changed file is decoded again
+    synth('run0.msr', seed=10, n_hist=2)
+    assert len(mdata(runs[0]).hist) == 2
+    assert len(os.listdir(cache)) == len(runs) + 1
+
+    # a cached run which cannot be read is decoded again
+    for name in os.listdir(cache):
+        with open(os.path.join(cache, name), 'wb') as fid:
+            fid.write(b'not a run')
+    same_run(mdata(runs[1]), expected[1])
+
+def test_bounded(synth, cache):
+
+    runs = [synth('run%d.msr' % i, seed=i+1) for i in range(5)]
+    mdata(runs[0])
+    size = os.path.getsize(os.path.join(cache, os.listdir(cache)[0]))
+
+    mcache.clear()
+    assert not os.listdir(cache)
+
+    mcache.enable(cache, max_bytes=3*size)
+    for filename in runs:
+        mdata(filename)
+        assert len(os.listdir(cache)) <= 3
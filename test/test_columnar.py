@@ -0,0 +1,77 @@
+# Test export to and loading of columnar run files
+# agent
+# Oct 2026
+
+from mudpy import mdata, mcolumnar
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import pytest
+
+def export_file(filename, columnar):
+    fh = mud.open_read(filename)
+    try:
+        mud.export_columnar(fh, columnar)
+    finally:
+        mud.close_read(fh)
+
+@pytest.mark.parametrize('mode', ['TD', 'TI'])
+def test_round_trip(synth, same_run, tmp_path, mode):
+
+    filename = synth(mode=mode)
+    run = mdata(filename)
+
+    # from the object, and from the file
+    run.export(str(tmp_path / 'run.mudc'))
+    export_file(filename, str(tmp_path / 'file.mudc'))
+
+    loaded = mcolumnar.load(str(tmp_path / 'run.mudc'))
+    same_run(loaded, run)
+    same_run(mcolumnar.load(str(tmp_path / 'file.mudc')), run)
+
+    for h in loaded.hist.values():
+        assert h.data.dtype == np.uint32
+        assert not h.data.flags.writeable
+
+    header = mcolumnar.read_header(str(tmp_path / 'run.mudc'))
+    assert header['version'] == mcolumnar.VERSION
+    assert header['type'] == {'TD': mud.FMT_TRI_TD_ID,
+                              'TI': mud.FMT_TRI_TI_ID}[mode]
+
+def test_edited(synth, tmp_path):
+
+    run = mdata(synth(n_comments=1))
+    h = list(run.hist.values())[0]
+    v = list(run.ivar.values())[0]
+    c = list(run.comments.values())[0]
+
+    run.title = 'edited'
+    h.data = np.arange(len(h.data))
+    h.t0_bin = 77
+    v.mean = 1.5
+    c.body = 'x'*20000
+
+    run.export(str(tmp_path / 'run.mudc'))
+    loaded = mcolumnar.load(str(tmp_path / 'run.mudc'))
+
+    assert loaded.title == 'edited'
+    assert_equal(loaded.hist[h.title].data, np.arange(len(h.data)))
+    assert loaded.hist[h.title].t0_bin == 77
+    assert loaded.ivar[v.title].mean == 1.5
+    assert loaded.comments[c.title].body == 'x'*20000
+
+    h.data = -h.data
+    with pytest.raises(ValueError):
+        run.export(str(tmp_path / 'negative.mudc'))
+
+def test_long_comment(synth, tmp_path):
+    """Comment bodies are exported whole from the file too"""
+
+    run = mdata(synth(n_comments=2))
+    body = ''.join(chr(32 + i % 95) for i in range(20000))
+    list(run.comments.values())[1].body = body
+    run.write(str(tmp_path / 'long.msr'))
+
+    export_file(str(tmp_path / 'long.msr'), str(tmp_path / 'long.mudc'))
+    loaded = mcolumnar.load(str(tmp_path / 'long.mudc'))
+    assert list(loaded.comments.values())[1].body == body
@@ -0,0 +1,174 @@
+# Test histograms stored as zigzag deltas, and the checks made before unpacking
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import pytest
+
+DELTA = mud.BIN_SIZE_DELTA
+
+def delta_encode(bins):
+    """
+        Reference encoding of BIN_SIZE_DELTA: 2-bit lengths of the zigzag
+        deltas, four to a byte, then their little-endian bytes
+    """
+    control = bytearray((len(bins)+3)//4)
+    data = bytearray()
+    prev = 0
+    for i, value in enumerate(int(b) for b in bins):
+        delta = (value - prev) & 0xFFFFFFFF
+        prev = value
+        zigzag = ((delta << 1) ^ (0xFFFFFFFF if delta >> 31 else 0)) & 0xFFFFFFFF
+        code = (zigzag > 0xFF) + (zigzag > 0xFFFF) + (zigzag > 0xFFFFFF)
+        control[i >> 2] |= code << (2*(i & 3))
+        data += zigzag.to_bytes(code+1, 'little')
+    return bytes(control + data)
+
+def packed_run(bins, size):
+    """Run of bins of size bytes, as in packed (bytes_per_bin 0) data"""
+    return len(bins).to_bytes(2, 'little') + bytes([size]) + \
+           b''.join(int(b).to_bytes(size, 'little') for b in bins)
+
+@pytest.mark.parametrize('n_bins', [1, 15, 16, 17, 1003])
+def test_delta_codec(synth, tmp_path, n_bins):
+    """
+        Bytes as the reference encoding, whichever codec the library was
+        built with: run with a -Dsimd=false build too.
+    """
+
+    run = mdata(synth(n_bins=n_bins))
+
+    # deltas of every length, and of both signs
+    rng = np.random.default_rng(n_bins)
+    for i, h in enumerate(run.hist.values()):
+        shift = rng.integers(0, 31, n_bins)
+        h.data = (rng.integers(0, 2**31, n_bins) >> shift) * (i+1) % 2**31
+
+    filename = str(tmp_path / 'delta.msr')
+    run.write(filename, bytes_per_bin=DELTA)
+
+    delta = mdata(filename)
+    with open(filename, 'rb') as fid:
+        raw = fid.read()
+
+    fh = mud.open_read(filename)
+    try:
+        for i, (k, h) in enumerate(run.hist.items()):
+            assert mud.get_hist_bytes_per_bin(fh, i+1) == DELTA
+            offset, n_bytes = mud.get_hist_data_location(fh, i+1)
+            assert raw[offset:offset+n_bytes] == delta_encode(h.data)
+            assert_equal(delta.hist[k].data, h.data)
+    finally:
+        mud.close_read(fh)
+
+@pytest.mark.parametrize('n_bins', [5, 64, 1003])
+def test_delta_malformed(n_bins):
+    """Delta data not filling n_bytes exactly are not unpacked"""
+
+    bins = np.random.default_rng(n_bins).integers(0, 2**20, n_bins)
+    data = delta_encode(bins)
+    assert_equal(mud.unpack_hist_data(data, 0, len(data), n_bins, DELTA), bins)
+
+    out = np.full(n_bins, 7, dtype=np.uint32)
+    with pytest.raises(ValueError):
+        mud.unpack_hist_data(data, 0, len(data)-1, n_bins, DELTA, out=out)
+    with pytest.raises(ValueError):
+        mud.unpack_hist_data(data + b'\0', 0, len(data)+1, n_bins, DELTA,
+                             out=out)
+    assert (out == 7).all()
+
+    # control bytes claiming more bytes than there are, or fewer
+    for ctl in (0xFF, 0x00):
+        bad = bytes([ctl]*((n_bins+3)//4)) + data[(n_bins+3)//4:]
+        if bad != data:
+            with pytest.raises(ValueError):
+                mud.unpack_hist_data(bad, 0, len(bad), n_bins, DELTA)
+
+    # too few bytes for the control bytes
+    with pytest.raises(ValueError):
+        mud.unpack_hist_data(data[:1], 0, 1, n_bins, DELTA)
+
+def test_packed_malformed():
+    """Packed runs not within n_bytes, or not n_bins bins, are not unpacked"""
+
+    data = packed_run(range(10), 1) + packed_run([0]*5, 0) + \
+           packed_run([300, 70000], 4)
+    expected = list(range(10)) + [0]*5 + [300, 70000]
+    assert_equal(mud.unpack_hist_data(data, 0, len(data), 17, 0), expected)
+
+    bad = [data[:-1],                                       # truncated run
+           data[:-11] + packed_run([300, 7, 1], 4),         # past n_bins
+           packed_run([], 1) + data,                        # empty run
+           data[:-11] + packed_run([300, 7], 3)]            # unknown size
+    for b in bad:
+        with pytest.raises(ValueError):
+            mud.unpack_hist_data(b, 0, len(b), 17, 0)
+
+    # too few bins
+    with pytest.raises(ValueError):
+        mud.unpack_hist_data(data, 0, len(data), 18, 0)
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 1, 2, 4, DELTA])
+def test_no_data(tmp_path, bytes_per_bin):
+    """A histogram whose data were never set reads as zeros"""
+
+    filename = str(tmp_path / 'nodata.msr')
+    fh = mud.open_write(filename, mud.FMT_TRI_TD_ID)
+    mud.set_description(fh, mud.SEC_GEN_RUN_DESC_ID)
+    mud.set_hists(fh, mud.GRP_TRI_TD_HIST_ID, 2)
+    for i in (1, 2):
+        mud.set_hist_type(fh, i, mud.SEC_GEN_HIST_HDR_ID)
+        mud.set_hist_bytes_per_bin(fh, i, bytes_per_bin)
+        mud.set_hist_n_bins(fh, i, 50)
+        mud.set_hist_background1(fh, i, 0)
+        mud.set_hist_background2(fh, i, 10)
+    mud.set_hist_data(fh, 1, np.arange(50) % 200)
+    mud.close_write(fh)
+
+    fh = mud.open_read(filename)
+    try:
+        assert_equal(mud.get_hist_data(fh, 1), np.arange(50) % 200)
+        assert_equal(mud.get_hist_data(fh, 2), np.zeros(50))
+        assert_equal(mud.get_hist_data_rebinned(fh, 2, 7), np.zeros(8))
+        asym, error = mud.get_hist_asym(fh, 1, 2)
+        assert len(asym) == 50
+    finally:
+        mud.close_read(fh)
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 4, DELTA])
+def test_corrupt_file(synth, tmp_path, bytes_per_bin):
+    """A histogram whose data do not match its bins fails to read"""
+
+    filename = synth(n_bins=1000, bytes_per_bin=bytes_per_bin)
+    fh = mud.open_read(filename)
+    try:
+        offset, n_bytes = mud.get_hist_data_location(fh, 1)
+    finally:
+        mud.close_read(fh)
+
+    # make the first run, or the control bytes, claim more data
+    with open(filename, 'r+b') as fid:
+        if bytes_per_bin == 0:
+            fid.seek(offset)
+            fid.write((0xFFFF).to_bytes(2, 'little'))
+        elif bytes_per_bin == DELTA:
+            fid.seek(offset)
+            fid.write(bytes([0xFF]*64))
+        else:
+            fid.seek(offset - 4)
+            fid.write((n_bytes - 4).to_bytes(4, 'little'))
+
+    fh = mud.open_read(filename)
+    try:
+        with pytest.raises(RuntimeError):
+            mud.get_hist_data(fh, 1)
+        with pytest.raises(RuntimeError):
+            mud.get_hist_data_rebinned(fh, 1, 10)
+        with pytest.raises(RuntimeError):
+            mud.get_hist_asym(fh, 1, 2)
+        assert len(mud.get_hist_data(fh, 2)) == 1000
+    finally:
+        mud.close_read(fh)
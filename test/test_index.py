@@ -0,0 +1,38 @@
+# Test the sidecar section index (mud_friendly_wrapper.write_index)
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+import os, shutil, pytest
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 4, mud.BIN_SIZE_DELTA])
+@pytest.mark.parametrize('lazy', [False, True])
+def test_indexed(synth, same_run, bytes_per_bin, lazy):
+
+    filename = synth(bytes_per_bin=bytes_per_bin)
+    expected = mdata(filename)
+
+    mud.write_index(filename)
+    assert os.path.exists(filename + '.idx')
+    same_run(mdata(filename, lazy=lazy), expected)
+
+    # histogram data read on demand are written out when copied
+    fh = mud.open_read(filename)
+    mud.close_writefile(fh, filename + '.copy')
+    same_run(mdata(filename + '.copy'), expected)
+
+def test_stale(synth, same_run):
+
+    filename = synth(seed=1)
+    mud.write_index(filename)
+
+    # another run in its place: the index no longer matches, and is not used
+    shutil.copy(synth('other.msr', seed=2, n_hist=2), filename)
+    os.utime(filename, ns=(0, 0))
+    same_run(mdata(filename), mdata(synth('other.msr', seed=2, n_hist=2)))
+
+    # nor is an index which cannot be read
+    with open(filename + '.idx', 'wb') as fid:
+        fid.write(b'not an index')
+    assert len(mdata(filename).hist) == 2
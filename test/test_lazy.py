@@ -0,0 +1,38 @@
+# Test reading runs eagerly and lazily
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import pytest
+
+DELTA = mud.BIN_SIZE_DELTA
+N_BINS = 1001
+
+# few enough counts for 1-byte bins
+SMALL = {'n_bins': N_BINS, 'counts': 100}
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 4, DELTA])
+def test_eager_lazy(synth, bytes_per_bin):
+
+    filename = synth(bytes_per_bin=bytes_per_bin, **SMALL)
+    ref = mdata(synth('ref.msr', bytes_per_bin=4, **SMALL))
+
+    eager = mdata(filename)
+    lazy = mdata(filename, lazy=True)
+
+    assert repr(eager) == repr(lazy)
+    for k in ref.hist:
+        assert_equal(eager.hist[k].data, ref.hist[k].data)
+        assert_equal(lazy.hist[k].data, ref.hist[k].data)
+        assert eager.hist[k].data.dtype == np.int64
+
+@pytest.mark.parametrize('bytes_per_bin', [1, 2])
+def test_lazy_short_bins(synth, bytes_per_bin):
+
+    lazy = mdata(synth(bytes_per_bin=bytes_per_bin, **SMALL), lazy=True)
+    ref = mdata(synth('ref.msr', bytes_per_bin=4, **SMALL))
+    for k in ref.hist:
+        assert_equal(lazy.hist[k].data, ref.hist[k].data)
@@ -0,0 +1,29 @@
+# Test loading many runs at once
+# agent
+# Oct 2026
+
+from mudpy import mdata, load_many, mload
+import pytest
+
+@pytest.fixture
+def runs(synth):
+    """Synthetic runs of each type and bin size"""
+    return [synth('run%02d.msr' % i, 'TI' if i % 3 == 0 else 'TD', seed=i+1,
+                  n_bins=2048, bytes_per_bin=(0, 4)[i % 2])
+            for i in range(12)]
+
+@pytest.mark.parametrize('lazy', [False, True])
+def test_load_many(runs, same_run, tmp_path, lazy):
+
+    loaded = load_many(runs, workers=4, lazy=lazy)
+    assert len(loaded) == len(runs)
+    for filename, run in zip(runs, loaded):
+        same_run(run, mdata(filename))
+
+    # the runs that could be read are returned with the errors
+    missing = str(tmp_path / 'missing.msr')
+    with pytest.raises(mload.LoadError) as err:
+        load_many(runs[:3] + [missing] + runs[3:6], workers=4, lazy=lazy)
+    assert [path for path, _ in err.value.errors] == [missing]
+    assert err.value.runs[3] is None
+    same_run(err.value.runs[4], mdata(runs[3]))
@@ -0,0 +1,44 @@
+# Test reading histograms as views of the mapped file
+# agent
+# Oct 2026
+
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import gc, os, shutil, pytest
+
+@pytest.mark.parametrize('indexed', [False, True])
+def test_mapped(synth, indexed):
+
+    filename = synth(n_bins=5000, bytes_per_bin=4)
+    packed = synth('packed.msr', n_bins=5000, bytes_per_bin=0)
+    if indexed:
+        mud.write_index(filename)
+
+    fh = mud.open_read(packed)
+    try:
+        ref = mud.get_hist_data(fh, 2)
+        # not stored with 4 bytes per bin: a copy
+        copy = mud.get_hist_data(fh, 2, mapped=True)
+    finally:
+        mud.close_read(fh)
+    assert copy.dtype == np.int64 and copy.flags.writeable
+    assert_equal(copy, ref)
+
+    fh = mud.open_read(filename)
+    try:
+        view = mud.get_hist_data(fh, 2, mapped=True)
+        assert view.dtype == np.uint32 and not view.flags.writeable
+        assert_equal(view, ref)
+
+        # a view may be set as the data of a histogram
+        mud.set_hist_data(fh, 1, view)
+        assert_equal(mud.get_hist_data(fh, 1), ref)
+    finally:
+        mud.close_read(fh)
+
+    # the view outlives the file handle, and the file it was read from
+    shutil.copy(packed, filename + '.new')
+    os.replace(filename + '.new', filename)
+    gc.collect()
+    assert_equal(view, ref)
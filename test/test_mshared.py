@@ -0,0 +1,134 @@
+# Test sharing decoded runs between processes (mudpy.mshared)
+# agent
+# Oct 2026
+
+from mudpy import mdata, mshared
+import mudpy.mud_friendly_wrapper as mud
+import gc, glob, os, subprocess, sys, pytest
+
+posix_shm = os.path.isdir(mshared.SHM_DIR)
+
+# a user other than the one running the tests
+OTHER = 12345
+
+@pytest.fixture
+def runs(synth):
+    """Synthetic runs of each type and bin size"""
+    return [synth('run%02d.msr' % i, 'TI' if i % 3 == 0 else 'TD', seed=i+1,
+                  n_bins=2048, bytes_per_bin=(0, 4)[i % 2])
+            for i in range(12)]
+
+def shm_segments(prefix):
+    return set(glob.glob(os.path.join(mshared.SHM_DIR, prefix + '*')))
+
+@pytest.mark.skipif(not posix_shm, reason='needs POSIX shared memory')
+def test_mshared(runs, same_run):
+
+    expected = [mdata(filename) for filename in runs[:4]]
+    mshared.clear()
+    assert not shm_segments(mshared.PREFIX)
+
+    mshared.enable(max_bytes=10**8)
+    try:
+        shared = [mdata(filename) for filename in runs[:4]]
+        assert len(shm_segments(mshared.PREFIX)) == 4
+        for run, ref in zip(shared, expected):
+            same_run(run, ref)
+            assert not any(h.data.flags.writeable for h in run.hist.values())
+
+        # another process attaches, without decoding
+        code = '\n'.join([
+            'import sys',
+            'from mudpy import mdata, mshared, mud_friendly_wrapper as mud',
+            'def fail(*args): raise SystemExit("decoded")',
+            'mud.open_read = fail',
+            'mshared.enable(10**8)',
+            'run = mdata(sys.argv[1])',
+            'print(sum(int(h.data.sum()) for h in run.hist.values()))'])
+        out = subprocess.run([sys.executable, '-c', code, runs[1]],
+                             capture_output=True, text=True)
+        assert out.returncode == 0, out.stderr
+        assert int(out.stdout) == sum(int(h.data.sum())
+                                      for h in expected[1].hist.values())
+
+        # runs in use are not removed
+        mshared.clear()
+        assert len(shm_segments(mshared.PREFIX)) == 4
+        del shared, run
+        gc.collect()
+        mshared.clear()
+        assert not shm_segments(mshared.PREFIX)
+
+        # least-recently used runs not in use are evicted to fit
+        mdata(runs[0])
+        size = max(os.path.getsize(s) for s in shm_segments(mshared.PREFIX))
+        mshared.enable(max_bytes=2*size)
+        held = mdata(runs[0])
+        for filename in runs[1:4]:
+            mdata(filename)
+            gc.collect()
+            assert len(shm_segments(mshared.PREFIX)) <= 2
+        same_run(held, expected[0])
+        del held
+        gc.collect()
+
+        # a segment left half-written is removed, and the run decoded
+        key = mshared.get_key(runs[2])
+        mshared.clear()
+        with open(os.path.join(mshared.SHM_DIR, key), 'wb') as fid:
+            fid.write(bytes(100))
+        same_run(mdata(runs[2]), expected[2])
+
+    finally:
+        mshared.disable()
+        gc.collect()
+        mshared.clear()
+
+    assert not shm_segments(mshared.PREFIX)
+
+@pytest.mark.skipif(not posix_shm or os.getuid() != 0,
+                    reason='needs POSIX shared memory, and root to chown')
+def test_mshared_owner(runs, same_run, monkeypatch):
+
+    expected = [mdata(filename) for filename in runs[:2]]
+    mshared.clear()
+
+    def fail(*args):
+        raise RuntimeError('decoded')
+
+    def segment(filename):
+        return os.path.join(mshared.SHM_DIR, mshared.get_key(filename))
+
+    mshared.enable(max_bytes=10**8)
+    try:
+        # another run under the name of runs[0], by another user: not read
+        mdata(runs[1])
+        gc.collect()
+        os.rename(segment(runs[1]), segment(runs[0]))
+        os.chown(segment(runs[0]), OTHER, OTHER)
+        with monkeypatch.context() as m:
+            m.setattr(mud, 'open_read', fail)
+            with pytest.raises(RuntimeError):
+                mdata(runs[0])
+
+        # but removed, and the run decoded into a segment of our own
+        same_run(mdata(runs[0]), expected[0])
+        assert os.stat(segment(runs[0])).st_uid == os.getuid()
+        gc.collect()
+
+        # segments of the owner of the file are read
+        os.chown(runs[1], OTHER, OTHER)
+        assert str(OTHER) in mshared.get_key(runs[1])
+        mdata(runs[1])
+        gc.collect()
+        os.chown(segment(runs[1]), OTHER, OTHER)
+        with monkeypatch.context() as m:
+            m.setattr(mud, 'open_read', fail)
+            same_run(mdata(runs[1]), expected[1])
+
+    finally:
+        mshared.disable()
+        gc.collect()
+        mshared.clear()
+
+    assert not shm_segments(mshared.PREFIX)
@@ -0,0 +1,38 @@
+# Test the synthetic run generator
+# agent
+# Oct 2026
+
+from mudpy import mdata, msynth
+import mudpy.mud_friendly_wrapper as mud
+import filecmp, pytest
+
+@pytest.mark.parametrize('mode', ['TD', 'TI'])
+def test_deterministic(synth, mode):
+
+    a = synth('a.msr', mode, seed=5)
+    b = synth('b.msr', mode, seed=5)
+    c = synth('c.msr', mode, seed=6)
+
+    assert filecmp.cmp(a, b, shallow=False)
+    assert not filecmp.cmp(a, c, shallow=False)
+
+def test_options(synth):
+
+    filename = synth(n_hist=3, n_bins=500, bytes_per_bin=4, n_scalers=5,
+                     n_ivars=2, n_comments=7)
+    run = mdata(filename)
+
+    assert len(run.hist) == 3
+    assert all(len(h.data) == 500 for h in run.hist.values())
+    assert len(run.sclr) == 5
+    assert len(run.ivar) == 2
+    assert len(run.comments) == 7
+
+    fh = mud.open_read(filename)
+    try:
+        assert mud.get_hist_bytes_per_bin(fh, 1) == 4
+    finally:
+        mud.close_read(fh)
+
+    with pytest.raises(ValueError):
+        msynth.generate(filename, 'XX')
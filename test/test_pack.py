@@ -0,0 +1,55 @@
+# Test packing histograms together, when the file is closed
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+import numpy as np
+import filecmp, pytest
+
+@pytest.mark.parametrize('pack_threads', [1, 3, -1])
+def test_pack_threads(synth, tmp_path, pack_threads):
+
+    run = mdata(synth(n_bins=20000))
+    run.write(str(tmp_path / 'a.msr'))
+    run.write(str(tmp_path / 'b.msr'), pack_threads=pack_threads)
+    assert filecmp.cmp(str(tmp_path / 'a.msr'), str(tmp_path / 'b.msr'),
+                       shallow=False)
+
+def write(filename, pack_threads, change):
+    """
+        Three packed histograms of 1000 bins, with change(fh, i) of each
+        after its data are set
+    """
+
+    rng = np.random.default_rng(7)
+    fh = mud.open_write(filename, mud.FMT_TRI_TD_ID)
+    try:
+        if pack_threads is not None:
+            mud.set_pack_threads(fh, pack_threads)
+        mud.set_description(fh, mud.SEC_GEN_RUN_DESC_ID)
+        mud.set_hists(fh, mud.GRP_TRI_TD_HIST_ID, 3)
+        for i in range(1, 4):
+            mud.set_hist_n_bins(fh, i, 1000)
+            mud.set_hist_bytes_per_bin(fh, i, 0)
+            mud.set_hist_title(fh, i, 'hist%d' % i)
+            mud.set_hist_data(fh, i, rng.integers(0, 70000, 1000))
+            change(fh, i)
+    except Exception:
+        mud.close_read(fh)
+        raise
+    mud.close_write(fh)
+
+@pytest.mark.parametrize('change', [
+        lambda fh, i: mud.set_hist_n_bins(fh, i, 500),
+        lambda fh, i: mud.set_hist_n_bins(fh, i, 1000 + i),
+        lambda fh, i: mud.set_hist_bytes_per_bin(fh, i, 4),
+        lambda fh, i: mud.set_hist_t0_bin(fh, i, 10*i),
+    ], ids=['fewer_bins', 'more_bins', 'bytes_per_bin', 't0_bin'])
+def test_changed(tmp_path, change):
+    """Changes after the data are set: the data packed as set, either way"""
+
+    write(str(tmp_path / 'a.msr'), None, change)
+    write(str(tmp_path / 'b.msr'), 2, change)
+    assert filecmp.cmp(str(tmp_path / 'a.msr'), str(tmp_path / 'b.msr'),
+                       shallow=False)
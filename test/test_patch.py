@@ -0,0 +1,49 @@
+# Test updating files opened with open_readwrite in place
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import filecmp, shutil, pytest
+
+@pytest.mark.parametrize('indexed', [False, True])
+def test_patch(synth, same_run, tmp_path, indexed):
+
+    source = synth(n_bins=1000)
+    patched = str(tmp_path / 'patched.msr')
+    shutil.copy(source, patched)
+    if indexed:
+        mud.write_index(patched)
+
+    def change(fh):
+        mud.set_hist_t0_bin(fh, 1, 1234)
+        mud.set_title(fh, mud.get_title(fh)[::-1])
+
+    # same sizes: patched in place, as if rewritten
+    fh = mud.open_readwrite(patched)
+    change(fh)
+    mud.close_write(fh)
+
+    fh = mud.open_readwrite(source)
+    change(fh)
+    mud.close_writefile(fh, str(tmp_path / 'rewritten.msr'))
+
+    assert filecmp.cmp(patched, str(tmp_path / 'rewritten.msr'), shallow=False)
+
+    # the index, if any, now out of date, is not used
+    for lazy in (False, True):
+        same_run(mdata(patched, lazy=lazy),
+                        mdata(str(tmp_path / 'rewritten.msr')))
+
+    # size changed: rewritten
+    fh = mud.open_readwrite(patched)
+    mud.set_title(fh, 'a much longer title than before '*4)
+    mud.set_hist_t0_bin(fh, 2, 77)
+    mud.close_write(fh)
+
+    run = mdata(patched, lazy=True)
+    assert run.title.startswith('a much longer title')
+    assert run.hist[list(run.hist)[1]].t0_bin == 77
+    assert_equal(run.hist[list(run.hist)[0]].data,
+                 mdata(source).hist[list(run.hist)[0]].data)
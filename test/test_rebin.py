@@ -0,0 +1,37 @@
+# Test reading histograms rebinned while unpacking
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import pytest
+
+DELTA = mud.BIN_SIZE_DELTA
+N_BINS = 1001
+
+# few enough counts for 1-byte bins
+SMALL = {'n_bins': N_BINS, 'counts': 100}
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 1, 2, 4, DELTA])
+def test_rebin(synth, bytes_per_bin):
+
+    filename = synth(bytes_per_bin=bytes_per_bin, **SMALL)
+    ref = mdata(synth('ref.msr', bytes_per_bin=4, **SMALL))
+
+    fh = mud.open_read(filename)
+    try:
+        for i, h in enumerate(ref.hist.values()):
+
+            # 10 leaves one bin over, 7 divides N_BINS
+            for factor in (1, 7, 10, N_BINS, 2*N_BINS):
+                rebinned = mud.get_hist_data_rebinned(fh, i+1, factor)
+                expected = np.add.reduceat(h.data, np.arange(0, N_BINS, factor))
+                assert len(rebinned) == -(-N_BINS // factor)
+                assert_equal(rebinned, expected)
+
+        with pytest.raises(ValueError):
+            mud.get_hist_data_rebinned(fh, 1, 0)
+    finally:
+        mud.close_read(fh)
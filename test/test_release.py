@@ -0,0 +1,106 @@
+# Test releasing histogram data once unpacked, and reading it again
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import os, pytest
+
+DELTA = mud.BIN_SIZE_DELTA
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 4, DELTA])
+@pytest.mark.parametrize('indexed', [False, True])
+def test_release(synth, indexed, bytes_per_bin):
+
+    filename = synth(n_bins=1000, bytes_per_bin=bytes_per_bin)
+    if indexed:
+        mud.write_index(filename)
+    expected = [h.data for h in mdata(filename).hist.values()]
+
+    fh = mud.open_read(filename)
+    try:
+        # released one at a time, and read again
+        for i, data in enumerate(expected):
+            assert_equal(mud.get_hist_data(fh, i+1), data)
+            mud.release_hist(fh, i+1)
+            mud.release_hist(fh, i+1)
+            assert_equal(mud.get_hist_data(fh, i+1), data)
+            mud.release_hist(fh, i+1)
+            assert_equal(mud.get_hist_data_rebinned(fh, i+1, 1), data)
+
+        # released after each read, by every reader
+        mud.set_release_hists(fh, True)
+        asym = mud.get_hist_asym(fh, 1, 2)
+        for repeat in range(2):
+            for i, data in enumerate(expected):
+                assert_equal(mud.get_hist_data(fh, i+1), data)
+                assert_equal(mud.get_hist_data_rebinned(fh, i+1, 1), data)
+            assert_equal(mud.get_hist_asym(fh, 1, 2), asym)
+
+        # the file read is read again, even if replaced since
+        other = synth('other.msr', seed=2, n_bins=1000,
+                      bytes_per_bin=bytes_per_bin)
+        os.replace(other, filename)
+        for i, data in enumerate(expected):
+            assert_equal(mud.get_hist_data(fh, i+1), data)
+    finally:
+        mud.close_read(fh)
+
+@pytest.mark.parametrize('indexed', [False, True])
+def test_release_changed(synth, tmp_path, indexed):
+
+    filename = synth(n_bins=1000)
+    if indexed:
+        mud.write_index(filename)
+    expected = [h.data for h in mdata(filename).hist.values()]
+
+    # data of files open to be changed are kept, as the file may not hold
+    # them by the time they are needed again
+    fh = mud.open_readwrite(filename)
+    try:
+        mud.set_release_hists(fh, True)
+        assert_equal(mud.get_hist_data(fh, 1), expected[0])
+        with pytest.raises(RuntimeError):
+            mud.release_hist(fh, 1)
+
+        mud.set_hist_t0_bin(fh, 1, 12)
+        mud.set_hist_data(fh, 2, expected[2])
+        with pytest.raises(RuntimeError):
+            mud.release_hist(fh, 2)
+        for i in range(2):
+            assert_equal(mud.get_hist_data(fh, 1), expected[0])
+            assert_equal(mud.get_hist_data(fh, 2), expected[2])
+            assert_equal(mud.get_hist_data(fh, 3), expected[2])
+        mud.close_writefile(fh, str(tmp_path / 'changed.msr'))
+    except:
+        mud.close_read(fh)
+        raise
+
+    changed = mdata(str(tmp_path / 'changed.msr'))
+    hists = list(changed.hist.values())
+    assert hists[0].t0_bin == 12
+    assert_equal(hists[0].data, expected[0])
+    assert_equal(hists[1].data, expected[2])
+    assert_equal(hists[2].data, expected[2])
+
+@pytest.mark.parametrize('release', [False, True])
+def test_mdata_release(synth, same_run, monkeypatch, release):
+    """mdata releases histogram data only if asked"""
+
+    filename = synth()
+    expected = mdata(filename, lazy=True)
+
+    calls = []
+    set_release_hists = mud.set_release_hists
+    def record(fh, value):
+        calls.append(value)
+        set_release_hists(fh, value)
+    monkeypatch.setattr(mud, 'set_release_hists', record)
+
+    same_run(mdata(filename), expected)
+    assert not calls
+    same_run(mdata(filename, release=release), expected)
+    assert calls == ([True] if release else [])
+    same_run(mdata(filename, lazy=True, release=release), expected)
+    assert calls == ([True] if release else [])
@@ -0,0 +1,129 @@
+# Test loading runs in worker processes into shared memory, and pickling
+# histograms out-of-band
+# agent
+# Oct 2026
+
+from mudpy import mdata, load_shared, mload
+from mudpy.mhist import mhist
+from mudpy.containers import mhist_lazy
+from numpy.testing import *
+import numpy as np
+import glob, os, pickle, pytest
+
+posix_shm = os.path.isdir(mload.SHM_DIR)
+
+_read_shared = mload._read_shared
+_posixshmem = mload._posixshmem
+
+@pytest.fixture
+def runs(synth):
+    """Synthetic runs of each type and bin size"""
+    return [synth('run%02d.msr' % i, 'TI' if i % 3 == 0 else 'TD', seed=i+1,
+                  n_bins=2048, bytes_per_bin=(0, 4)[i % 2])
+            for i in range(6)]
+
+def shm_segments(prefix):
+    return set(glob.glob(os.path.join(mload.SHM_DIR, prefix + '*')))
+
+def dying_read(path, prefix):
+    """Worker that dies after reading a run into shared memory"""
+    run = _read_shared(path, prefix)
+    if path.endswith('run02.msr'):
+        os._exit(1)
+    return run
+
+class failing_shm(object):
+    """_posixshmem, with shm_open failing after n calls"""
+
+    def __init__(self, n):
+        self.n = n
+
+    def shm_open(self, *args, **kwargs):
+        self.n -= 1
+        if self.n < 0:
+            raise OSError('no more')
+        return _posixshmem.shm_open(*args, **kwargs)
+
+    def shm_unlink(self, name):
+        return _posixshmem.shm_unlink(name)
+
+@pytest.mark.skipif(not posix_shm, reason='needs POSIX shared memory')
+def test_load_shared(runs, same_run, tmp_path):
+
+    before = shm_segments('')
+    loaded = load_shared(runs, processes=3)
+    for filename, run in zip(runs, loaded):
+        same_run(run, mdata(filename))
+        for h in run.hist.values():
+            assert h.data.dtype == np.uint32
+
+    missing = str(tmp_path / 'missing.msr')
+    with pytest.raises(mload.LoadError) as err:
+        load_shared(runs[:2] + [missing], processes=2)
+    assert err.value.runs[2] is None and err.value.runs[0] is not None
+
+    # blocks are unlinked as soon as they are mapped
+    assert shm_segments('') == before
+
+@pytest.mark.skipif(not posix_shm, reason='needs POSIX shared memory')
+def test_no_leaks(runs, monkeypatch):
+    """Blocks are unlinked whatever stops the runs being mapped"""
+
+    before = shm_segments('')
+
+    # the second block of the first run cannot be mapped, nor any after
+    with monkeypatch.context() as m:
+        m.setattr(mload, '_posixshmem', failing_shm(1))
+        with pytest.raises(mload.LoadError) as err:
+            load_shared(runs, processes=2)
+    assert [path for path, _ in err.value.errors] == runs
+    assert shm_segments('') == before
+
+    # interrupted
+    mapped = []
+    map_shared = mload._map_shared
+    def interrupted(run):
+        if len(mapped) == 2:
+            raise KeyboardInterrupt
+        mapped.append(run)
+        return map_shared(run)
+    with monkeypatch.context() as m:
+        m.setattr(mload, '_map_shared', interrupted)
+        with pytest.raises(KeyboardInterrupt):
+            load_shared(runs, processes=2)
+    assert len(mapped) == 2
+    assert shm_segments('') == before
+
+    # a worker dies
+    with monkeypatch.context() as m:
+        m.setattr(mload, '_read_shared', dying_read)
+        with pytest.raises(mload.LoadError):
+            load_shared(runs, processes=2)
+    assert shm_segments('') == before
+
+@pytest.mark.parametrize('lazy', [False, True])
+def test_pickle(synth, same_run, lazy):
+
+    run = mdata(synth(n_bins=5000), lazy=lazy)
+    h = run.hist[list(run.hist)[0]]
+    if lazy:
+        assert type(h._data) is mhist_lazy
+    assert set(h.keys()) == set(mhist._fields)
+    assert 'data' in repr(h) and '_data' not in repr(h)
+
+    # out-of-band: the data are not copied, and not read again
+    buffers = []
+    s = pickle.dumps(h, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 1 and len(s) < 1000
+    copy = pickle.loads(s, buffers=buffers)
+    assert copy.data.ctypes.data == h.data.ctypes.data
+    for attr in h.keys():
+        assert_equal(getattr(copy, attr), getattr(h, attr))
+
+    # in-band, and a whole run
+    for protocol in (4, 5):
+        same_run(pickle.loads(pickle.dumps(run, protocol=protocol)), run)
+
+    # without data
+    empty = pickle.loads(pickle.dumps(mhist(), protocol=5))
+    assert empty.data is None
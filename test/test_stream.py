@@ -0,0 +1,130 @@
+# Test writing runs with open_write_stream
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+import numpy as np
+import filecmp, pytest
+
+def sections(filename):
+    """
+        (secID, instanceID) of the members of each group of a file, in file
+        order, keyed by the (secID, instanceID) of the group, as listed by
+        its section index
+    """
+
+    mud.write_index(filename)
+    entries = np.fromfile(filename + '.idx', dtype='<u4')[5:].reshape(-1, 5)
+
+    groups = {}
+    for offset, size, sec, inst, parent in entries:
+        if parent != 0xFFFFFFFF:
+            key = (int(entries[parent][2]), int(entries[parent][3]))
+            groups.setdefault(key, []).append((int(sec), int(inst)))
+    return groups
+
+def write(run, filename, stream):
+    """
+        Write run as mdata.write(stream=True) does, whether streaming or not
+    """
+
+    if stream:
+        fh = mud.open_write_stream(filename, mud.FMT_TRI_TD_ID)
+    else:
+        fh = mud.open_write(filename, mud.FMT_TRI_TD_ID)
+
+    mud.set_description(fh, mud.SEC_GEN_RUN_DESC_ID)
+    for attr, name in run.description_attribute_functions.items():
+        if getattr(run, attr, None) is not None:
+            getattr(mud, 'set_' + name)(fh, getattr(run, attr))
+
+    method = run.mud_method['TD']
+    attr_dict = {'hist': run.histogram_attribute_functions,
+                 'sclr': run.scaler_attribute_functions,
+                 'ivar': run.variable_attribute_functions,
+                 'comments': run.comment_attribute_functions}
+    set_n = {'hist': mud.set_hists,
+             'sclr': mud.set_scalers,
+             'ivar': mud.set_ivars,
+             'comments': mud.set_comments}
+    for name in ('sclr', 'ivar', 'comments', 'hist'):
+        run._write_mdict(fh, set_n[name], attr_dict[name], name, method[name])
+
+    mud.close_write(fh)
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 4, mud.BIN_SIZE_DELTA])
+def test_stream(synth, same_run, tmp_path, bytes_per_bin):
+
+    run = mdata(synth(n_bins=1000, bytes_per_bin=bytes_per_bin, n_comments=2))
+    run.write(str(tmp_path / 'stream.msr'), stream=True,
+              bytes_per_bin=bytes_per_bin)
+    same_run(mdata(str(tmp_path / 'stream.msr')), run)
+
+    # each histogram header before its data
+    hists = sections(str(tmp_path / 'stream.msr'))[(mud.SEC_GRP_ID,
+                                                    mud.GRP_TRI_TD_HIST_ID)]
+    assert hists == [(sec, i+1) for i in range(len(run.hist))
+                     for sec in (mud.SEC_GEN_HIST_HDR_ID,
+                                 mud.SEC_GEN_HIST_DAT_ID)]
+
+    with pytest.raises(ValueError):
+        run.write(str(tmp_path / 'c.msr'), stream=True, pack_threads=2)
+
+def test_layout(synth, tmp_path):
+    """The same file as written without streaming"""
+
+    run = mdata(synth(n_bins=1000, n_comments=2))
+    write(run, str(tmp_path / 'a.msr'), stream=False)
+    write(run, str(tmp_path / 'b.msr'), stream=True)
+    assert filecmp.cmp(str(tmp_path / 'a.msr'), str(tmp_path / 'b.msr'),
+                       shallow=False)
+
+def test_changes(synth, tmp_path):
+
+    run = mdata(synth(n_hist=3, n_bins=100))
+    data = [h.data for h in run.hist.values()]
+    filename = str(tmp_path / 'stream.msr')
+
+    fh = mud.open_write_stream(filename, mud.FMT_TRI_TD_ID)
+    try:
+        mud.set_description(fh, mud.SEC_GEN_RUN_DESC_ID)
+        mud.set_title(fh, 'title')
+        mud.set_hists(fh, mud.GRP_TRI_TD_HIST_ID, 3)
+        for i in range(3):
+            mud.set_hist_n_bins(fh, i+1, 100)
+            mud.set_hist_title(fh, i+1, 'hist%d' % i)
+
+        # in order, and only once
+        with pytest.raises(RuntimeError):
+            mud.set_hist_data(fh, 2, data[1])
+        mud.set_hist_data(fh, 1, data[0])
+        with pytest.raises(RuntimeError):
+            mud.set_hist_data(fh, 1, data[0])
+        mud.set_hist_data(fh, 2, data[1])
+        mud.set_hist_data(fh, 3, data[2])
+
+        # headers written may still change, in place
+        mud.set_hist_t0_bin(fh, 1, 17)
+        mud.set_title(fh, 'TITLE')
+    except Exception:
+        mud.close_read(fh)
+        raise
+    mud.close_write(fh)
+
+    written = mdata(filename)
+    assert written.title == 'TITLE'
+    assert written.hist['hist0'].t0_bin == 17
+    for i in range(3):
+        assert list(written.hist['hist%d' % i].data) == list(data[i])
+
+    # but not in size
+    fh = mud.open_write_stream(filename, mud.FMT_TRI_TD_ID)
+    mud.set_description(fh, mud.SEC_GEN_RUN_DESC_ID)
+    mud.set_title(fh, 'title')
+    mud.set_hists(fh, mud.GRP_TRI_TD_HIST_ID, 1)
+    mud.set_hist_n_bins(fh, 1, 100)
+    mud.set_hist_data(fh, 1, data[0])
+    mud.set_title(fh, 'a longer title')
+    with pytest.raises(RuntimeError):
+        mud.close_write(fh)
@@ -0,0 +1,66 @@
+# Test summing histograms over many runs
+# agent
+# Oct 2026
+
+from mudpy import mdata, msum
+import mudpy.mud_friendly_wrapper as mud
+from concurrent.futures import ThreadPoolExecutor
+from numpy.testing import *
+import numpy as np
+import pytest
+
+N_BINS = 1001
+
+# few enough counts for 1-byte bins
+SMALL = {'n_bins': N_BINS, 'counts': 100}
+
+@pytest.fixture
+def runs(synth):
+    """Runs of each bin size, with the same runs written with 4-byte bins"""
+    files = [synth('run%d.msr' % i, bytes_per_bin=bytes_per_bin, seed=i+1,
+                   **SMALL)
+             for i, bytes_per_bin in enumerate([0, 1, 2, 4,
+                                                mud.BIN_SIZE_DELTA, 0])]
+    refs = [mdata(synth('ref%d.msr' % i, bytes_per_bin=4, seed=i+1, **SMALL))
+            for i in range(len(files))]
+    return files, refs
+
+def test_sum_hists(runs):
+
+    files, refs = runs
+
+    expected = {}
+    for ref in refs:
+        for h in ref.hist.values():
+            expected[h.title] = expected.get(h.title, 0) + h.data
+
+    for threads in (1, 3, None):
+        total = msum.sum_hists(files, threads=threads)
+        assert total.keys() == expected.keys()
+        for k in total:
+            assert total[k].dtype == np.uint64
+            assert_equal(total[k], expected[k])
+
+    # runs that cannot be read are left out, and flagged
+    missing = files[0] + '.missing'
+    total, ok = mud.sum_hists([files[0], missing, files[0]], [1], N_BINS, 2)
+    assert_equal(ok, [True, False, True])
+    first = list(refs[0].hist.values())[0]
+    assert_equal(total[0], 2*first.data)
+
+    with pytest.raises(RuntimeError):
+        msum.sum_hists(files + [missing])
+
+def test_threads(runs):
+    """Sums run at once from Python threads, without the GIL"""
+
+    files, refs = runs
+    expected, ok = mud.sum_hists(files, [1, 2], N_BINS, 1)
+    assert ok.all()
+
+    with ThreadPoolExecutor(4) as pool:
+        sums = list(pool.map(lambda n: mud.sum_hists(files, [1, 2], N_BINS, n),
+                             [1, 2, 3, 0]*2))
+    for total, ok in sums:
+        assert ok.all()
+        assert_equal(total, expected)
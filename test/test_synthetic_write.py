@@ -0,0 +1,27 @@
+# Test writing synthetic runs, no network needed
+# agent
+# Oct 2026
+
+from mudpy import mdata
+import mudpy.mud_friendly_wrapper as mud
+from numpy.testing import *
+import numpy as np
+import pytest
+
+DELTA = mud.BIN_SIZE_DELTA
+
+@pytest.mark.parametrize('bytes_per_bin', [0, 1, 2, 4, DELTA])
+def test_write(synth, tmp_path, bytes_per_bin):
+
+    run = mdata(synth(n_bins=1000, bytes_per_bin=bytes_per_bin))
+
+    # counts that fit the bins
+    if bytes_per_bin in (1, 2):
+        for h in run.hist.values():
+            h.data = np.asarray(h.data) % 2**(8*bytes_per_bin)
+
+    run.write(str(tmp_path / 'a.msr'), bytes_per_bin=bytes_per_bin)
+    written = mdata(str(tmp_path / 'a.msr'))
+    assert repr(written) == repr(run)
+    for k in run.hist:
+        assert_equal(written.hist[k].data, run.hist[k].data)